@@ -20,6 +20,7 @@ gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/option.c -o $BLDDIR/option.o -I $INCDIR
 gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/astring.c -o $BLDDIR/astring.o -I $INCDIR
 gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/vector.c -o $BLDDIR/vector.o -I $INCDIR
 gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/linked_list.c -o $BLDDIR/linked_list.o -I $INCDIR
+gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/hashing_func.c -o $BLDDIR/hashing_func.o -I $INCDIR
 gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/map.c -o $BLDDIR/map.o -I $INCDIR
 gcc -g -std=c17 -Wall -fPIC -c $SRCDIR/common.c -o $BLDDIR/common.o -I $INCDIR
 # typefied 
@@ -49,6 +50,7 @@ echo "-- Create shared library --"
      $BLDDIR/astring.o \
      $BLDDIR/vector.o \
      $BLDDIR/linked_list.o \
+     $BLDDIR/hashing_func.o \
      $BLDDIR/map.o \
      $BLDDIR/common.o \
      $BLDDIR/typefy.o \
@@ -72,6 +74,7 @@ gcc -std=c17 -g -Wall \
     $BLDDIR/astring.o \
     $BLDDIR/vector.o \
     $BLDDIR/linked_list.o \
+    $BLDDIR/hashing_func.o \
     $BLDDIR/map.o \
     $BLDDIR/common.o \
     $BLDDIR/typefy.o \
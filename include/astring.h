@@ -3,8 +3,9 @@
  * 
  * General-purpose string
  * 
- * String copies the given C string (`char*` type) to heap
- * and holds a pointer to it. Abel string holds resource.
+ * String copies the given C string (`char*` type) and holds
+ * it. A short string is held inline in the string instance,
+ * a longer one on heap. Abel string holds resource.
  **/
 #ifndef ABEL_ON_C_ASTRING_H
 #define ABEL_ON_C_ASTRING_H
@@ -20,37 +21,44 @@
  *
  * Fields
  * 
- * ptr_array : An array of characters.
- * 
  * length : Total number of characters in the current array.
  *     This doesn't include the last null terminator ('\0').
  * 
- * capacity : Maximal number of characters allowed, including
- *     the last null-terminator.
+ * data : Characters of the string. Up to STRING_SMALL_SIZE - 1
+ *     characters are held inline in `small_array`, whose
+ *     last char is then always a null char. Once longer,
+ *     the string moves to heap for good: `heap.ptr_array`
+ *     points to the array and `heap.capacity_shift`, which
+ *     overlaps that last char, is the base-2 logarithm of
+ *     the capacity, i.e. the maximal number of characters
+ *     allowed, including the last null-terminator.
+ * 
+ * Use `abel_string_cstr` to get the characters and
+ * `abel_string_capacity` to get the capacity.
  */
+#define STRING_SMALL_SIZE 16
+
 struct abel_string {
-    char* ptr_array;
     size_t length;
-    size_t capacity;
+    union {
+        struct {
+            char* ptr_array;
+            char padding[STRING_SMALL_SIZE - sizeof(char*) - 1];
+            unsigned char capacity_shift;
+        } heap;
+        char small_array[STRING_SMALL_SIZE];
+    } data;
 };
 
 /**
  * @brief String instance maker
  * 
- * Source string is copied to heap and its address on heap
- * is the internal array `ptr_array` of the String instance.
- * 
- * If the length of the source char array is shorter than
- * or equal to 3, exactly 4 bytes will be allocated, even
- * if the char array is empty. Otherwise, the next highest
- * power of 2 is the amount of memory requested for the
- * string. In this way, the destination string always has
- * enough space to contain the source including the last
- * null-terminator.
- * 
- * This design guarantees the pointer to array is never
- * zero and is thus avoiding the error caused by realloc
- * zero size.
+ * Source string is copied inline if it is shorter than
+ * STRING_SMALL_SIZE, which allocates nothing. Otherwise it
+ * is copied to heap, and the next highest power of 2 is the
+ * amount of memory requested for the string. In this way,
+ * the destination string always has enough space to contain
+ * the source including the last null-terminator.
  * 
  * @param src_cstr Source C string of type `char*`. Both
  *                 char* and char[] are accepted.
@@ -75,16 +83,15 @@ struct abel_string abel_string_from_int(int src_int);
  * @brief Free string instance
  *
  * Call this freer to free the internal array of a text
- * instance created on stack.
+ * instance created on stack. String is left empty.
  */
 void abel_free_string(struct abel_string* ptr_str);
 
 /**
  * @brief Make a string on heap
  * 
- * The length of internal array is determined the same way
- * as function `abel_make_string` and the entire instance
- * is on heap.
+ * The internal array is held the same way as by function
+ * `abel_make_string` and the entire instance is on heap.
  * 
  * @param src_cstr Source C string of type char*.
  *        Both char* and char[] are accepted.
@@ -96,8 +103,8 @@ struct abel_string* abel_make_string_ptr(char* src_cstr);
  * @brief Free string on heap
  *
  * Two slices of memory to be freed: One part is for the
- * source string copied onto heap, the other is the string
- * instance itself.
+ * source string copied onto heap, if it is not inline, the
+ * other is the string instance itself.
  */
 void abel_free_string_ptr(struct abel_string* ptr_str);
 
@@ -107,11 +114,21 @@ void abel_free_string_ptr(struct abel_string* ptr_str);
 size_t abel_string_len(struct abel_string* ptr_str);
 size_t abel_string_capacity(struct abel_string* ptr_str);
 
+/**
+ * @brief Characters of a string
+ * 
+ * Returns the null-terminated characters, inline or on
+ * heap. The pointer is valid until the string is modified,
+ * moved or freed.
+ */
+char* abel_string_cstr(const struct abel_string* ptr_str);
+
 /**
  * @brief Assign a string or char
  *
  * Assign a C string to the string. This method replaces the
- * current content of the destination string instance.
+ * current content of the destination string instance. An
+ * array on heap is reused if it has room for the source.
  * 
  * @param ptr_str Pointer to destination string.
  * @param src_cstr Source C string to be assigned to the
@@ -135,6 +152,29 @@ void abel_string_assign_char(struct abel_string* ptr_str, char src_char);
 void abel_string_append(struct abel_string* ptr_str, char* src_cstr);
 void abel_string_append_char(struct abel_string* ptr_str, char src_char);
 
+/**
+ * @brief Append a number of chars
+ *
+ * Append the first `src_length` chars of the source at the
+ * end of the text. Source doesn't have to be null-terminated,
+ * which allows to append a slice of a larger buffer.
+ * 
+ * @param ptr_str Pointer to destination string.
+ * @param src Pointer to the first char to be appended.
+ * @param src_length Number of chars to be appended.
+ */
+void abel_string_append_n(struct abel_string* ptr_str, const char* src,
+                          size_t src_length);
+
+/**
+ * @brief Truncate a string
+ *
+ * Keeps the first `length` chars. Capacity is unchanged, so
+ * the string can grow back without allocation. Nothing is
+ * done if the string is not longer.
+ */
+void abel_string_truncate(struct abel_string* ptr_str, size_t length);
+
 /**
  * @brief Compare strings
  * 
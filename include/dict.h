@@ -11,6 +11,78 @@
 
 #include "object.h"
 
+/* Largest number of keys of a dict in shape form */
+#define DICT_SHAPE_MAX_SIZE 32
+
+/**
+ * @brief Lookup cache
+ *
+ * Cache of a lookup site, e.g. a loop reading the same key
+ * of every record of a list. It remembers the shape seen
+ * last and the slot of the key in that shape, such that
+ * records of the same shape are read without searching the
+ * key.
+ *
+ * Fields
+ *
+ * shape_id : Id of the shape seen last, 0 if none.
+ * index : Slot of the key in that shape.
+ *
+ * @note A cache must only be used with one key.
+ */
+struct abel_dict_lookup_cache {
+    uint64_t shape_id;
+    size_t index;
+};
+
+/**
+ * @brief Key handle
+ *
+ * Handle of a key looked up again and again, e.g. a constant
+ * key read from every request. It is made once and passed
+ * to the `_by_key` getters instead of the key string. Key
+ * of a handle is interned, so its hash is computed once and
+ * kept with the interned key, and it is compared by pointer.
+ * Handle also caches the slot where the key was found last,
+ * which is checked first by the next lookup.
+ *
+ * Fields
+ *
+ * key : Interned key, NULL if interning failed.
+ * key_length : Number of chars of the key.
+ * slot : Slot of the last hit, in the shape or in the map
+ *        of the dict looked up.
+ */
+struct abel_key {
+    const char* key;
+    size_t key_length;
+    size_t slot;
+};
+
+/**
+ * @brief Dict iterator
+ *
+ * Iterator visits the key-value pairs of a dict in the
+ * order they were inserted. It is made by
+ * `abel_dict_iter_begin`, and is valid as long as no key
+ * is inserted into or deleted from the dict.
+ *
+ * Fields
+ *
+ * ptr_dict : Dict being iterated.
+ * map_iter : Iterator of the internal map, if any.
+ * index : Slot of the next key in the shape of the dict.
+ * key : Key of the current pair.
+ * ptr_object : Object of the current pair.
+ */
+struct abel_dict_iterator {
+    struct abel_dict* ptr_dict;
+    struct abel_map_iterator map_iter;
+    size_t index;
+    const char* key;
+    struct abel_object* ptr_object;
+};
+
 /**
  * @brief Make a dict on heap
  *
@@ -18,6 +90,19 @@
  */
 struct abel_dict* abel_make_dict_ptr();
 
+/**
+ * @brief Make a dict on heap with room for keys
+ *
+ * If the dict is to hold more than DICT_SHAPE_MAX_SIZE keys,
+ * its internal map is made at once, with the slot table
+ * sized for `capacity` keys. Otherwise it is the same as
+ * `abel_make_dict_ptr`, as such a dict either takes the
+ * shape form or grows its map only a few times.
+ *
+ * @return Pointer to the dict, or NULL if malloc fails.
+ */
+struct abel_dict* abel_make_dict_ptr_with_capacity(size_t capacity);
+
 /**
  * @brief Check if dict has the given key
  *
@@ -28,6 +113,16 @@ struct abel_dict* abel_make_dict_ptr();
  */
 Bool abel_dict_has_key(struct abel_dict* ptr_dict, char* key_str);
 
+/**
+ * @brief Check if dict has the key of given length
+ *
+ * Key is the first `key_length` chars at `key_str`, which
+ * need not be null-terminated. Same holds for all `_n`
+ * functions below.
+ */
+Bool abel_dict_has_key_n(struct abel_dict* ptr_dict, const char* key_str,
+        size_t key_length);
+
 /**
  * @brief Dictionary size
  * 
@@ -40,7 +135,9 @@ size_t abel_dict_size(struct abel_dict* ptr_map);
  *
  * Insertion into a dictionary is delegated to map's insert.
  * If insertion is successful, struct abel_object's ref count increased
- * by 1.
+ * by 1. A dict in shape form is turned into a map first.
+ * A dict of a document refuses it with error READ_ONLY, as
+ * do the other inserts and delete.
  * 
  * @param ptr_dict : Pointer to the target dictionary.
  * @param key_str : Key to the key-value pair to be inserted
@@ -50,6 +147,61 @@ size_t abel_dict_size(struct abel_dict* ptr_map);
  */
 struct abel_return_option abel_dict_insert(
         struct abel_dict* ptr_dict, char* key_str, struct abel_object* ptr_obj);
+
+/**
+ * @brief Insert a key-value pair with a key of given length
+ */
+struct abel_return_option abel_dict_insert_n(struct abel_dict* ptr_dict,
+        const char* key_str, size_t key_length, struct abel_object* ptr_obj);
+
+/**
+ * @brief Insert a key-value pair with interned key
+ *
+ * Same as `abel_dict_insert`, except that the key is interned
+ * and the pair refers to it instead of a private copy. Dicts
+ * that repeat the same keys, e.g. records of a list, then
+ * share one buffer per key.
+ *
+ * A dict whose keys are all inserted by this function stays
+ * in shape form, up to DICT_SHAPE_MAX_SIZE keys: dicts that
+ * insert the same keys in the same order share the shape,
+ * and each stores an array of values only. In this form,
+ * the pointer in the returned option is NULL instead of the
+ * pair.
+ * 
+ * @see abel_intern_key and abel_key_shape_add_key in map.h
+ */
+struct abel_return_option abel_dict_insert_interned(
+        struct abel_dict* ptr_dict, char* key_str, struct abel_object* ptr_obj);
+
+/**
+ * @brief Insert a key-value pair with interned key of given length
+ */
+struct abel_return_option abel_dict_insert_interned_n(struct abel_dict* ptr_dict,
+        const char* key_str, size_t key_length, struct abel_object* ptr_obj);
+
+/**
+ * @brief Insert several key-value pairs into dict
+ *
+ * Internal map is sized once for all keys, then the pairs
+ * are inserted in the given order without growing it. A
+ * dict in shape form is turned into a map first.
+ *
+ * @param ptr_keys : Array of `count` keys.
+ * @param ptr_objs : Array of `count` objects, the i-th of
+ *                   which is associated with the i-th key.
+ * @return struct abel_return_option instance.
+ *         - If successful, flag is_okay is true and pointer
+ *           is NULL.
+ *         - If failure, e.g. a key exists, the error is
+ *           returned. Pairs before the failing key are left
+ *           inserted, the others are not.
+ */
+struct abel_return_option abel_dict_insert_many(struct abel_dict* ptr_dict,
+        char** ptr_keys, struct abel_object** ptr_objs, size_t count);
+
+/* Bool and Null are inserted as the immortal objects of their value */
+
 /* Bool */
 struct abel_return_option abel_dict_insert_bool_ptr(
         struct abel_dict* ptr_dict, char* key_str, Bool* ptr_src_data);
@@ -76,7 +228,7 @@ struct abel_return_option abel_dict_insert_dict_ptr(
  * @brief Delete a key-value from dict
  *
  * Calls `abel_map_erase` function to erase the key-value
- * pair. Not that function `abel_map_erase` disconnects
+ * pair. A dict in shape form is turned into a map first. Not that function `abel_map_erase` disconnects
  * the pair from the map and returns the pointer to it
  * in the return option. Dictionary then decides what to
  * do with it.
@@ -94,6 +246,38 @@ struct abel_return_option abel_dict_insert_dict_ptr(
 struct abel_return_option abel_dict_delete(
         struct abel_dict* ptr_dict, char* key_str);
 
+/**
+ * @brief Dict statistics
+ *
+ * Statistics of the internal map, plus the dict itself in
+ * `bytes`. For a dict in shape form, capacity is the room
+ * of its values and probe lengths are the positions of the
+ * keys in the shape, which are scanned in order. The shape,
+ * shared by many dicts, is left out of `bytes`.
+ *
+ * @see abel_map_stats in map.h
+ */
+struct abel_map_stats abel_dict_stats(struct abel_dict* ptr_dict);
+
+/**
+ * @brief Begin iteration of a dict
+ *
+ * Iteration costs time in proportion to the size of the
+ * dict, not to the capacity of its internal map.
+ */
+struct abel_dict_iterator abel_dict_iter_begin(struct abel_dict* ptr_dict);
+
+/**
+ * @brief Move to the next pair of a dict
+ *
+ * Sets the fields `key` and `ptr_object` of the iterator
+ * to the next pair in insertion order.
+ *
+ * @return `true` if there is a next pair; `false` once all
+ *         pairs are visited.
+ */
+Bool abel_dict_iter_next(struct abel_dict_iterator* ptr_iter);
+
 /**
  * @brief Get object from dict
  *
@@ -108,13 +292,66 @@ struct abel_return_option abel_dict_delete(
 struct abel_object* abel_dict_get_object_ptr(
         struct abel_dict* ptr_dict, char* key_str);
 
+/**
+ * @brief Get object from dict by a key of given length
+ */
+struct abel_object* abel_dict_get_object_ptr_n(struct abel_dict* ptr_dict,
+        const char* key_str, size_t key_length);
+
+/**
+ * @brief Make an empty lookup cache
+ */
+struct abel_dict_lookup_cache abel_make_dict_lookup_cache();
+
+/**
+ * @brief Get object from dict with a lookup cache
+ *
+ * Same as `abel_dict_get_object_ptr`. If the dict is in
+ * the shape the cache has seen last, the object is taken
+ * from the cached slot without searching the key; otherwise
+ * the key is searched and the cache is updated.
+ *
+ * @param ptr_cache : Cache of the lookup site, made by
+ *                    `abel_make_dict_lookup_cache`.
+ */
+struct abel_object* abel_dict_get_object_ptr_cached(struct abel_dict* ptr_dict,
+        char* key_str, struct abel_dict_lookup_cache* ptr_cache);
+
 /**
  * @brief Get the type of object at given key
  */
 enum data_type abel_dict_get_data_type(struct abel_dict* ptr_dict, char* key_str);
 
-/* Terminal-data getter */
-Bool* abel_dict_get_bool_ptr(struct abel_dict* ptr_dict, char* key_str);
+/**
+ * @brief Make a key handle
+ *
+ * Handle holds a reference to the interned key until it is
+ * freed by `abel_free_key`.
+ *
+ * @return Key handle. Its field `key` is NULL if malloc
+ *         fails.
+ */
+struct abel_key abel_make_key(const char* key_str);
+
+/**
+ * @brief Free a key handle
+ */
+void abel_free_key(struct abel_key* ptr_key);
+
+/**
+ * @brief Get object from dict by key handle
+ *
+ * Same as `abel_dict_get_object_ptr`. Slot cached by the
+ * handle is updated by each lookup that finds the key.
+ */
+struct abel_object* abel_dict_get_object_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key);
+
+/* Terminal-data getter
+ *
+ * Bool data is shared by all holders of the same value, see
+ * immortal objects in object.h, hence read-only. */
+const Bool* abel_dict_get_bool_ptr(struct abel_dict* ptr_dict, char* key_str);
 Bool abel_dict_get_bool(struct abel_dict* ptr_dict, char* key_str);
 int* abel_dict_get_int_ptr(struct abel_dict* ptr_dict, char* key_str);
 int abel_dict_get_int(struct abel_dict* ptr_dict, char* key_str);
@@ -122,6 +359,18 @@ double* abel_dict_get_double_ptr(struct abel_dict* ptr_dict, char* key_str);
 double abel_dict_get_double(struct abel_dict* ptr_dict, char* key_str);
 char* abel_dict_get_string(struct abel_dict* ptr_dict, char* key_str);
 
+/* Terminal-data getter by key handle */
+const Bool* abel_dict_get_bool_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key);
+int* abel_dict_get_int_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key);
+double* abel_dict_get_double_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key);
+double abel_dict_get_double_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key);
+char* abel_dict_get_string_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key);
+
 /* Container pointer getter */
 struct abel_list* abel_dict_get_list_ptr(struct abel_dict* ptr_dict, char* key_str);
 struct abel_dict* abel_dict_get_dict_ptr(struct abel_dict* ptr_dict, char* key_str);
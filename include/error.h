@@ -30,7 +30,8 @@ enum error_type {
     VALIDATION_ERROR,
     INCOMPATIBLE_TYPE,
     OUT_OF_RANGE,
-    PARSER_ERROR
+    PARSER_ERROR,
+    READ_ONLY
 };
 
 
@@ -147,4 +148,6 @@ struct abel_error error_key_exists();
 
 struct abel_error error_parser_error(char* msg_str, int line_number);
 
+struct abel_error error_read_only();    // Container of a document
+
 #endif 
\ No newline at end of file
@@ -0,0 +1,98 @@
+/**
+ * Header hashing_func.h
+ *
+ * Family of string hash functions used by the map.
+ *
+ * All functions share the signature HashFunc, i.e. they hash
+ * `length` chars of `key` under a `seed` and return a 64-bit
+ * value. Functions that produce fewer bits return them in the
+ * low bits. A table index is obtained by masking the value.
+ *
+ * Functions
+ *
+ * - Hash functions
+ *     uint64_t abel_hash_wy(const char* key, size_t length, uint64_t seed);
+ *     uint64_t abel_hash_fnv1a(const char* key, size_t length, uint64_t seed);
+ *     uint64_t abel_hash_murmur_oaat(const char* key, size_t length, uint64_t seed);
+ *     uint64_t abel_hash_jenkins_oaat(const char* key, size_t length, uint64_t seed);
+ *     uint64_t abel_hash_djb2(const char* key, size_t length, uint64_t seed);
+ *     uint64_t abel_hash_sdbm(const char* key, size_t length, uint64_t seed);
+ * - Seed
+ *     uint64_t abel_hash_process_seed();
+ **/
+#ifndef ABEL_ON_C_HASHING_FUNC_H
+#define ABEL_ON_C_HASHING_FUNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Hash function type
+ *
+ * @param key Pointer to the first char to be hashed. Key
+ *            doesn't have to be null-terminated.
+ * @param length Number of chars to be hashed.
+ * @param seed Seed that selects a member of the family.
+ */
+typedef uint64_t (*HashFunc)(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief wyhash
+ *
+ * Word-at-a-time hash that reads 8 bytes per step and mixes
+ * them by 64 x 64 -> 128 bit multiplication. It is the
+ * default hash of the map.
+ *
+ * Source: https://github.com/wangyi-fudan/wyhash (final 4)
+ */
+uint64_t abel_hash_wy(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief FNV-1a, 32 bits
+ *
+ * Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
+ */
+uint64_t abel_hash_fnv1a(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief One-byte-at-a-time hash based on Murmur's mix, 32 bits
+ *
+ * It was the hash of the map. A seed of 1 gives the values
+ * the map used to produce.
+ *
+ * Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
+ */
+uint64_t abel_hash_murmur_oaat(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief Jenkins one-at-a-time hash, 32 bits
+ */
+uint64_t abel_hash_jenkins_oaat(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief djb2 by Dan Bernstein
+ *
+ * Poor distribution, kept for comparison only.
+ */
+uint64_t abel_hash_djb2(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief sdbm
+ *
+ * Poor distribution, kept for comparison only.
+ */
+uint64_t abel_hash_sdbm(const char* key, size_t length, uint64_t seed);
+
+/**
+ * @brief Per-process random seed
+ *
+ * Seed is drawn once per process from /dev/urandom, or from
+ * clock and address bits if it is not available, such that
+ * hash values cannot be predicted by the provider of keys.
+ * Every later call returns the same seed. Safe to call from
+ * several threads at once if the library is built with
+ * ABEL_ATOMIC_REF_COUNT defined.
+ */
+uint64_t abel_hash_process_seed();
+
+#endif
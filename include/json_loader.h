@@ -13,32 +13,226 @@
 //#include "dict.h"
 #include "container.h"
 
+/**
+ * @brief JSON loader struct
+ * 
+ * Field `ptr_parser` points at the parser whose tokens are
+ * being loaded. Literals and parent keys of tokens are held
+ * by the parser, so it must outlive the loading.
+ */
 struct json_loader {
     enum json_container_type root_container_type;
     int current_index;    // init to 0
+    const struct json_parser* ptr_parser;    // init to NULL
 };
 
 struct json_loader able_make_json_loader();
 
 struct abel_dict* make_dict(struct json_loader* ptr_loader,
-        int index_opening_token, struct abel_vector* ptr_token_vector);
+        int index_opening_token, const struct json_token_tape* ptr_token_vector);
 
 struct abel_list* make_list(struct json_loader* ptr_loader,
-        int index_opening_token, struct abel_vector* ptr_token_vector);
+        int index_opening_token, const struct json_token_tape* ptr_token_vector);
 
 void at_key(struct json_loader* ptr_loader, struct abel_dict* ptr_dict,
-        struct abel_vector* token_vector);
+        const struct json_token_tape* token_vector);
 
 void at_iter_key(struct json_loader* ptr_loader, struct abel_list* ptr_target_list,
-        struct abel_vector* ptr_token_vector);
+        const struct json_token_tape* ptr_token_vector);
 
 void fill_list(struct json_loader* ptr_loader, struct abel_list* ptr_target_list,
-        int key, struct abel_vector* ptr_token_vector);
+        int key, const struct json_token_tape* ptr_token_vector);
 
 void fill_dict(struct json_loader* ptr_loader, struct abel_dict* ptr_dict,
-        char* key, struct abel_vector* ptr_token_vector);
+        char* key, const struct json_token_tape* ptr_token_vector);
 
 void load_from_parser(struct json_loader* ptr_loader,
         struct json_parser* ptr_parser, struct abel_dict* ptr_dict);
 
+/**
+ * @brief JSON builder struct
+ * 
+ * JSON builder builds the containers in the same pass as the
+ * parser parses, instead of walking the token vector after
+ * parsing. It is attached to a parser as token handler. The
+ * result is the same as `load_from_parser`, i.e. the root
+ * container is inserted into the global dict with key
+ * "ROOT_KEY_".
+ * 
+ * Fields
+ * 
+ * ptr_global_dict : Dict into which the root container is
+ *     inserted. Not owned by builder.
+ * container_stack : Objects of the containers that are open,
+ *     the innermost one at the back. Objects are owned by
+ *     their parent containers.
+ * current_key : Latest key seen in the innermost dict.
+ */
+struct json_builder {
+    struct abel_dict* ptr_global_dict;
+    struct abel_vector container_stack;
+    struct abel_string current_key;
+};
+
+/**
+ * @brief Initialise a JSON builder
+ */
+void abel_make_json_builder(struct json_builder* ptr_builder,
+                            struct abel_dict* ptr_global_dict);
+
+/**
+ * @brief Free a JSON builder
+ * 
+ * Frees the builder only; the containers it built belong to
+ * the global dict.
+ */
+void abel_free_json_builder(struct json_builder* ptr_builder);
+
+/**
+ * @brief Attach a JSON builder to a parser
+ * 
+ * Must be called before parsing starts.
+ * 
+ * @param is_token_vector_kept If false, parser doesn't keep
+ *        tokens, which halves the memory held during loading.
+ *        Keep them only for diagnostics.
+ */
+void abel_json_builder_attach(struct json_builder* ptr_builder,
+        struct json_parser* ptr_parser, Bool is_token_vector_kept);
+
+/**
+ * @brief Load a JSON file in a single pass
+ * 
+ * Parses the file with a builder attached and without token
+ * vector, and inserts the root container into the global
+ * dict with key "ROOT_KEY_".
+ * 
+ * @return Option instance returned by `abel_parse_file_mapped`.
+ *         Per failure, the containers built up to the error
+ *         are left in the global dict.
+ */
+struct abel_return_option load_from_file(struct abel_dict* ptr_global_dict,
+                                         const char* file_name);
+
+/**
+ * Document
+ * 
+ * A document owns all containers loaded from one JSON file
+ * in an arena, i.e. a bump allocator that hands out memory
+ * from a few large chunks. Loading makes no malloc per
+ * object, and freeing the document releases the chunks at
+ * once instead of walking the tree.
+ * 
+ * Containers of a document are read-only. They may be read
+ * by the usual getters, while insert, set, append, delete
+ * and the freers refuse them with error READ_ONLY. Objects
+ * of a document are immortal, so the object freer leaves
+ * them to the document.
+ **/
+
+/**
+ * @brief Arena struct
+ * 
+ * Fields
+ * 
+ * ptr_chunk : Chunk from which memory is handed out, linked
+ *     to the chunks made before it.
+ * chunk_size : Size of the next chunk. It doubles with each
+ *     chunk made, up to ARENA_MAX_CHUNK_SIZE.
+ * bytes : Total size of the chunks.
+ */
+struct abel_arena {
+    struct abel_arena_chunk* ptr_chunk;
+    size_t chunk_size;
+    size_t bytes;
+};
+
+#define ARENA_MIN_CHUNK_SIZE (64 * 1024)
+#define ARENA_MAX_CHUNK_SIZE (16 * 1024 * 1024)
+
+/**
+ * @brief Arena instance maker
+ * 
+ * No chunk is made until the first allocation.
+ */
+struct abel_arena abel_make_arena();
+
+/**
+ * @brief Allocate memory from an arena
+ * 
+ * Memory is aligned for any type and lives until the arena
+ * is freed. A request larger than a quarter of the chunk
+ * size gets a chunk of its own.
+ * 
+ * @return Pointer to the memory, or NULL if malloc fails.
+ */
+void* abel_arena_alloc(struct abel_arena* ptr_arena, size_t size);
+
+/**
+ * @brief Free all chunks of an arena
+ */
+void abel_free_arena(struct abel_arena* ptr_arena);
+
+/**
+ * @brief Document struct
+ * 
+ * Fields
+ * 
+ * arena : Arena of the objects, their data and containers.
+ * ptr_root : Object of the root container, i.e. the object
+ *     `load_from_file` inserts with key "ROOT_KEY_". It is
+ *     NULL until a document is loaded.
+ * shapes : Key shapes of the dicts in shape form. Each dict
+ *     holds a reference to its shape through this vector.
+ * maps : Maps of the dicts with more than DICT_SHAPE_MAX_SIZE
+ *     keys, which are made on heap.
+ */
+struct abel_document {
+    struct abel_arena arena;
+    struct abel_object* ptr_root;
+    struct abel_vector shapes;
+    struct abel_vector maps;
+};
+
+/**
+ * @brief Initialise an empty document
+ */
+void abel_make_document(struct abel_document* ptr_document);
+
+/**
+ * @brief Load a JSON file into a document
+ * 
+ * File is parsed in a single pass as by `load_from_file`.
+ * Each container is made once it is closed, with exactly the
+ * room for its elements.
+ * 
+ * @param ptr_document Pointer to a document made empty by
+ *        `abel_make_document`.
+ * @param file_name JSON file to be loaded.
+ * @return Option instance returned by `abel_parse_file_mapped`,
+ *         or error MALLOC_FAILURE, in which case the root is
+ *         NULL. Per parse failure, the containers built up to
+ *         the error are kept. Free the document in any case.
+ */
+struct abel_return_option abel_document_load_file(
+        struct abel_document* ptr_document, const char* file_name);
+
+/**
+ * @brief Load a JSON document in a buffer into a document
+ * 
+ * Same as `abel_document_load_file`, but the content is
+ * parsed by `abel_parse_buffer`.
+ */
+struct abel_return_option abel_document_load_buffer(
+        struct abel_document* ptr_document, const char* buffer, size_t length);
+
+/**
+ * @brief Free a document
+ * 
+ * Releases the shapes and maps of its dicts and the chunks
+ * of its arena. Pointers into the document are invalid
+ * afterwards.
+ */
+void abel_document_free(struct abel_document* ptr_document);
+
 #endif
\ No newline at end of file
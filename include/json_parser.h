@@ -9,22 +9,105 @@
 #include "converter.h"    // has util.h
 #include "json_token.h"
 
+struct json_parser;
+
+/**
+ * @brief Token handler
+ * 
+ * A token handler receives every token as soon as the parser
+ * makes it, such that the document can be consumed in the
+ * same pass as it is parsed. Literal and parent key of the
+ * token can be read via `abel_json_token_literal` and
+ * `abel_json_token_parent_key` during the call only.
+ * 
+ * Fields
+ * 
+ * ptr_context : Pointer passed back to `on_token` as is.
+ * on_token : Callback. NULL if no handler is attached.
+ */
+struct json_token_handler {
+    void* ptr_context;
+    void (*on_token)(void* ptr_context, const struct json_parser* ptr_parser,
+                     const struct json_token* ptr_token);
+};
+
+/**
+ * @brief Typed terminal value
+ * 
+ * Value passed to the SAX handler per terminal. Literal is
+ * always set. Bool and double values are converted by the
+ * parser for BOOL_TERM and DOUBLE_TERM respectively, and are
+ * false and 0.0 otherwise.
+ * 
+ * Fields
+ * 
+ * terminal_type : Terminal type as determined by parser.
+ * literal : Literal of the terminal, without delimiters.
+ * length : Number of chars of the literal.
+ * bool_value : Value of a BOOL_TERM.
+ * double_value : Value of a DOUBLE_TERM.
+ */
+struct json_sax_value {
+    enum json_terminal_type terminal_type;
+    const char* literal;
+    size_t length;
+    Bool bool_value;
+    double double_value;
+};
+
+/**
+ * @brief SAX handler
+ * 
+ * Event-based interface on top of the token handler. The
+ * parser calls back as it walks the document, and keeps no
+ * token, so that a document is processed in memory bounded
+ * by its nesting rather than its size. Strings passed to the
+ * callbacks are valid during the call only.
+ * 
+ * Fields
+ * 
+ * ptr_context : Pointer passed back to each callback as is.
+ * on_key : Called per dict key, with the level of the key.
+ * on_terminal : Called per terminal value, with the level
+ *     of the value.
+ * on_container_open : Called per dict or list opening, with
+ *     the level of the container itself.
+ * on_container_close : Called per dict or list closing, with
+ *     the same level as its opening.
+ * 
+ * Any callback may be NULL, in which case the event is
+ * skipped.
+ */
+struct json_sax_handler {
+    void* ptr_context;
+    void (*on_key)(void* ptr_context, const char* key, size_t length,
+                   int level);
+    void (*on_terminal)(void* ptr_context,
+                        const struct json_sax_value* ptr_value, int level);
+    void (*on_container_open)(void* ptr_context,
+                              enum json_container_type container_type,
+                              int level);
+    void (*on_container_close)(void* ptr_context,
+                               enum json_container_type container_type,
+                               int level);
+};
+
 /**
  * @brief Json parser struct
  * 
- * Json parser parses the input file char by char. The
- * parsing rules are implemented via operational and
- * workflow functions.
+ * Json parser parses the input char by char. The input is
+ * either a file or a buffer in memory. The parsing rules
+ * are implemented via operational and workflow functions.
  * 
  * The most important field of a Json parser is the token
- * vector that stores pointers to tokens (created on heap).
+ * vector that stores the tokens contiguously.
  * 
  * Fields
  * 
- * token_vector : A struct abel_vector instance used to store tokens.
- *     Token vector doesn't store the token instances, but
- *     pointers to tokens created on heap. This field is
- *     resource holding. Inited to empty.
+ * token_vector : A struct json_token_tape instance used to store
+ *     tokens. Fields of the tokens are stored in arrays, one
+ *     array per field, see `struct json_token_tape`. This field
+ *     is resource holding. Inited to empty.
  * 
  * current_line : Line number of the char on the file that
  *     is being parsed. Note that line number in file start
@@ -53,11 +136,41 @@
  *     always set to 0, even though the scope at level 0 is not
  *     necessarily iterable.
  * parent_key : A struct abel_vector instance. Each element stores the
- *     parent key for the current level. Inited to ["ROOT_KEY_"].
+ *     id of the parent key for the current level. Inited to
+ *     [id("ROOT_KEY_")].
  * keys_per_level : A 2D vector to store keys at each level. Initialised to [[]].
+ * is_in_comment : A flag that is true from a `#` outside of
+ *     delimited string to the end of that line. Inited to
+ *     false.
+ * is_root_closed : A flag that is true once the root container
+ *     is closed, after which only spaces and comments may
+ *     follow. Inited to false.
+ * literal_pool : A struct abel_string instance. Literals of all
+ *     tokens are appended to it, each followed by a null
+ *     char; tokens locate them by slices. Inited to empty.
+ * parent_key_table : A struct abel_vector instance. It stores each
+ *     interned parent key at the index that is its id. Iter
+ *     keys are not interned (see JSON_TOKEN_ITER_KEY_ID). Keys
+ *     are owned by `ptr_parent_key_ids`. Inited to [].
+ * ptr_parent_key_ids : Pointer to a map that associates each
+ *     interned parent key with its id. Inited to empty.
+ * token_handler : Handler that receives each token. Inited
+ *     to no handler.
+ * is_token_vector_kept : If false, tokens are only passed to
+ *     the token handler and neither the tokens nor their
+ *     literals are kept. Inited to true.
+ * token_count : Total number of tokens made, whether kept
+ *     or not. Inited to 0.
+ * last_token_type : Type of the last token made. Inited to
+ *     UNKNOWN_TOKEN.
+ * error_message : Message of the latest parser error, which
+ *     the returned error points to. Inited to empty.
+ * iter_key : Iter index of a parent key as C string, written
+ *     by `abel_json_token_parent_key`. Inited to empty.
  */
+#define JSON_PARSER_ERROR_MESSAGE_SIZE 256
 struct json_parser {
-    struct abel_vector token_vector;    // init to []
+    struct json_token_tape token_vector;    // init to []
     size_t current_line;    // init to 0
     size_t current_column;    // init to 0
     struct abel_string current_literal;    // init to ""
@@ -71,7 +184,18 @@ struct json_parser {
     struct abel_string latest_syntactic_operator;
     Bool is_escaping;    // init false
     Bool is_delimited_string_open;    // init to false
+    Bool is_in_comment;    // init to false
+    Bool is_root_closed;    // init to false
     enum literal_scheme current_literal_scheme;    // must be inited
+    struct abel_string literal_pool;    // init to ""
+    struct abel_vector parent_key_table;    // init to []
+    struct abel_map* ptr_parent_key_ids;    // init to empty
+    struct json_token_handler token_handler;    // init to none
+    Bool is_token_vector_kept;    // init to true
+    size_t token_count;    // init to 0
+    enum json_token_type last_token_type;    // init to UNKNOWN_TOKEN
+    char error_message[JSON_PARSER_ERROR_MESSAGE_SIZE];    // init to ""
+    char iter_key[24];    // init to ""
 };
 
 /**
@@ -83,16 +207,140 @@ struct json_parser {
  */
 void abel_make_json_parser(struct json_parser* ptr_parser);
 
+/**
+ * @brief Attach a token handler
+ * 
+ * Handler receives the tokens made from then on. It must be
+ * attached before parsing starts in order to receive all
+ * tokens.
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param handler Token handler.
+ * @param is_token_vector_kept If false, tokens are not kept
+ *        in token vector, which then stays empty.
+ */
+void abel_json_parser_set_token_handler(struct json_parser* ptr_parser,
+                                        struct json_token_handler handler,
+                                        Bool is_token_vector_kept);
+
+/**
+ * @brief Attach a SAX handler
+ * 
+ * Attaches the SAX handler as token handler and stops
+ * keeping tokens. It must be attached before parsing starts.
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param ptr_handler Pointer to SAX handler. Handler is not
+ *        copied and must outlive the parsing.
+ */
+void abel_json_parser_set_sax_handler(struct json_parser* ptr_parser,
+                                      struct json_sax_handler* ptr_handler);
+
 /**
  * @brief Parse a JSON file
  * 
  * @param ptr_parser Pointer to JSON parser.
  * @param file_name JSON file to be parsed.
+ * @return Option instance. Error PARSER_ERROR is returned if
+ *         the file cannot be opened, its content fails to
+ *         parse or is incomplete (see `abel_parser_finish`),
+ *         and MALLOC_FAILURE if the read buffer cannot
+ *         be allocated. The parser is left to be freed by
+ *         the caller in all cases.
+ */
+struct abel_return_option abel_parse_file(struct json_parser* ptr_parser,
+                                          char* file_name);
+
+/**
+ * @brief Parse a JSON document in memory
+ * 
+ * The whole buffer is parsed in one pass. Buffer doesn't
+ * have to be null-terminated and may contain any number of
+ * lines; line and column are tracked by the parser.
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param buffer Pointer to the first char of the document.
+ * @param length Number of chars in the buffer.
+ * @return Option instance. Per success, flag is_okay is true.
+ *         Per failure, error PARSER_ERROR is returned and
+ *         parsing stops at the offending char. A document
+ *         that is cut short is reported by
+ *         `abel_parser_finish`, which is called once the
+ *         whole buffer is parsed.
+ */
+struct abel_return_option abel_parse_buffer(struct json_parser* ptr_parser,
+                                            const char* buffer, size_t length);
+
+/**
+ * @brief Feed a chunk of a JSON document
+ * 
+ * Document is parsed incrementally, chunk after chunk, as
+ * it arrives, e.g. from a socket or pipe. A chunk may end
+ * anywhere, including inside a string or right after an
+ * escaping back slash; parsing resumes from the state kept
+ * in the parser. The chunk is not referred to after return.
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param chunk Pointer to the first char of the chunk.
+ * @param length Number of chars in the chunk.
+ * @return Option instance. Per failure, error PARSER_ERROR
+ *         is returned and the parser must not be fed again.
+ *         A closing symbol without opening one, and anything
+ *         but spaces and comments after the root container
+ *         is closed, are errors.
+ */
+struct abel_return_option abel_parser_feed(struct json_parser* ptr_parser,
+                                           const char* chunk, size_t length);
+
+/**
+ * @brief Finish a fed document
+ * 
+ * Called once the last chunk has been fed. Checks that the
+ * document is complete.
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @return Option instance. Per failure, error PARSER_ERROR
+ *         is returned if the document is empty, a delimited
+ *         string or a container is not closed, or a literal
+ *         is left outside of the root container.
+ */
+struct abel_return_option abel_parser_finish(struct json_parser* ptr_parser);
+
+/**
+ * @brief Parse a memory-mapped JSON file
+ * 
+ * The file is mapped into memory as a whole and parsed by
+ * `abel_parse_buffer`, which avoids copying the content
+ * through stdio buffers.
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param file_name JSON file to be parsed.
+ * @return Option instance. Error PARSER_ERROR is returned if
+ *         the file cannot be opened or mapped, or if the
+ *         content fails to parse or is incomplete.
+ */
+struct abel_return_option abel_parse_file_mapped(struct json_parser* ptr_parser,
+                                                 const char* file_name);
+
+/**
+ * @brief Literal of a token
+ * 
+ * Returns the literal of a token produced by the parser as
+ * a C string. The string is owned by the parser.
+ */
+const char* abel_json_token_literal(const struct json_parser* ptr_parser,
+                                    const struct json_token* ptr_token);
+
+/**
+ * @brief Parent key of a token
  * 
- * @todo Function `parse_line` may return errors which must
- *       be handled.
+ * Returns the parent key of a token produced by the parser
+ * as a C string. The string is owned by the parser. Parent
+ * key of a list element is its iter index, written into a
+ * buffer of the parser that the next call overwrites.
  */
-void abel_parse_file(struct json_parser* ptr_parser, char* file_name);
+const char* abel_json_token_parent_key(struct json_parser* ptr_parser,
+                                       const struct json_token* ptr_token);
 
 /**
  * @brief Free JSON parser
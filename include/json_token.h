@@ -58,23 +58,69 @@ enum json_terminal_type {
 extern const char* JsonTerminalTypeString[];
 const char* get_json_terminal_type_str(enum json_terminal_type term_type);
 
+/**
+ * @brief Slice of a literal pool
+ * 
+ * Literals of tokens are not stored in tokens, but copied
+ * one after another into a pool, i.e. a single string held
+ * by the parser. A slice locates a literal in the pool.
+ * 
+ * Fields
+ * 
+ * offset : Index of the first char of the literal in pool.
+ * length : Number of chars of the literal. In pool, each
+ *          literal is followed by a null char, which is
+ *          not counted.
+ */
+struct json_slice {
+    size_t offset;
+    size_t length;
+};
+
+/**
+ * @brief Append a literal to the pool
+ * 
+ * Copies the literal, including its terminating null char,
+ * to the end of the pool.
+ * 
+ * @return Slice that locates the literal in the pool.
+ */
+struct json_slice json_slice_append(struct abel_string* ptr_pool,
+                                    const char* literal, size_t length);
+
+/**
+ * @brief C string of a slice
+ * 
+ * Returns a pointer to the literal in the pool. Pointer is
+ * valid until the pool grows again.
+ */
+const char* json_slice_cstr(const struct abel_string* ptr_pool,
+                            struct json_slice slice);
+
 /**
  * @brief JSON token struct
  * 
  * JSON token instance and pointers are primarily used
  * internally by the parser and loader.
+ * 
+ * A token doesn't hold any resource. Its literal is a slice
+ * of the literal pool of the parser and its parent key is
+ * the id of a key interned by the parser, or the iter index
+ * of a list element tagged by JSON_TOKEN_ITER_KEY_ID. Use the parser to
+ * get either as C string. Referenced type is one of the
+ * static strings "", "Terminal", "Dict" and "List".
  */
 struct json_token {
-    struct abel_string* literal;        // holds resource
+    struct json_slice literal;
     enum json_token_type type;
-    struct abel_string* parent_key;     // holds resource
+    size_t parent_key_id;
     int level;
     int line;
     enum json_container_type container_type;
     int iter_index;
     enum json_terminal_type terminal_type; 
     enum literal_scheme literal_scheme;
-    struct abel_string* referenced_type; // holds resource
+    const char* referenced_type;
 };
 typedef struct json_token* json_token_ptr;
 
@@ -84,31 +130,29 @@ typedef struct json_token* json_token_ptr;
  * For iter_key, key, and terminal tokens, dedicated
  * tokenizer are available.
  * 
- * @note Arguments `literal` and `pk` will be copied
- *       onto heap, as token holds resources. Otherwise,
- *       multipled ownership will cause trouble. The
- *       side effect of such copying is that two memory
- *       locations must be freed at the end.
+ * @note Argument `literal` is a slice that has already been
+ *       appended to the literal pool, and `pk_id` the id of
+ *       the interned parent key. Nothing is copied onto heap.
  */
 struct json_token tokenize_iter_key(
-    struct abel_string* literal,
-    struct abel_string* pk,
+    struct json_slice literal,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type,
     int iter_index);
 
 struct json_token tokenize_key(
-    struct abel_string* literal,
-    struct abel_string* pk,
+    struct json_slice literal,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type,
     enum literal_scheme scheme);
 
 struct json_token tokenize_terminal(
-    struct abel_string* literal,
-    struct abel_string* pk,
+    struct json_slice literal,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type,
@@ -117,9 +161,9 @@ struct json_token tokenize_terminal(
 
 /* only for none of the above */
 struct json_token tokenize(
-    struct abel_string* literal,
+    struct json_slice literal,
     enum json_token_type type,
-    struct abel_string* pk,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type);
@@ -132,14 +176,114 @@ struct json_token tokenize(
 json_token_ptr abel_make_token_ptr(const struct json_token* ref_token);
 
 /**
- * @brief JSON token freer
+ * @brief JSON token pointer freer
  */
-void abel_free_json_token(struct json_token* ref_token);
+void abel_free_json_token_ptr(json_token_ptr ptr_token);
 
 /**
- * @brief JSON token pointer freer
+ * @brief JSON token tape
+ * 
+ * Token tape stores the tokens made by the parser one after
+ * another in a struct-of-arrays layout, i.e. each field of
+ * the tokens is kept in an array of its own, and the token
+ * at index i is made of the i-th element of every array.
+ * Walking the tape over a single field, for example the
+ * type, is thus linear in memory.
+ * 
+ * Fields
+ * 
+ * ptr_types, ptr_levels, ptr_terminal_types, ptr_literals
+ * and ptr_parent_key_ids : Fields read by the loader per
+ *     token.
+ * ptr_matching_indices : Index of the matching closing token
+ *     of an opening token and vice versa, such that a
+ *     container is walked without searching for its end.
+ *     JSON_TOKEN_NO_INDEX for the other tokens. While a
+ *     container is open, its opening token holds the index
+ *     of the enclosing open one instead.
+ * open_index : Index of the innermost open opening token.
+ * ptr_lines, ptr_container_types, ptr_iter_indices,
+ * ptr_literal_schemes and ptr_referenced_types : Fields
+ *     used by diagnostics.
+ * size : Total number of tokens on tape.
+ * capacity : Total number of tokens the arrays can hold.
  */
-void abel_free_json_token_ptr(json_token_ptr ptr_token);
+struct json_token_tape {
+    enum json_token_type* ptr_types;
+    int* ptr_levels;
+    enum json_terminal_type* ptr_terminal_types;
+    struct json_slice* ptr_literals;
+    size_t* ptr_parent_key_ids;
+    size_t* ptr_matching_indices;
+    int* ptr_lines;
+    enum json_container_type* ptr_container_types;
+    int* ptr_iter_indices;
+    enum literal_scheme* ptr_literal_schemes;
+    const char** ptr_referenced_types;
+    size_t open_index;
+    size_t size;
+    size_t capacity;
+};
+
+/* Matching index of a token that is neither opening nor closing */
+#define JSON_TOKEN_NO_INDEX SIZE_MAX
+
+/* Parent key id of a list element is its iter index with this
+ * bit set. Iter keys are not interned, so the key table of the
+ * parser doesn't grow with the length of a list. */
+#define JSON_TOKEN_ITER_KEY_ID ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+/**
+ * @brief Make an empty token tape
+ * 
+ * No memory is allocated until the first token is pushed.
+ */
+struct json_token_tape abel_make_token_tape();
+
+/**
+ * @brief Free token tape
+ * 
+ * Frees all arrays. The tape is left empty and usable.
+ */
+void abel_free_token_tape(struct json_token_tape* ptr_tape);
+
+/**
+ * @brief Token tape size
+ */
+size_t abel_token_tape_size(const struct json_token_tape* ptr_tape);
+
+/**
+ * @brief Push back a token onto tape
+ * 
+ * Fields of the token are copied into the arrays. All arrays
+ * grow together by doubling. A closing token is matched with
+ * the innermost open opening token.
+ * 
+ * @return Option instance. Per success, flag is_okay is true
+ *         and pointer is NULL. Per failure, REALLOC_FAILURE
+ *         error is returned and the tape is unchanged.
+ */
+struct abel_return_option abel_token_tape_push_back(
+    struct json_token_tape* ptr_tape, const struct json_token* ref_token);
+
+/**
+ * @brief Index of the closing token of a container
+ * 
+ * @param opening_idx Index of an opening token.
+ * @return Index of the matching closing token, or the tape
+ *         size if the container is not closed.
+ */
+size_t abel_token_tape_closing_index(const struct json_token_tape* ptr_tape,
+                                     size_t opening_idx);
+
+/**
+ * @brief Token at index
+ * 
+ * Gathers the fields of the token at given index into a
+ * token instance. Index must be less than the tape size.
+ */
+struct json_token abel_token_tape_at(const struct json_token_tape* ptr_tape,
+                                     size_t idx);
 
 /**
  * Token related utility functions
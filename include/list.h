@@ -73,7 +73,8 @@ Bool abel_list_is_valid_index(struct abel_list* ptr_list, size_t idx);
  * primitive and instrinsic types to a list.
  * 
  * In all append function, the actual action to append
- * is delegated to the append function of Vector.
+ * is delegated to the append function of Vector. Bool and
+ * Null are appended as the immortal objects of their value.
  * 
  * @param ptr_list : Pointer to the target list
  * @param src_data / ptr_src_data: Source data or the
@@ -143,7 +144,8 @@ struct abel_return_option abel_list_append_dict_ptr(
 /**
  * @brief Setter
  * 
- * Setter places an object at the given index.
+ * Setter places an object at the given index. Bool and
+ * Null are set as the immortal objects of their value.
  * 
  * @param ptr_list Pointer to the target list
  * @param src_data(ptr_src_data) Source data or the pointer
@@ -3,30 +3,107 @@
  *
  * General-purpose hash map.
  * 
- * Map consists of two vectors, one for pair registration
- * and the other for collision resolution.
+ * Map is an open-addressing hash table that resolves key
+ * collision by Robin Hood linear probing. A map holding
+ * only a few pairs keeps them inline and searches them
+ * linearly; it is promoted to the hashed form once it
+ * outgrows the inline storage. The slot table
+ * grows by doubling once the load factor is exceeded, and
+ * the pairs in the previous table are migrated to the new
+ * one incrementally, a few slots per insert or erase.
+ * Erase shifts the rest of the cluster back instead of
+ * leaving a tombstone, and the table shrinks once it is
+ * mostly empty.
+ * 
+ * Each function that takes a null-terminated key has an
+ * `_n` variant that takes the key as a pointer and a number
+ * of chars, such that a key can be used right where it is,
+ * e.g. in an input buffer, without a terminated copy.
  * 
  * Functions
  * 
  * - Maker
  *     map_ptr abel_make_map_ptr()
+ *     map_ptr abel_make_map_ptr_with_hash(HashFunc hash_func, uint64_t seed)
+ * - Freer
+ *     void abel_free_map_ptr(Map* ptr_map);
  * - Checker
  *     size_t abel_map_size(Map* ptr_map);
+ *     size_t abel_map_capacity(Map* ptr_map);
+ * - Capacity
+ *     Option abel_map_reserve(Map* ptr_map, size_t count);
+ *     Option abel_map_compact(Map* ptr_map);
+ * - Statistics
+ *     MapStats abel_map_stats(Map* ptr_map);
  * - Insert
  *     Option abel_map_insert(Map* ptr_map, char* key_str, void* ptr_data);
+ *     Option abel_map_insert_n(Map* ptr_map, const char* key_str, size_t key_length, void* ptr_data);
+ *     Option abel_map_insert_interned(Map* ptr_map, const char* interned_key, void* ptr_data);
  * - Getter
  *     Option abel_map_find(Map* ptr_map, char* key_str);
+ *     Option abel_map_find_n(Map* ptr_map, const char* key_str, size_t key_length);
+ *     Option abel_map_find_interned(Map* ptr_map, const char* interned_key, size_t* ptr_slot_hint);
  *     Option abel_map_at(Map* ptr_map, char* key_str);
+ *     Option abel_map_at_n(Map* ptr_map, const char* key_str, size_t key_length);
  * - Assign
  *     Option abel_map_assign(Map* ptr_map, char* key_str, void* ptr_data);
+ * - Erase
+ *     Option abel_map_erase(Map* ptr_map, char* key_str);
+ *     Option abel_map_erase_n(Map* ptr_map, const char* key_str, size_t key_length);
+ *     void abel_map_clear(Map* ptr_map);
+ * - Iterator
+ *     MapIterator abel_map_iter_begin(Map* ptr_map);
+ *     Pair* abel_map_iter_next(MapIterator* ptr_iter);
+ * - Interned keys
+ *     const char* abel_intern_key(const char* key_str);
+ *     const char* abel_intern_key_n(const char* key_str, size_t key_length);
+ *     void abel_release_interned_key(const char* interned_key);
+ *     size_t abel_interned_key_count();
+ *     const char* abel_find_interned_key(const char* key_str);
+ *     const char* abel_find_interned_key_n(const char* key_str, size_t key_length);
+ * - Key shapes
+ *     KeyShape* abel_key_shape_add_key(KeyShape* ptr_shape, const char* interned_key);
+ *     Bool abel_key_shape_find(const KeyShape* ptr_shape, const char* key_str, size_t* ptr_index);
+ *     Bool abel_key_shape_find_n(const KeyShape* ptr_shape, const char* key_str, size_t key_length, size_t* ptr_index);
+ *     void abel_release_key_shape(KeyShape* ptr_shape);
  **/
 #ifndef ABEL_ON_C_MAP_H
 #define ABEL_ON_C_MAP_H
 # include <stdint.h>
 
+#include "hashing_func.h"
 #include "vector.h"
 #include "linked_list.h"
 
+/**
+ * @brief Map slot
+ * 
+ * Slot is an element of the open-addressing table of a
+ * map. It is used internally by the map, except by freers
+ * that walk the tables to release the data of each pair.
+ * 
+ * Fields
+ * 
+ * ptr_pair : Pointer to the pair stored in this slot. It
+ *            is NULL if the slot is empty. In a table being
+ *            migrated, it points at an internal marker once
+ *            the pair is moved out.
+ * hash : Hash value of the key of the pair. It is kept in
+ *        the slot such that neither probing nor rehashing
+ *        requires hashing the key again.
+ * probe_length : Number of slots between the home slot of
+ *                the key and this slot, plus 1. An empty
+ *                slot has probe length 0.
+ */
+struct abel_map_slot {
+    struct abel_key_value_pair* ptr_pair;
+    uint32_t hash;
+    uint32_t probe_length;
+};
+
+/* Maximum number of pairs stored inline before hashing */
+#define MAP_SMALL_CAPACITY 8
+
 /**
  * @brief General-purpose (hash) map
  * 
@@ -36,22 +113,159 @@
  * 
  * Fields
  * 
- * ptr_pair_vector : Pointer to a Vector that is used to
- *                   store the key-value pairs.
- * ptr_coll_vector : Pointer to a Vector that is used to
- *                   register keys that collide with the
- *                   existing ones in item vector.
+ * small_slots : Inline slots used while the map holds
+ *               at most MAP_SMALL_CAPACITY pairs. In this
+ *               small mode, pairs occupy the leading slots
+ *               in insertion order and are searched linearly.
+ * ptr_slots : Pointer to the slot table on heap. It is
+ *             NULL while the map is in small mode.
+ * capacity : Total number of slots in the slot table. It
+ *            is either 0 (small mode) or a power of 2.
+ * ptr_old_slots : Pointer to the previous slot table whose
+ *                 pairs are being migrated after growth.
+ *                 It is NULL if no migration is going on.
+ * old_capacity : Total number of slots in previous table.
+ * rehash_index : Index of the next slot in the previous
+ *                table to be migrated.
  * size : Total number of pairs stored in the map,
- *        including the ones in both item and collision
- *        vectors.
- * @note Field `size` is not the size of the vector. The
- *       size of the vector is determined internally and
- *       is set to a default value.
+ *        including the ones in both slot tables.
+ * hash_func : Hash function of the map, one of the family
+ *             in hashing_func.h or any other HashFunc.
+ * hash_seed : Seed passed to the hash function.
+ * ptr_entries : Pairs in insertion order, used for
+ *               iteration once the map leaves small mode.
+ *               Entry of an erased pair is set to NULL;
+ *               entries are compacted once more than half of
+ *               them are erased.
+ * entry_count : Number of entries in use, erased included.
+ * entry_capacity : Number of entries allocated.
+ * lookup_count, hit_count, miss_count, probe_count :
+ *     Counters of key lookups, only if the library is built
+ *     with ABEL_MAP_COUNTERS defined.
+ * @note Field `size` is not the capacity of the table.
+ *       The capacity is managed internally by the map.
  */
 struct abel_map {
-    struct abel_vector* ptr_pair_vector;
-    struct abel_vector* ptr_coll_vector;
+    struct abel_map_slot small_slots[MAP_SMALL_CAPACITY];
+    struct abel_map_slot* ptr_slots;
+    size_t capacity;
+    struct abel_map_slot* ptr_old_slots;
+    size_t old_capacity;
+    size_t rehash_index;
+    size_t size;
+    HashFunc hash_func;
+    uint64_t hash_seed;
+    struct abel_key_value_pair** ptr_entries;
+    size_t entry_count;
+    size_t entry_capacity;
+#ifdef ABEL_MAP_COUNTERS
+    size_t lookup_count;
+    size_t hit_count;
+    size_t miss_count;
+    size_t probe_count;
+#endif
+};
+
+/* Number of bins of the probe length histogram */
+#define MAP_STATS_HISTOGRAM_SIZE 8
+
+/**
+ * @brief Map statistics
+ * 
+ * Snapshot of the layout of a map, made by `abel_map_stats`,
+ * to see why lookups in a map are slow or where its memory
+ * goes.
+ * 
+ * Fields
+ * 
+ * size : Number of pairs.
+ * capacity : Number of slots, see `abel_map_capacity`.
+ * load_factor : Size over capacity.
+ * max_probe_length : Largest number of slots probed to find
+ *                    a key of the map. In small mode, it is
+ *                    the position of the key plus 1.
+ * mean_probe_length : Mean of the above over all keys.
+ * probe_histogram : Number of keys found after probing 1,
+ *                   2, ... slots. The last bin counts all
+ *                   keys of MAP_STATS_HISTOGRAM_SIZE or more.
+ * bytes : Bytes allocated by the map, i.e. map, slot tables,
+ *         entries and pairs with their keys. Interned keys,
+ *         shared by many maps, and malloc overhead are left
+ *         out.
+ * lookup_count, hit_count, miss_count, probe_count : Copy of
+ *     the counters of the map if the library is built with
+ *     ABEL_MAP_COUNTERS defined, otherwise 0. Probes of a
+ *     hit are the probe length of the slot found.
+ */
+struct abel_map_stats {
     size_t size;
+    size_t capacity;
+    double load_factor;
+    size_t max_probe_length;
+    double mean_probe_length;
+    size_t probe_histogram[MAP_STATS_HISTOGRAM_SIZE];
+    size_t bytes;
+    size_t lookup_count;
+    size_t hit_count;
+    size_t miss_count;
+    size_t probe_count;
+};
+
+/**
+ * @brief Map iterator
+ * 
+ * Iterator visits the pairs of a map in insertion order.
+ * It is made by `abel_map_iter_begin`, and is valid as long
+ * as no pair is inserted into or erased from the map.
+ * 
+ * Fields
+ * 
+ * ptr_map : Map being iterated.
+ * index : Index of the next inline slot or entry.
+ */
+struct abel_map_iterator {
+    struct abel_map* ptr_map;
+    size_t index;
+};
+
+/**
+ * @brief Key shape
+ * 
+ * Shape is the sequence of interned keys a record was
+ * built with, e.g. the keys of each element of a list of
+ * homogeneous objects. Records built by inserting the same
+ * keys in the same order share one shape, such that each
+ * record only has to store its values, in the slot order
+ * of the shape.
+ * 
+ * Shapes form a tree rooted at the empty shape. The child
+ * reached by adding a key to a shape is kept in the map of
+ * transitions of the shape, so equal key sequences always
+ * end at the same shape.
+ * 
+ * Fields
+ * 
+ * ref_count : Number of records and child shapes referring
+ *             to the shape. Shape is freed once it is 0.
+ * id : Number that identifies the shape for the lifetime
+ *      of the process. It is never reused, unlike the
+ *      address of a freed shape.
+ * size : Number of keys.
+ * ptr_keys : Interned keys in slot order.
+ * ptr_parent : Shape without the last key, NULL for the
+ *              empty shape.
+ * ptr_transitions : Map from the interned key to the child
+ *                   shape. It is NULL until the first child
+ *                   is made. Children are not referred to
+ *                   by their parent.
+ */
+struct abel_key_shape {
+    size_t ref_count;
+    uint64_t id;
+    size_t size;
+    const char** ptr_keys;
+    struct abel_key_shape* ptr_parent;
+    struct abel_map* ptr_transitions;
 };
 
 /**
@@ -60,18 +274,41 @@ struct abel_map {
  * Key-value pair is the object that a map stores.
  * The internal vectors of a map store pointers to
  * the pair objects usually created on heap.
+ * 
+ * Fields
+ * 
+ * ptr_data : Pointer to the data associated with the key.
+ * key : Null-terminated key. It points either at the chars
+ *       of this pair, or at an interned key shared by all
+ *       pairs of the same key.
+ * hash : Hash value of the key by the hash function of the
+ *        map that made the pair.
+ * key_length : Number of chars of the key.
+ * entry_index : Index of the pair in the entries of the
+ *               map, unless the map is in small mode.
+ * key_chars : Chars of the key, stored inline right after
+ *             the other fields in the same allocation. It is
+ *             empty if the key is interned.
+ * 
+ * Keys are compared by pointer first, which decides for
+ * interned keys, and then by hash and length, such that the
+ * chars of a key are only read when both match.
  */
 struct abel_key_value_pair {
-    char* key;
     void* ptr_data;
+    char* key;
+    uint32_t hash;
+    uint32_t key_length;
+    size_t entry_index;
+    char key_chars[];
 };
 
 /**
  * @brief Free a pair
  * 
- * When used internally, a pair is always created on heap.
- * Special attention shall be paid to the memory allocated
- * to store the key string.
+ * When used internally, a pair is always created on heap,
+ * together with its key, in a single allocation. If the key
+ * is interned, the reference of the pair to it is released.
  * 
  * @param ptr_pair : Pointer to the pair instance to be
  *                   freed.
@@ -84,14 +321,44 @@ struct abel_return_option abel_free_pair(struct abel_key_value_pair* ptr_pair);
 /**
  * @brief Make a map on heap
  * 
- * A map instance is created on heap together with
- * its internal vectors. Map size is set to 0, i.e.
- * an empty map.
+ * A map instance is created on heap. Map size is set
+ * to 0, i.e. an empty map, in small mode. The slot table
+ * is only allocated once the map holds more pairs than
+ * MAP_SMALL_CAPACITY, so a small map costs no allocation
+ * beyond the map instance and its pairs.
  * 
  * @return Pointer to the map instance created on heap.
+ *         Should malloc fail, NULL is returned.
  */
 struct abel_map* abel_make_map_ptr();
 
+/**
+ * @brief Make a map on heap with a given hash function
+ * 
+ * Map made by `abel_make_map_ptr` hashes keys by wyhash
+ * seeded by the per-process random seed, which defends the
+ * map against keys crafted to collide. A map whose keys are
+ * trusted may select a cheaper function, or a fixed seed to
+ * get reproducible slot layout.
+ * 
+ * @param hash_func Hash function used for all keys.
+ * @param seed Seed passed to the hash function.
+ * @return Pointer to the map instance created on heap.
+ *         Should malloc fail, NULL is returned.
+ */
+struct abel_map* abel_make_map_ptr_with_hash(HashFunc hash_func, uint64_t seed);
+
+/**
+ * @brief Free a map on heap
+ * 
+ * Frees the slot tables, all pairs and the map itself.
+ * 
+ * @note Map is not responsible for the data the pairs are
+ *       pointing at. Resource management of such data must
+ *       be done by caller before freeing the map.
+ */
+void abel_free_map_ptr(struct abel_map* ptr_map);
+
 /**
  * @brief Map size
  * 
@@ -99,6 +366,64 @@ struct abel_map* abel_make_map_ptr();
  */
 size_t abel_map_size(struct abel_map* ptr_map);
 
+/**
+ * @brief Map capacity
+ * 
+ * Capacity is the total number of slots in the current slot
+ * table. For a map in small mode, it is the number of inline
+ * slots, i.e. MAP_SMALL_CAPACITY.
+ */
+size_t abel_map_capacity(struct abel_map* ptr_map);
+
+/**
+ * @brief Reserve room for pairs
+ * 
+ * Sizes the slot table, and the entries, once such that the
+ * map holds `count` pairs in total without growing. Pairs
+ * already in the map are moved into the new table at once,
+ * including those of a migration in progress. Map is left
+ * as it is if it is already large enough.
+ * 
+ * @param count : Total number of pairs to make room for.
+ * @return Option instance. Per failure of malloc, error
+ *         MALLOC_FAILURE is returned and map is unchanged.
+ */
+struct abel_return_option abel_map_reserve(struct abel_map* ptr_map,
+                                           size_t count);
+
+/**
+ * @brief Compact a map
+ * 
+ * Releases the room a map does not need for its pairs: the
+ * slot table is replaced by the smallest one that holds them,
+ * or by the inline slots if they fit, and the entries of
+ * erased pairs are dropped.
+ * 
+ * Erase already shrinks a table whose load factor drops
+ * below MAP_MIN_LOAD_FACTOR, so this is only needed to give
+ * back the rest, e.g. for a map that will not change again.
+ * 
+ * @return Option instance. Per failure of malloc, error
+ *         MALLOC_FAILURE is returned and map is unchanged.
+ */
+struct abel_return_option abel_map_compact(struct abel_map* ptr_map);
+
+/**
+ * @brief Map statistics
+ * 
+ * Walks all slots of the map, so it costs time in proportion
+ * to the capacity.
+ */
+struct abel_map_stats abel_map_stats(struct abel_map* ptr_map);
+
+/**
+ * @brief Is slot live
+ * 
+ * Returns true if the slot holds a pair of the map, i.e. it
+ * is neither empty nor migrated.
+ */
+Bool abel_map_slot_is_live(const struct abel_map_slot* ptr_slot);
+
 /**
  * @brief Insert key-value into map
  * 
@@ -111,11 +436,38 @@ size_t abel_map_size(struct abel_map* ptr_map);
  *         - Per success, flag is_okay is true and `pointer`
  *           contains the pair that has just been inserted.
  *         - Per error, flag is_error is true and error stores
- *           the specific error.
+ *           the specific error, KEY_EXISTS if the key is
+ *           already in map or MALLOC_FAILURE if the slot
+ *           table cannot grow.
  */
 struct abel_return_option abel_map_insert(
     struct abel_map* ptr_map, char* key_str, void* ptr_data);
 
+/**
+ * @brief Insert key-value with a key of given length
+ * 
+ * Same as `abel_map_insert`, except that the key is the
+ * first `key_length` chars at `key_str`, which need not be
+ * null-terminated. The pair stores a terminated copy.
+ */
+struct abel_return_option abel_map_insert_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length, void* ptr_data);
+
+/**
+ * @brief Insert key-value with an interned key
+ * 
+ * Same as `abel_map_insert`, except that the pair refers
+ * to the interned key instead of copying it, and holds a
+ * reference to it until the pair is freed. If the map hashes
+ * keys the same way as the table of interned keys, which is
+ * the case of maps made by `abel_make_map_ptr`, the key is
+ * not hashed again.
+ * 
+ * @param interned_key : Key returned by `abel_intern_key`.
+ */
+struct abel_return_option abel_map_insert_interned(
+    struct abel_map* ptr_map, const char* interned_key, void* ptr_data);
+
 /**
  * @brief Find pair which has the given key
  * 
@@ -134,6 +486,31 @@ struct abel_return_option abel_map_insert(
 struct abel_return_option abel_map_find(
     struct abel_map* ptr_map, char* key_str);
 
+/**
+ * @brief Find pair by a key of given length
+ * 
+ * Same as `abel_map_find` for the first `key_length` chars
+ * at `key_str`.
+ */
+struct abel_return_option abel_map_find_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length);
+
+/**
+ * @brief Find pair by an interned key with a slot hint
+ * 
+ * The slot at `*ptr_slot_hint` is checked first; if it holds
+ * the key, the pair is returned without probing. Hash kept
+ * with the interned key is used, so the key is not hashed.
+ * Otherwise the key is searched as usual, and the hint is
+ * set to the slot found. A hint may be any number, e.g. 0 at first.
+ * 
+ * @param interned_key : Key returned by `abel_intern_key`.
+ * @param ptr_slot_hint : Slot hint of the caller.
+ * @return Same as `abel_map_find`.
+ */
+struct abel_return_option abel_map_find_interned(struct abel_map* ptr_map,
+    const char* interned_key, size_t* ptr_slot_hint);
+
 /**
  * @brief Get value by key
  * 
@@ -151,6 +528,12 @@ struct abel_return_option abel_map_find(
 struct abel_return_option abel_map_at(
     struct abel_map* ptr_map, char* key_str);
 
+/**
+ * @brief Get value by a key of given length
+ */
+struct abel_return_option abel_map_at_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length);
+
 /**
  * @brief Assign a value to the key
  * 
@@ -175,21 +558,153 @@ struct abel_return_option abel_map_assign(
 /**
  * @brief Erase a key-value pair
  * 
- * If key exists, the pair is disconnected from the vector
- * or linked list and it is returned. Otherwise, returns
- * KEY_NOT_FOUND error. Should the pair be found on a linked
- * list, the node that was connected to the pair is erased
- * and freed.
+ * If key exists, the pair is disconnected from the slot
+ * table and it is returned. Otherwise, returns KEY_NOT_FOUND
+ * error. Slots after the erased one are shifted back, so no
+ * tombstone is left. Once fewer than MAP_MIN_LOAD_FACTOR of
+ * the slots are used, the table is replaced by one half full.
  * 
  * @return Option instance.
  *         - If success, flag `is_okay` is `true` and the PAIR
  *           with the given key is returned in pointer.
  *         - If failure, flag `is_error` is `true` and the
  *           error is stored in `error`. 
- * @note If the key-value pair is found on the linked list,
- *       i.e. key collision case, the node is erased and freed.
+ * @note The returned pair is no longer owned by the map and
+ *       must be freed by caller.
  */
 struct abel_return_option abel_map_erase(
     struct abel_map* ptr_map, char* key_str);
 
+/**
+ * @brief Erase a key-value pair by a key of given length
+ */
+struct abel_return_option abel_map_erase_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length);
+
+/**
+ * @brief Clear map
+ * 
+ * Frees all pairs but keeps the slot table and entries, so
+ * a map that is filled and cleared over and over doesn't
+ * allocate again. Data held by the pairs is not freed.
+ */
+void abel_map_clear(struct abel_map* ptr_map);
+
+/**
+ * @brief Begin iteration of a map
+ * 
+ * Iteration costs time in proportion to the size of the
+ * map, not to the capacity of its slot table.
+ */
+struct abel_map_iterator abel_map_iter_begin(struct abel_map* ptr_map);
+
+/**
+ * @brief Next pair of iteration
+ * 
+ * @return Pointer to the next pair in insertion order, or
+ *         NULL once all pairs are visited.
+ */
+struct abel_key_value_pair* abel_map_iter_next(
+    struct abel_map_iterator* ptr_iter);
+
+/**
+ * @brief Intern a key
+ * 
+ * Interned keys are kept in a table shared by the whole
+ * process, such that equal keys share one buffer and can be
+ * compared by pointer. Each call takes a reference to the
+ * key, which must be given back by
+ * `abel_release_interned_key`.
+ * 
+ * @param key_str : Key to be interned.
+ * @return Interned copy of the key. Should malloc fail, NULL
+ *         is returned.
+ * @note The table is synchronised only if the library is
+ *       built with ABEL_ATOMIC_REF_COUNT defined. Keys and
+ *       shapes are then made, found and released under one
+ *       lock, otherwise not from several threads at once.
+ */
+const char* abel_intern_key(const char* key_str);
+
+/**
+ * @brief Intern a key of given length
+ * 
+ * Interned copy is null-terminated.
+ */
+const char* abel_intern_key_n(const char* key_str, size_t key_length);
+
+/**
+ * @brief Release an interned key
+ * 
+ * Gives back a reference taken by `abel_intern_key`. Key is
+ * removed from the table once its last reference is gone.
+ */
+void abel_release_interned_key(const char* interned_key);
+
+/**
+ * @brief Number of interned keys
+ */
+size_t abel_interned_key_count();
+
+/**
+ * @brief Find an interned key
+ * 
+ * Unlike `abel_intern_key`, no key is interned and no
+ * reference is taken.
+ * 
+ * @return Interned key equal to the given key, or NULL if
+ *         the key is not interned.
+ */
+const char* abel_find_interned_key(const char* key_str);
+
+/**
+ * @brief Find an interned key of given length
+ */
+const char* abel_find_interned_key_n(const char* key_str, size_t key_length);
+
+/**
+ * @brief Add a key to a shape
+ * 
+ * Returns the shape made of the keys of the given shape
+ * followed by the given key, and takes a reference to it.
+ * The given shape is left as it is, its reference is to be
+ * released by caller once no longer needed.
+ * 
+ * @param ptr_shape : Shape to be extended. If it is NULL,
+ *                    the empty shape is extended.
+ * @param interned_key : Key returned by `abel_intern_key`.
+ *                       It must not be in the shape yet.
+ * @return Pointer to the shape, or NULL if malloc fails.
+ */
+struct abel_key_shape* abel_key_shape_add_key(
+    struct abel_key_shape* ptr_shape, const char* interned_key);
+
+/**
+ * @brief Find the slot of a key in shape
+ * 
+ * An interned key is found by pointer, any other by its
+ * chars. Shared tables are not locked, as the keys of a
+ * shape don't change while it is held.
+ * 
+ * @param ptr_index : Set to the slot of the key if found.
+ * @return If key is found, returns `true`; otherwise `false`.
+ */
+Bool abel_key_shape_find(const struct abel_key_shape* ptr_shape,
+    const char* key_str, size_t* ptr_index);
+
+/**
+ * @brief Find the slot of a key of given length in shape
+ */
+Bool abel_key_shape_find_n(const struct abel_key_shape* ptr_shape,
+    const char* key_str, size_t key_length, size_t* ptr_index);
+
+/**
+ * @brief Release a shape
+ * 
+ * Gives back a reference taken by `abel_key_shape_add_key`.
+ * Shape is freed, and released by its parent, once its last
+ * reference is gone.
+ */
+void abel_release_key_shape(struct abel_key_shape* ptr_shape);
+
 #endif
\ No newline at end of file
@@ -119,7 +119,8 @@ struct abel_object* abel_make_object_ptr_from_dict_ptr(
  *        the data is acquired
  *
  * @return Returns the data (not pointer) the object
- *         wrapper holds.
+ *         wrapper holds. Bool, Null, int and double are
+ *         read from the object itself.
  *
  * Caution
  *
@@ -169,6 +170,79 @@ double abel_object_get_double(struct abel_object* ptr_obj);
 
 #endif
 
+/*
+ * Immortal objects
+ *
+ * Process-wide objects of null, true and false. They are
+ * shared by all containers that hold these values, such
+ * that no object is made per value. Their ref count is
+ * pinned at OBJECT_IMMORTAL_REF_COUNT and the object freer
+ * ignores them.
+ *
+ * Caution
+ *
+ * Data of an immortal object must not be modified, as it is
+ * seen by every holder: writing true through the Bool of one
+ * dict would turn every false of the process into true. Getters of Bool
+ * data, e.g. `abel_dict_get_bool_ptr`, thus return a pointer
+ * to const, and so must any getter that may reach the data
+ * of an immortal object. Objects of a document share the
+ * pinned ref count but not the data.
+ */
+
+#define OBJECT_IMMORTAL_REF_COUNT SIZE_MAX
+
+/**
+ * @brief Immortal object of null
+ */
+struct abel_object* abel_null_object_ptr();
+
+/**
+ * @brief Immortal object of true or false
+ */
+struct abel_object* abel_bool_object_ptr(Bool value);
+
+/**
+ * @brief Is object immortal
+ */
+Bool abel_object_is_immortal(struct abel_object* ptr_obj);
+
+/*
+ * References
+ *
+ * If the library is built with ABEL_ATOMIC_REF_COUNT
+ * defined, the ref count is a C11 atomic. A reference is
+ * added with a relaxed increment and dropped by the object
+ * freer with an acquire-release decrement, such that a
+ * loaded tree can be held by several threads and is freed
+ * by the one that drops the last reference.
+ *
+ * Caution
+ *
+ * The table of interned keys and the tree of key shapes,
+ * which all dicts share, are then guarded by a lock, so
+ * threads may make, read and free dicts at the same time.
+ * Containers themselves are not locked and must not be
+ * modified while shared.
+ */
+
+/**
+ * @brief Add a reference to an object
+ *
+ * Called by a container that takes the object. Ref count of
+ * an immortal object is left pinned.
+ */
+void abel_object_add_ref(struct abel_object* ptr_obj);
+
+/**
+ * @brief Add a reference to a thread-local object
+ *
+ * Same as `abel_object_add_ref` but without a locked
+ * increment in the atomic mode. Only for objects that no
+ * other thread can reach yet, e.g. while a tree is built.
+ */
+void abel_object_add_ref_local(struct abel_object* ptr_obj);
+
 /* Get container pointer */
 struct abel_list* abel_object_get_list_ptr(struct abel_object* ptr_obj);
 struct abel_dict* abel_object_get_dict_ptr(struct abel_object* ptr_obj);
@@ -238,7 +312,8 @@ struct abel_return_option abel_free_dict_ptr(struct abel_dict* ptr_dict);
  * the object it has instructed the freer to delete it. So,
  * just free it. Should the ref count be higher than 1, there
  * must be other owners - multiple ownership - and the freer
- * will only reduce the ref count by 1.
+ * will only reduce the ref count by 1. Immortal objects are
+ * never freed.
  *
  * Caution
  * 
@@ -9,6 +9,10 @@
 #define ABEL_ON_C_TYPEFY_H
 
 #include <ctype.h>
+#include <stdint.h>
+#ifdef ABEL_ATOMIC_REF_COUNT
+#include <stdatomic.h>
+#endif
 #include "common.h"
 
 /**
@@ -95,7 +99,12 @@ typedef struct abel_complex Complex;
  *
  * ptr_data : Pointer (`void` type) to the original data.
  *     It is chosen to be `void*` to accept any type,
- *     including container types such as list and dict
+ *     including container types such as list and dict.
+ *     For Bool, Null, int and double it points at `value`
+ *
+ * value : Data of Bool, Null, int and double, stored inline
+ *     such that the object needs no separate allocation and
+ *     getters read it without following `ptr_data`
  *
  * data_size : Size of original data type. For example, if
  *     the original data is `int`, the corresponding data
@@ -104,7 +113,10 @@ typedef struct abel_complex Complex;
  * data_type : Data type of the original data. It must be
  *     a variant in enum `DataType`
  * 
- * ref_count : Number of references made by containers
+ * ref_count : Number of references made by containers. It
+ *     is a C11 atomic if the library is built with
+ *     ABEL_ATOMIC_REF_COUNT defined, such that objects can
+ *     be shared by threads
  *
  * Caution
  *
@@ -115,10 +127,33 @@ typedef struct abel_complex Complex;
  */
 struct abel_object {
     void* ptr_data;
+    union {
+        Bool bool_value;
+        Null null_value;
+        int int_value;
+        double double_value;
+    } value;
     enum data_type data_type;
-    size_t data_size;
+    uint32_t data_size;    // 32 bits keep the object at 32 bytes
+#ifdef ABEL_ATOMIC_REF_COUNT
+    _Atomic size_t ref_count;
+#else
     size_t ref_count;
+#endif
 };
+
+/**
+ * @brief Set ref count of an object that is not yet shared
+ *
+ * A plain store, also in the atomic mode.
+ */
+#ifdef ABEL_ATOMIC_REF_COUNT
+#define ABEL_OBJECT_INIT_REF_COUNT(ptr_obj, count) \
+    atomic_init(&(ptr_obj)->ref_count, (count))
+#else
+#define ABEL_OBJECT_INIT_REF_COUNT(ptr_obj, count) \
+    ((ptr_obj)->ref_count = (count))
+#endif
 //typedef struct abel_object Object;
 //typedef struct abel_object* object_ptr;
 
@@ -138,11 +173,16 @@ struct abel_object {
  *     by the pointers stored in vector. This field is used
  *     mostly to cast a void pointer to its designated type
  *   
+ * is_read_only : True if the list belongs to a document, whose
+ *     arena holds its storage. Such a list refuses mutation
+ *     and freeing.
+ *   
  * @see list.h
  */
 struct abel_list {
     struct abel_vector* ptr_vector;
     enum data_type data_type;
+    Bool is_read_only;
 };
 //typedef struct abel_list List;
 //typedef struct abel_list* list_ptr;
@@ -154,19 +194,38 @@ struct abel_list {
  * It carries a field `DataType data_type` to register the
  * type of data associated with the key.
  *
+ * A dict whose keys are all inserted interned is kept in
+ * shape form instead: it refers to the shape of its key
+ * sequence, shared by all dicts of the same keys, and only
+ * stores its values. It turns into a map on the first
+ * insert of a key that is not interned, or on delete.
+ *
  * Fields
  *
- * ptr_map : Pointer to internal map allocated on heap
+ * ptr_map : Pointer to internal map allocated on heap. It
+ *     is NULL while the dict is empty or in shape form.
  *   
  * data_type : Data type of the values that are associated
  *     with the keys. Its primary use is casting a void pointer
  *     to its designated type.
+ *
+ * ptr_shape : Shape of the keys while in shape form,
+ *     otherwise NULL.
+ *
+ * ptr_values : Values in the slot order of the shape.
+ *
+ * is_read_only : True if the dict belongs to a document. Its
+ *     values and shape are owned by the document, so insert,
+ *     delete and freeing are refused.
  *  
  * @see dict.h
  **/
 struct abel_dict {
     struct abel_map* ptr_map;
     enum data_type data_type;
+    struct abel_key_shape* ptr_shape;
+    struct abel_object** ptr_values;
+    Bool is_read_only;
 };
 //typedef struct abel_dict Dict;
 //typedef struct abel_dict* dict_ptr;
@@ -2,19 +2,12 @@
 
 #include "astring.h"
 
-static char* pointer_to_internal_array(size_t size_requested)
-{
-    char* ptr_array;
-    ptr_array = malloc( sizeof(char)*(size_requested) );
-    return ptr_array;
-}
-
 /**
  * @brief Static - Return size to be requested
  * 
  * The returned size-to-be-requested is larger than the
  * combined length of string and null-terminator, and it
- * is always a multiple of 4 bytes.
+ * is always a power of 2.
  * 
  * @param src_net_length Net length of a string with the null
  *     terminator
@@ -28,57 +21,103 @@ static size_t requested_size(size_t src_net_length)
     return size_requested;
 }
 
+/**
+ * @brief Static - Is the string held inline
+ * 
+ * Last inline char is a null char for an inline string and
+ * the capacity shift, at least 5, for a string on heap.
+ */
+static Bool is_small(const struct abel_string* ptr_str)
+{
+    return (ptr_str->data.small_array[STRING_SMALL_SIZE - 1] == '\0');
+}
+
+/**
+ * @brief Static - Make room for a number of chars
+ * 
+ * An inline string that outgrows the inline array moves to
+ * heap, and a string on heap is reallocated if the array
+ * is short.
+ * 
+ * @param net_length Number of chars without null-terminator.
+ * @return Pointer to the chars, or NULL if allocation fails,
+ *         in which case the string is unchanged.
+ */
+static char* reserve_chars(struct abel_string* ptr_str, size_t net_length)
+{
+    size_t size_requested = 0;
+    unsigned char capacity_shift = 0;
+    char* ptr_array = NULL;
+    if (is_small(ptr_str)) {
+        if (net_length < STRING_SMALL_SIZE) {
+            return ptr_str->data.small_array;
+        }
+        size_requested = requested_size(net_length);
+        ptr_array = malloc( sizeof(char)*size_requested );
+        if (ptr_array == NULL) {
+            return NULL;
+        }
+        memcpy(ptr_array, ptr_str->data.small_array, ptr_str->length + 1);
+    } else {
+        if (net_length < ((size_t)1 << ptr_str->data.heap.capacity_shift)) {
+            return ptr_str->data.heap.ptr_array;
+        }
+        size_requested = requested_size(net_length);
+        ptr_array = realloc( ptr_str->data.heap.ptr_array,
+                             sizeof(char)*size_requested );
+        if (ptr_array == NULL) {
+            return NULL;
+        }
+    }
+    while (((size_t)1 << capacity_shift) < size_requested) {
+        capacity_shift++;
+    }
+    ptr_str->data.heap.ptr_array = ptr_array;
+    ptr_str->data.heap.capacity_shift = capacity_shift;
+    return ptr_array;
+}
+
 struct abel_string abel_make_string(char* src_cstr)
 {
     struct abel_string string;
-    size_t src_net_length = strlen(src_cstr);    // length without null
-    size_t size_requested = requested_size(src_net_length);
-    /* resource is allocated on heap */
-    string.ptr_array = pointer_to_internal_array(size_requested);
-    /* source is duplicated on heap */
-    strncpy(string.ptr_array, src_cstr, src_net_length + 1);
-    string.length = src_net_length;
-    string.capacity = size_requested;
+    string.length = 0;
+    string.data.small_array[0] = '\0';
+    string.data.small_array[STRING_SMALL_SIZE - 1] = '\0';
+    abel_string_assign(&string, src_cstr);
     return string;
 }
 
 struct abel_string abel_string_from_int(int src_int)
 {
-    struct abel_string string;
-    /* net length does not include plus sign */
-    int net_length = snprintf(NULL, 0, "%d", src_int);
-    char* ptr_str = malloc( (net_length + 1)*sizeof(*ptr_str) );
-    snprintf(ptr_str, net_length + 1, "%d", src_int);
-    /* content in ptr_str is copied ... */
-    string = abel_make_string(ptr_str);
-    /* ... and it must be freed. */
-    free(ptr_str);
-    return string;
+    /* net length does not include plus sign, fits inline */
+    char int_str[3 * sizeof(int) + 2];
+    snprintf(int_str, sizeof(int_str), "%d", src_int);
+    return abel_make_string(int_str);
 }
 
 void abel_free_string(struct abel_string* ptr_str)
 {
-    free(ptr_str->ptr_array);
+    if (!is_small(ptr_str)) {
+        free(ptr_str->data.heap.ptr_array);
+    }
+    ptr_str->length = 0;
+    ptr_str->data.small_array[0] = '\0';
+    ptr_str->data.small_array[STRING_SMALL_SIZE - 1] = '\0';
 }
 
 struct abel_string* abel_make_string_ptr(char* src_cstr)
 {
     /* memory for string instance */
     struct abel_string* ptr = malloc( sizeof(*ptr) );
-    size_t src_net_length = strlen(src_cstr);    // length without null
-    size_t size_requested = requested_size(src_net_length);
-    /* resource is allocated on heap */
-    ptr->ptr_array = pointer_to_internal_array(size_requested);
-    /* source C string is copied on heap */
-    strncpy(ptr->ptr_array, src_cstr, src_net_length + 1);
-    ptr->length = src_net_length;
-    ptr->capacity = size_requested;
+    if (ptr != NULL) {
+        *ptr = abel_make_string(src_cstr);
+    }
     return ptr;
 }
 
 void abel_free_string_ptr(struct abel_string* ptr_str)
 {
-    free(ptr_str->ptr_array);
+    abel_free_string(ptr_str);
     free(ptr_str);
 }
 
@@ -89,7 +128,18 @@ size_t abel_string_len(struct abel_string* ptr_str) {
 }
 
 size_t abel_string_capacity(struct abel_string* ptr_str) {
-    return ptr_str->capacity;
+    if (is_small(ptr_str)) {
+        return STRING_SMALL_SIZE;
+    }
+    return (size_t)1 << ptr_str->data.heap.capacity_shift;
+}
+
+char* abel_string_cstr(const struct abel_string* ptr_str)
+{
+    if (is_small(ptr_str)) {
+        return (char*)ptr_str->data.small_array;
+    }
+    return ptr_str->data.heap.ptr_array;
 }
 
 /* Assign */
@@ -97,14 +147,11 @@ size_t abel_string_capacity(struct abel_string* ptr_str) {
 void abel_string_assign(struct abel_string* ptr_str, char* src_cstr)
 {
     size_t src_net_length = strlen(src_cstr);    // length without null
-    size_t size_requested = requested_size(src_net_length);
-    /* free the current content */
-    free(ptr_str->ptr_array);
-    /* allocate again */
-    ptr_str->ptr_array = pointer_to_internal_array(size_requested);
-    strncpy(ptr_str->ptr_array, src_cstr, src_net_length + 1);
-    ptr_str->length = src_net_length;
-    ptr_str->capacity = size_requested;
+    char* ptr_array = reserve_chars(ptr_str, src_net_length);
+    if (ptr_array != NULL) {
+        memcpy(ptr_array, src_cstr, src_net_length + 1);
+        ptr_str->length = src_net_length;
+    }
 }
 
 void abel_string_assign_char(struct abel_string* ptr_str, char src_char)
@@ -120,19 +167,7 @@ void abel_string_assign_char(struct abel_string* ptr_str, char src_char)
  */
 void abel_string_append(struct abel_string* ptr_str, char* src_cstr)
 {
-    char* ptr = NULL;
-    if (strlen(src_cstr) > 0) {
-        size_t new_net_length = ptr_str->length + strlen(src_cstr);
-        size_t new_requested = requested_size(new_net_length);
-        if (new_requested > ptr_str->capacity) {   // need to realloc
-            ptr_str->ptr_array = realloc( ptr_str->ptr_array,
-                                          new_requested * sizeof(char) );
-            ptr_str->capacity = new_requested;
-        }
-        ptr = ptr_str->ptr_array + ptr_str->length;
-        while ( (*ptr++ = *src_cstr++) );
-        ptr_str->length = new_net_length;
-    }
+    abel_string_append_n(ptr_str, src_cstr, strlen(src_cstr));
 }
 
 void abel_string_append_char(struct abel_string* ptr_str, char src_char)
@@ -141,6 +176,28 @@ void abel_string_append_char(struct abel_string* ptr_str, char src_char)
     abel_string_append(ptr_str, converted);
 }
 
+void abel_string_append_n(struct abel_string* ptr_str, const char* src,
+                          size_t src_length)
+{
+    if (src_length > 0) {
+        size_t new_net_length = ptr_str->length + src_length;
+        char* ptr_array = reserve_chars(ptr_str, new_net_length);
+        if (ptr_array != NULL) {
+            memcpy(ptr_array + ptr_str->length, src, src_length);
+            ptr_array[new_net_length] = '\0';
+            ptr_str->length = new_net_length;
+        }
+    }
+}
+
+void abel_string_truncate(struct abel_string* ptr_str, size_t length)
+{
+    if (length < ptr_str->length) {
+        abel_string_cstr(ptr_str)[length] = '\0';
+        ptr_str->length = length;
+    }
+}
+
 /* Compare */
 
 Bool abel_string_eq(const struct abel_string* ptr_str1,
@@ -148,7 +205,7 @@ Bool abel_string_eq(const struct abel_string* ptr_str1,
 {
     Bool ret = false;
     if (ptr_str1->length == ptr_str2->length) {
-        if (strcmp(ptr_str1->ptr_array, ptr_str2->ptr_array) == 0) {
+        if (strcmp(abel_string_cstr(ptr_str1), abel_string_cstr(ptr_str2)) == 0) {
             ret = true;
         }
     }
@@ -160,7 +217,7 @@ Bool abel_string_eq_cstring(const struct abel_string* ptr_str,
 {
     Bool ret = false;
     if (ptr_str->length == strlen(src_cstr)) {
-        if (strcmp(ptr_str->ptr_array, src_cstr) == 0) {
+        if (strcmp(abel_string_cstr(ptr_str), src_cstr) == 0) {
             ret = true;
         }
     }
@@ -197,7 +254,7 @@ Bool abel_cstring_eq_char(const char* src_str, const char src_char)
 char abel_string_at(struct abel_string* ptr_str, size_t idx)
 {
     if (idx < ptr_str->length) {
-        return ptr_str->ptr_array[idx];
+        return abel_string_cstr(ptr_str)[idx];
     } else {
         return '\0';
     }
@@ -228,7 +285,7 @@ Bool abel_string_has(struct abel_string* ptr_str, char src_char)
 {
     Bool flag = false;
     for (int i = 0; i < ptr_str->length; i++) {
-        if (ptr_str->ptr_array[i] == src_char) {
+        if (abel_string_cstr(ptr_str)[i] == src_char) {
             flag = true;
         }
     }
@@ -5,49 +5,237 @@
  **/
 #include "dict.h"
 
+/**
+ * @brief Static - Turn a dict in shape form into a map
+ *
+ * Called once the dict diverges from the shape form. An
+ * empty dict gets an empty map.
+ */
+static struct abel_return_option dict_make_map(struct abel_dict* ptr_dict)
+{
+    struct abel_return_option ret = abel_option_okay(NULL);
+    struct abel_key_shape* ptr_shape = ptr_dict->ptr_shape;
+    struct abel_map* ptr_map = abel_make_map_ptr();
+    if (ptr_map == NULL) {
+        return abel_option_error( error_malloc_failure() );
+    }
+    for (size_t i = 0; ptr_shape != NULL && i < ptr_shape->size; i++) {
+        ret = abel_map_insert_interned(ptr_map, ptr_shape->ptr_keys[i],
+                                       ptr_dict->ptr_values[i]);
+        if (ret.is_error == true) {
+            abel_free_map_ptr(ptr_map);
+            return ret;
+        }
+    }
+    if (ptr_shape != NULL) {
+        abel_release_key_shape(ptr_shape);
+        free(ptr_dict->ptr_values);
+        ptr_dict->ptr_shape = NULL;
+        ptr_dict->ptr_values = NULL;
+    }
+    ptr_dict->ptr_map = ptr_map;
+    return abel_option_okay(NULL);
+}
+
+/**
+ * @brief Static - Room of the values of a dict in shape form
+ *
+ * Array of values has room for 4 values at first and is
+ * doubled whenever it is full, so its room follows from the
+ * number of values.
+ */
+static size_t shape_values_capacity(size_t size)
+{
+    size_t capacity = 4;
+    if (size == 0) {
+        return 0;
+    }
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/**
+ * @brief Static - Append a value to a dict in shape form
+ */
+static struct abel_return_option dict_shape_append(struct abel_dict* ptr_dict,
+    const char* interned_key, struct abel_object* ptr_obj)
+{
+    struct abel_key_shape* ptr_new_shape = NULL;
+    struct abel_object** ptr_values = ptr_dict->ptr_values;
+    size_t size = (ptr_dict->ptr_shape == NULL) ? 0 : ptr_dict->ptr_shape->size;
+    if (size == shape_values_capacity(size)) {
+        ptr_values = realloc(ptr_values,
+                             shape_values_capacity(size + 1) * sizeof(*ptr_values));
+        if (ptr_values == NULL) {
+            return abel_option_error( error_malloc_failure() );
+        }
+        ptr_dict->ptr_values = ptr_values;
+    }
+    ptr_new_shape = abel_key_shape_add_key(ptr_dict->ptr_shape, interned_key);
+    if (ptr_new_shape == NULL) {
+        return abel_option_error( error_malloc_failure() );
+    }
+    if (ptr_dict->ptr_shape != NULL) {
+        abel_release_key_shape(ptr_dict->ptr_shape);
+    }
+    ptr_dict->ptr_shape = ptr_new_shape;
+    ptr_values[size] = ptr_obj;
+    return abel_option_okay(NULL);
+}
+
 /* Public */
 
 struct abel_dict* abel_make_dict_ptr()
 {
     struct abel_dict* ptr_dict = NULL;
     ptr_dict = malloc( sizeof(*ptr_dict) );
-    ptr_dict->ptr_map = abel_make_map_ptr();
+    ptr_dict->ptr_map = NULL;
     ptr_dict->data_type = OBJECT_TYPE;
+    ptr_dict->ptr_shape = NULL;
+    ptr_dict->ptr_values = NULL;
+    ptr_dict->is_read_only = false;
     return ptr_dict;
 }
 
-Bool abel_dict_has_key(struct abel_dict* ptr_dict, char* key_str)
+struct abel_dict* abel_make_dict_ptr_with_capacity(size_t capacity)
 {
-    struct abel_return_option ret_from_map
-            = abel_map_find(ptr_dict->ptr_map, key_str);
-    if (ret_from_map.is_okay == true) {
-        return true;
-    } else {
-        return false;
+    struct abel_dict* ptr_dict = abel_make_dict_ptr();
+    if (ptr_dict == NULL || capacity <= DICT_SHAPE_MAX_SIZE) {
+        return ptr_dict;
+    }
+    if (dict_make_map(ptr_dict).is_error == true
+            || abel_map_reserve(ptr_dict->ptr_map, capacity).is_error == true) {
+        abel_free_dict_ptr(ptr_dict);
+        return NULL;
     }
+    return ptr_dict;
+}
+
+Bool abel_dict_has_key(struct abel_dict* ptr_dict, char* key_str)
+{
+    return (abel_dict_get_object_ptr(ptr_dict, key_str) != NULL);
+}
+
+Bool abel_dict_has_key_n(struct abel_dict* ptr_dict, const char* key_str,
+        size_t key_length)
+{
+    return (abel_dict_get_object_ptr_n(ptr_dict, key_str, key_length) != NULL);
 }
 
 size_t abel_dict_size(struct abel_dict* ptr_dict)
 {
-    return abel_map_size(ptr_dict->ptr_map);
+    if (ptr_dict->ptr_shape != NULL) {
+        return ptr_dict->ptr_shape->size;
+    } else if (ptr_dict->ptr_map != NULL) {
+        return abel_map_size(ptr_dict->ptr_map);
+    }
+    return 0;
 }
 
 struct abel_return_option abel_dict_insert(
         struct abel_dict* ptr_dict, char* key_str, struct abel_object* ptr_obj)
+{
+    return abel_dict_insert_n(ptr_dict, key_str, strlen(key_str), ptr_obj);
+}
+
+struct abel_return_option abel_dict_insert_n(struct abel_dict* ptr_dict,
+        const char* key_str, size_t key_length, struct abel_object* ptr_obj)
 {
     struct abel_return_option ret_map_insert;
-    ret_map_insert = abel_map_insert(ptr_dict->ptr_map, key_str, ptr_obj);
+    if (ptr_dict->is_read_only == true) {
+        return abel_option_error( error_read_only() );
+    }
+    if (ptr_dict->ptr_map == NULL) {
+        ret_map_insert = dict_make_map(ptr_dict);
+        if (ret_map_insert.is_error == true) {
+            return ret_map_insert;
+        }
+    }
+    ret_map_insert = abel_map_insert_n(ptr_dict->ptr_map, key_str, key_length,
+                                       ptr_obj);
+    if (ret_map_insert.is_okay) {    // if succeeds, update ref count
+        abel_object_add_ref(ptr_obj);
+    }
+    return ret_map_insert;
+}
+
+struct abel_return_option abel_dict_insert_interned(
+        struct abel_dict* ptr_dict, char* key_str, struct abel_object* ptr_obj)
+{
+    return abel_dict_insert_interned_n(ptr_dict, key_str, strlen(key_str),
+                                       ptr_obj);
+}
+
+struct abel_return_option abel_dict_insert_interned_n(struct abel_dict* ptr_dict,
+        const char* key_str, size_t key_length, struct abel_object* ptr_obj)
+{
+    struct abel_return_option ret_map_insert = abel_option_okay(NULL);
+    size_t index = 0;
+    const char* interned_key = NULL;
+    if (ptr_dict->is_read_only == true) {
+        return abel_option_error( error_read_only() );
+    }
+    interned_key = abel_intern_key_n(key_str, key_length);
+    if (interned_key == NULL) {
+        return abel_option_error( error_malloc_failure() );
+    }
+    if (ptr_dict->ptr_shape != NULL
+            && abel_key_shape_find_n(ptr_dict->ptr_shape, interned_key,
+                                     key_length, &index)) {
+        ret_map_insert = abel_option_error( error_key_exists() );
+    } else if (ptr_dict->ptr_map == NULL
+            && abel_dict_size(ptr_dict) == DICT_SHAPE_MAX_SIZE) {
+        ret_map_insert = dict_make_map(ptr_dict);
+    }
+    if (ret_map_insert.is_okay == true) {
+        if (ptr_dict->ptr_map == NULL) {
+            ret_map_insert = dict_shape_append(ptr_dict, interned_key, ptr_obj);
+        } else {
+            ret_map_insert = abel_map_insert_interned(ptr_dict->ptr_map,
+                                                      interned_key, ptr_obj);
+        }
+    }
+    /* pair or shape holds its own reference to the key */
+    abel_release_interned_key(interned_key);
     if (ret_map_insert.is_okay) {    // if succeeds, update ref count
-        ptr_obj->ref_count += 1;
+        abel_object_add_ref(ptr_obj);
     }
     return ret_map_insert;
 }
 
+struct abel_return_option abel_dict_insert_many(struct abel_dict* ptr_dict,
+        char** ptr_keys, struct abel_object** ptr_objs, size_t count)
+{
+    struct abel_return_option ret = abel_option_okay(NULL);
+    if (ptr_dict->is_read_only == true) {
+        return abel_option_error( error_read_only() );
+    }
+    if (ptr_dict->ptr_map == NULL) {
+        ret = dict_make_map(ptr_dict);
+    }
+    if (ret.is_okay == true) {
+        ret = abel_map_reserve(ptr_dict->ptr_map,
+                               abel_map_size(ptr_dict->ptr_map) + count);
+    }
+    for (size_t i = 0; ret.is_okay == true && i < count; i++) {
+        ret = abel_map_insert(ptr_dict->ptr_map, ptr_keys[i], ptr_objs[i]);
+        if (ret.is_okay == true) {
+            abel_object_add_ref(ptr_objs[i]);
+        }
+    }
+    if (ret.is_okay == true) {
+        ret = abel_option_okay(NULL);
+    }
+    return ret;
+}
+
 struct abel_return_option abel_dict_insert_bool_ptr(
         struct abel_dict* ptr_dict, char* key_str, Bool* ptr_src_data)
 {
     return abel_dict_insert( ptr_dict, key_str,
-                             abel_make_object_ptr_from_bool_ptr(ptr_src_data) );
+                             abel_bool_object_ptr(*ptr_src_data) );
 }
 
 struct abel_return_option abel_dict_insert_bool(
@@ -59,8 +247,7 @@ struct abel_return_option abel_dict_insert_bool(
 struct abel_return_option abel_dict_insert_null_ptr(
         struct abel_dict* ptr_dict, char* key_str, Null* ptr_src_data)
 {
-    return abel_dict_insert( ptr_dict, key_str,
-                             abel_make_object_ptr_from_null_ptr(ptr_src_data) );
+    return abel_dict_insert( ptr_dict, key_str, abel_null_object_ptr() );
 }
 
 struct abel_return_option abel_dict_insert_null(
@@ -102,6 +289,16 @@ struct abel_return_option abel_dict_delete(
 {
     struct abel_return_option ret;
     struct abel_key_value_pair* ptr_pair_to_erase = NULL;
+    if (ptr_dict->is_read_only == true) {
+        return abel_option_error( error_read_only() );
+    }
+    if (ptr_dict->ptr_map == NULL) {
+        /* a dict in shape form only grows, delete from a map */
+        ret = dict_make_map(ptr_dict);
+        if (ret.is_error == true) {
+            return ret;
+        }
+    }
     ret = abel_map_erase(ptr_dict->ptr_map, key_str);
     if (ret.is_okay == true) {
         ptr_pair_to_erase = ret.pointer;
@@ -113,13 +310,92 @@ struct abel_return_option abel_dict_delete(
     return ret;
 }
 
+/* Statistics */
+
+struct abel_map_stats abel_dict_stats(struct abel_dict* ptr_dict)
+{
+    struct abel_map_stats stats = { 0 };
+    size_t probe_length = 0;
+    if (ptr_dict->ptr_map != NULL) {
+        stats = abel_map_stats(ptr_dict->ptr_map);
+    } else if (ptr_dict->ptr_shape != NULL) {
+        /* Keys are scanned in slot order */
+        stats.size = ptr_dict->ptr_shape->size;
+        stats.capacity = shape_values_capacity(stats.size);
+        stats.load_factor = (double)stats.size / (double)stats.capacity;
+        stats.max_probe_length = stats.size;
+        stats.mean_probe_length = (double)(stats.size + 1) / 2.0;
+        for (size_t i = 0; i < stats.size; i++) {
+            probe_length = (i < MAP_STATS_HISTOGRAM_SIZE)
+                           ? i + 1 : MAP_STATS_HISTOGRAM_SIZE;
+            stats.probe_histogram[probe_length - 1]++;
+        }
+        stats.bytes = stats.capacity * sizeof(*ptr_dict->ptr_values);
+    }
+    stats.bytes += sizeof(*ptr_dict);
+    return stats;
+}
+
+/* Iterator */
+
+struct abel_dict_iterator abel_dict_iter_begin(struct abel_dict* ptr_dict)
+{
+    struct abel_dict_iterator iter;
+    iter.ptr_dict = ptr_dict;
+    iter.map_iter = abel_map_iter_begin(ptr_dict->ptr_map);
+    iter.index = 0;
+    iter.key = NULL;
+    iter.ptr_object = NULL;
+    return iter;
+}
+
+Bool abel_dict_iter_next(struct abel_dict_iterator* ptr_iter)
+{
+    struct abel_dict* ptr_dict = ptr_iter->ptr_dict;
+    struct abel_key_value_pair* ptr_pair = NULL;
+    if (ptr_dict->ptr_shape != NULL) {
+        if (ptr_iter->index == ptr_dict->ptr_shape->size) {
+            return false;
+        }
+        ptr_iter->key = ptr_dict->ptr_shape->ptr_keys[ptr_iter->index];
+        ptr_iter->ptr_object = ptr_dict->ptr_values[ptr_iter->index];
+        ptr_iter->index++;
+        return true;
+    } else if (ptr_dict->ptr_map == NULL) {
+        return false;
+    }
+    ptr_pair = abel_map_iter_next(&ptr_iter->map_iter);
+    if (ptr_pair == NULL) {
+        return false;
+    }
+    ptr_iter->key = ptr_pair->key;
+    ptr_iter->ptr_object = ptr_pair->ptr_data;
+    return true;
+}
+
 /* Getters */
 
 struct abel_object* abel_dict_get_object_ptr(
         struct abel_dict* ptr_dict, char* key_str)
 {
-    struct abel_return_option ret_map_at
-            = abel_map_at(ptr_dict->ptr_map, key_str);
+    return abel_dict_get_object_ptr_n(ptr_dict, key_str, strlen(key_str));
+}
+
+struct abel_object* abel_dict_get_object_ptr_n(struct abel_dict* ptr_dict,
+        const char* key_str, size_t key_length)
+{
+    struct abel_return_option ret_map_at;
+    size_t index = 0;
+    if (ptr_dict->ptr_shape != NULL) {
+        if (abel_key_shape_find_n(ptr_dict->ptr_shape, key_str, key_length,
+                                  &index)) {
+            return ptr_dict->ptr_values[index];
+        }
+        return NULL;
+    } else if (ptr_dict->ptr_map == NULL) {
+        return NULL;
+    }
+    ret_map_at = abel_map_at_n(ptr_dict->ptr_map, key_str, key_length);
     if (ret_map_at.is_okay) {
         return (struct abel_object*) ret_map_at.pointer;
     } else {
@@ -127,21 +403,146 @@ struct abel_object* abel_dict_get_object_ptr(
     }
 }
 
+struct abel_dict_lookup_cache abel_make_dict_lookup_cache()
+{
+    struct abel_dict_lookup_cache cache = { 0, 0 };
+    return cache;
+}
+
+struct abel_object* abel_dict_get_object_ptr_cached(struct abel_dict* ptr_dict,
+        char* key_str, struct abel_dict_lookup_cache* ptr_cache)
+{
+    struct abel_key_shape* ptr_shape = ptr_dict->ptr_shape;
+    size_t index = 0;
+    if (ptr_shape == NULL) {
+        return abel_dict_get_object_ptr(ptr_dict, key_str);
+    }
+    if (ptr_shape->id == ptr_cache->shape_id) {
+        return ptr_dict->ptr_values[ptr_cache->index];
+    }
+    if (abel_key_shape_find(ptr_shape, key_str, &index)) {
+        ptr_cache->shape_id = ptr_shape->id;
+        ptr_cache->index = index;
+        return ptr_dict->ptr_values[index];
+    }
+    return NULL;
+}
+
 enum data_type abel_dict_get_data_type(struct abel_dict* ptr_dict, char* key_str)
 {
     return abel_dict_get_object_ptr(ptr_dict, key_str)->data_type;
 }
 
+/* Key handle */
+
+struct abel_key abel_make_key(const char* key_str)
+{
+    struct abel_key key;
+    key.key_length = strlen(key_str);
+    key.key = abel_intern_key_n(key_str, key.key_length);
+    key.slot = 0;
+    return key;
+}
+
+void abel_free_key(struct abel_key* ptr_key)
+{
+    if (ptr_key->key != NULL) {
+        abel_release_interned_key(ptr_key->key);
+        ptr_key->key = NULL;
+    }
+}
+
+struct abel_object* abel_dict_get_object_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key)
+{
+    struct abel_key_shape* ptr_shape = ptr_dict->ptr_shape;
+    struct abel_return_option ret;
+    if (ptr_key->key == NULL) {
+        return NULL;
+    }
+    if (ptr_shape != NULL) {
+        /* shapes that share a prefix share the slots of its keys */
+        if (ptr_key->slot >= ptr_shape->size
+                || ptr_shape->ptr_keys[ptr_key->slot] != ptr_key->key) {
+            if (!abel_key_shape_find_n(ptr_shape, ptr_key->key,
+                                       ptr_key->key_length, &ptr_key->slot)) {
+                return NULL;
+            }
+        }
+        return ptr_dict->ptr_values[ptr_key->slot];
+    } else if (ptr_dict->ptr_map == NULL) {
+        return NULL;
+    }
+    ret = abel_map_find_interned(ptr_dict->ptr_map, ptr_key->key,
+                                 &ptr_key->slot);
+    if (ret.is_okay) {
+        return ((struct abel_key_value_pair*)ret.pointer)->ptr_data;
+    } else {
+        return NULL;
+    }
+}
+
+/**
+ * @brief Static - Data of object if of given type
+ *
+ * @return Pointer to the data, or NULL if object is NULL,
+ *         holds no data or is of another type.
+ */
+static void* object_data_of_type(struct abel_object* ptr_object,
+        enum data_type data_type)
+{
+    if (ptr_object != NULL && ptr_object->ptr_data != NULL
+            && ptr_object->data_type == data_type) {
+        return ptr_object->ptr_data;
+    }
+    return NULL;
+}
+
+const Bool* abel_dict_get_bool_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key)
+{
+    return object_data_of_type(
+        abel_dict_get_object_ptr_by_key(ptr_dict, ptr_key), BOOL_TYPE);
+}
+
+int* abel_dict_get_int_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key)
+{
+    return object_data_of_type(
+        abel_dict_get_object_ptr_by_key(ptr_dict, ptr_key), INTEGER_TYPE);
+}
+
+double* abel_dict_get_double_ptr_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key)
+{
+    return object_data_of_type(
+        abel_dict_get_object_ptr_by_key(ptr_dict, ptr_key), DOUBLE_TYPE);
+}
+
+double abel_dict_get_double_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key)
+{
+    double ret = *abel_dict_get_double_ptr_by_key(ptr_dict, ptr_key);
+    return ret;
+}
+
+char* abel_dict_get_string_by_key(struct abel_dict* ptr_dict,
+        struct abel_key* ptr_key)
+{
+    return object_data_of_type(
+        abel_dict_get_object_ptr_by_key(ptr_dict, ptr_key), STRING_TYPE);
+}
+
 /* Terminal data getter */
 
-Bool* abel_dict_get_bool_ptr(struct abel_dict* ptr_dict, char* key_str)
+const Bool* abel_dict_get_bool_ptr(struct abel_dict* ptr_dict, char* key_str)
 {
     struct abel_object* ptr_object_temp
             = abel_dict_get_object_ptr(ptr_dict, key_str);
-    Bool* ptr_ret = NULL;
+    const Bool* ptr_ret = NULL;
     if (ptr_object_temp!= NULL && ptr_object_temp->ptr_data != NULL
             && ptr_object_temp->data_type == BOOL_TYPE) {
-        ptr_ret = (Bool*)ptr_object_temp->ptr_data;
+        ptr_ret = (const Bool*)ptr_object_temp->ptr_data;
     }
     return ptr_ret;
 }
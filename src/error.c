@@ -12,7 +12,8 @@ char* ERROR_TYPE_STRING[] = {
     "VALIDATION_ERROR",
     "INCOMPATIBLE_TYPE",
     "OUT_OF_RANGE",
-    "PARSER_ERROR"
+    "PARSER_ERROR",
+    "READ_ONLY"
 };
 
 /** @brief Experiment - Global error stack */
@@ -127,4 +128,10 @@ struct abel_error error_parser_error(char* msg_str, int line_number)
 {
     struct abel_error error = error_new(msg_str, PARSER_ERROR, line_number);
     return error;
-}
\ No newline at end of file
+}
+
+struct abel_error error_read_only()
+{
+    struct abel_error error = error_new("Container is read-only.", READ_ONLY, -999);
+    return error;
+}
@@ -1,73 +1,150 @@
-/*
-    Experiemnt
-
-    Hashing function. Here it converts a string into a unsigned integer,
-    the modulus of which over an integer N can be used as an index in
-    an array of N elements.
-
-    TODO Make this a collection of hashing functions.
-*/
+/**
+ * SOURCE hashing_func.c
+ *
+ * Hashing functions. Each converts a string into an unsigned
+ * integer, the modulus of which over an integer N can be used
+ * as an index in an array of N elements.
+ **/
 #include <stdio.h>
-#include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
+#ifdef ABEL_ATOMIC_REF_COUNT
+#include <threads.h>
+#endif
+#include <time.h>
+#include "hashing_func.h"
+
+/**
+ * wyhash
+ *
+ * Mixing constants and helpers of wyhash final 4, released
+ * into the public domain by Wang Yi.
+ */
+static const uint64_t WY_SECRET[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
 
-/*
-    djb2 by Dan Bernstein.
-    Performance is bad!!    
-*/
-unsigned long hash_Dan_Bernstein(unsigned char* str)
+/**
+ * @brief Static - 128-bit product of A and B.
+ *
+ * Low half is stored in A and high half in B.
+ */
+static inline void wy_mum(uint64_t* ptr_a, uint64_t* ptr_b)
 {
-    unsigned long hash = 5381;
-    int c;
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = *ptr_a;
+    r *= *ptr_b;
+    *ptr_a = (uint64_t)r;
+    *ptr_b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *ptr_a >> 32, hb = *ptr_b >> 32;
+    uint64_t la = (uint32_t)*ptr_a, lb = (uint32_t)*ptr_b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    *ptr_a = lo;
+    *ptr_b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
 
-    while (c = *str++)
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+static inline uint64_t wy_mix(uint64_t a, uint64_t b)
+{
+    wy_mum(&a, &b);
+    return a ^ b;
+}
 
-    return hash;
+static inline uint64_t wy_read8(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
 }
 
-static unsigned long sdbm(unsigned char* str)
+static inline uint64_t wy_read4(const uint8_t* p)
 {
-    unsigned long hash = 0;
-    int c;
-    while (c = *str++)
-        hash = c + (hash << 6) + (hash << 16) - hash;
-    return hash;
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
 }
 
-/* FNV, MurmurOAAT, Jenkins, and CRC have much better performance and less collision. */
-uint32_t FNV(const void* key, int len, uint32_t h)
+static inline uint64_t wy_read3(const uint8_t* p, size_t k)
 {
-    // Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
-    h ^= 2166136261UL;
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+uint64_t abel_hash_wy(const char* key, size_t length, uint64_t seed)
+{
+    const uint8_t* p = (const uint8_t*)key;
+    uint64_t a = 0;
+    uint64_t b = 0;
+    seed ^= wy_mix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+    if (length <= 16) {
+        if (length >= 4) {
+            a = (wy_read4(p) << 32) | wy_read4(p + ((length >> 3) << 2));
+            b = (wy_read4(p + length - 4) << 32)
+                | wy_read4(p + length - 4 - ((length >> 3) << 2));
+        } else if (length > 0) {
+            a = wy_read3(p, length);
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = wy_mix(wy_read8(p) ^ WY_SECRET[1], wy_read8(p + 8) ^ seed);
+                see1 = wy_mix(wy_read8(p + 16) ^ WY_SECRET[2],
+                              wy_read8(p + 24) ^ see1);
+                see2 = wy_mix(wy_read8(p + 32) ^ WY_SECRET[3],
+                              wy_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wy_mix(wy_read8(p) ^ WY_SECRET[1], wy_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wy_read8(p + i - 16);
+        b = wy_read8(p + i - 8);
+    }
+    a ^= WY_SECRET[1];
+    b ^= seed;
+    wy_mum(&a, &b);
+    return wy_mix(a ^ WY_SECRET[0] ^ length, b ^ WY_SECRET[1]);
+}
+
+/* FNV, MurmurOAAT, and Jenkins have much better performance and less collision. */
+uint64_t abel_hash_fnv1a(const char* key, size_t length, uint64_t seed)
+{
+    uint32_t h = (uint32_t)seed ^ 2166136261UL;
     const uint8_t* data = (const uint8_t*)key;
-    for(int i = 0; i < len; i++)
-    {
+    for (size_t i = 0; i < length; i++) {
         h ^= data[i];
         h *= 16777619;
     }
     return h;
 }
 
-uint32_t MurmurOAAT_32(const char* str, uint32_t h)
+uint64_t abel_hash_murmur_oaat(const char* key, size_t length, uint64_t seed)
 {
-    // One-byte-at-a-time hash based on Murmur's mix
-    // Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
-    for (; *str; ++str) {
-        h ^= *str;
+    uint32_t h = (uint32_t)seed;
+    for (size_t i = 0; i < length; i++) {
+        h ^= key[i];
         h *= 0x5bd1e995;
         h ^= h >> 15;
     }
     return h;
 }
 
-uint32_t Jenkins_one_at_a_time_hash(const char *str, size_t len)
+uint64_t abel_hash_jenkins_oaat(const char* key, size_t length, uint64_t seed)
 {
-    uint32_t hash, i;
-    for(hash = i = 0; i < len; ++i)
-    {
-        hash += str[i];
+    uint32_t hash = (uint32_t)seed;
+    for (size_t i = 0; i < length; i++) {
+        hash += (uint8_t)key[i];
         hash += (hash << 10);
         hash ^= (hash >> 6);
     }
@@ -77,53 +154,79 @@ uint32_t Jenkins_one_at_a_time_hash(const char *str, size_t len)
     return hash;
 }
 
-/* Least collision but time consuming. */
-uint32_t crc32b(const uint8_t *str) {
-    // Source: https://stackoverflow.com/a/21001712
-    unsigned int byte, crc, mask;
-    int i = 0, j;
-    crc = 0xFFFFFFFF;
-    while (str[i] != 0) {
-        byte = str[i];
-        crc = crc ^ byte;
-        for (j = 7; j >= 0; j--) {
-            mask = -(crc & 1);
-            crc = (crc >> 1) ^ (0xEDB88320 & mask);
-        }
-        i = i + 1;
+/* djb2 by Dan Bernstein. Performance is bad!! */
+uint64_t abel_hash_djb2(const char* key, size_t length, uint64_t seed)
+{
+    uint64_t hash = 5381 ^ seed;
+    for (size_t i = 0; i < length; i++) {
+        hash = ((hash << 5) + hash) + (uint8_t)key[i]; /* hash * 33 + c */
     }
-    return ~crc;
+    return hash;
 }
 
-int main()
+uint64_t abel_hash_sdbm(const char* key, size_t length, uint64_t seed)
 {
-    size_t CAPACITY = 2048;
-    unsigned char* test_list[] = {
-        "a83nh", "MN^3m9", "123286", "12865", "Lok_+23&",
-        "@uUy&^om___=-", "0992019019", "++==-0#@", "02nGt12865", "____Lok_+23&",
-        "abc", "abC", "aBc", "Abc", "aBC", "AbC", "ABc", "ABC"
-    };
-    int len;
-    len =  sizeof(test_list) / sizeof(test_list[0]);
-
-    printf(" *** Dan Bernstein algorithm*** \n");
-    for (int i = 0; i < len; i++) {
-        unsigned long result;
-        result = hash_Dan_Bernstein(test_list[i]);
-        printf(" For string %s, the hashed number is %ld, modulus is %d\n", test_list[i], result, result % CAPACITY);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < length; i++) {
+        hash = (uint8_t)key[i] + (hash << 6) + (hash << 16) - hash;
     }
+    return hash;
+}
+
+/**
+ * @brief Static - splitmix64 finaliser.
+ *
+ * Spreads the few bits of entropy of the fallback seed over
+ * all 64 bits.
+ */
+static uint64_t split_mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
 
-    printf(" *** sdbm algorithm*** \n");
-    for (int i = 0; i < len; i++) {
-        unsigned long result;
-        result = sdbm(test_list[i]);
-        printf(" For string %s, the hashed number is %ld, modulue is %d\n", test_list[i], result, result % CAPACITY);
+/* Per-process seed, drawn once by `draw_process_seed` */
+static uint64_t process_seed = 0;
+#ifdef ABEL_ATOMIC_REF_COUNT
+static once_flag process_seed_once = ONCE_FLAG_INIT;
+#else
+static int is_process_seeded = 0;
+#endif
+
+/**
+ * @brief Static - Draw the per-process seed.
+ *
+ * If the library is built with ABEL_ATOMIC_REF_COUNT defined,
+ * it is called through `call_once`, so threads that ask for
+ * the seed at the same time all see the same value. Otherwise
+ * C11 threads are not required and a plain flag is used.
+ */
+static void draw_process_seed(void)
+{
+    FILE* file = fopen("/dev/urandom", "rb");
+    size_t count = 0;
+    if (file != NULL) {
+        count = fread(&process_seed, sizeof(process_seed), 1, file);
+        fclose(file);
     }
+    if (count != 1) {
+        /* address of a local differs per run under ASLR */
+        process_seed = split_mix((uint64_t)time(NULL) ^ ((uint64_t)clock() << 32)
+                                 ^ (uint64_t)(uintptr_t)&count);
+    }
+}
 
-    printf(" *** Murmur algorithm*** \n");
-    for (int i = 0; i < len; i++) {
-        unsigned long result;
-        result = MurmurOAAT_32(test_list[i], 1);    /* What does the last integer do? */
-        printf(" For string %s, the hashed number is %ld, modulus is %d\n", test_list[i], result, result % CAPACITY);
+uint64_t abel_hash_process_seed()
+{
+#ifdef ABEL_ATOMIC_REF_COUNT
+    call_once(&process_seed_once, draw_process_seed);
+#else
+    if (is_process_seeded == 0) {
+        draw_process_seed();
+        is_process_seeded = 1;
     }
-}
\ No newline at end of file
+#endif
+    return process_seed;
+}
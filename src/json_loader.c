@@ -1,65 +1,46 @@
 /* Source json_loader */
 #include "json_loader.h"
 
-/* Return  */
-static char* get_closing_symbol_by_opening(const char* opening_sym)
-{
-    char* closing_symbol;
-    if (strcmp(opening_sym, L_BRACE) == 0) {
-        closing_symbol = (char*)R_BRACE;
-    } else if (strcmp(opening_sym, L_BRACKET) == 0) {
-        closing_symbol = (char*)R_BRACKET;
-    } else if (strcmp(opening_sym, L_PARENTHESIS) == 0) {
-        closing_symbol = (char*)R_PARENTHESIS;
-    } else if (strcmp(opening_sym, L_CHEVRON) == 0) {
-        closing_symbol = (char*)R_CHEVRON;
-    } else {
-        // error
-    }
-    return closing_symbol;
-}
-
-static Bool is_matched_closing(struct json_token* ptr_closing_token,
-                               struct json_token* ptr_opening_token)
-{
-    Bool matching_symbol = (strcmp(
-            ptr_closing_token->literal->ptr_array,
-            get_closing_symbol_by_opening(ptr_opening_token->literal->ptr_array)) == 0);
-    Bool matching_level = (ptr_closing_token->level == ptr_opening_token->level);
-    Bool matching_pk = (strcmp(
-            ptr_closing_token->parent_key->ptr_array,
-            ptr_opening_token->parent_key->ptr_array) == 0);
-    return (matching_symbol && matching_level && matching_pk);
-}
-
 struct json_loader able_make_json_loader()
 {
     struct json_loader loader;
     loader.current_index = 0;
+    loader.ptr_parser = NULL;
     return loader;
 }
 
 /**
- * @brief Get a token pointer from token vector
+ * @brief Get a token from token vector
+ * 
+ * Token is gathered from the tape and returned by value.
  */
-static struct json_token* get_token_ptr(
-        struct abel_vector* ptr_token_vector, size_t idx)
+static struct json_token get_token(
+        const struct json_token_tape* ptr_token_vector, size_t idx)
 {
-    return (struct json_token*)abel_vector_at(ptr_token_vector, idx).pointer;
+    return abel_token_tape_at(ptr_token_vector, idx);
 }
 
 /**
- * @brief Get token pointer at current index
+ * @brief Get the type of a token
+ */
+static enum json_token_type get_token_type(
+        const struct json_token_tape* ptr_token_vector, size_t idx)
+{
+    return ptr_token_vector->ptr_types[idx];
+}
+
+/**
+ * @brief Get token at current index
  * 
  * Current index is set by JSON loader
  * 
  * @todo not unit tested, not used
  */
-static struct json_token* get_current_token_ptr(
-        struct json_loader* ptr_loader, struct abel_vector* ptr_token_vector)
+static struct json_token get_current_token(
+        struct json_loader* ptr_loader,
+        const struct json_token_tape* ptr_token_vector)
 {
-    return (struct json_token*)abel_vector_at(ptr_token_vector,
-            ptr_loader->current_index).pointer;
+    return get_token(ptr_token_vector, ptr_loader->current_index);
 }
 
 /**
@@ -67,22 +48,30 @@ static struct json_token* get_current_token_ptr(
  * 
  * Returns the literal of the token a the given index
  */
-static char* get_literal(struct abel_vector* ptr_token_vector, size_t idx)
+static char* get_literal(struct json_loader* ptr_loader,
+                         const struct json_token_tape* ptr_token_vector,
+                         size_t idx)
 {
-    return get_token_ptr(ptr_token_vector, idx)->literal->ptr_array;
+    return (char*)json_slice_cstr(&ptr_loader->ptr_parser->literal_pool,
+                                  ptr_token_vector->ptr_literals[idx]);
 }
 
+/**
+ * @brief Make a dict from its opening token
+ * 
+ * Closing token is read off the tape, so the walk stops
+ * there without comparing tokens.
+ */
 struct abel_dict* make_dict(struct json_loader* ptr_loader,
-        int index_opening_token, struct abel_vector* ptr_token_vector)
+        int index_opening_token, const struct json_token_tape* ptr_token_vector)
 {
     struct abel_dict* dict_sptr = abel_make_dict_ptr();
+    int index_closing_token = (int)abel_token_tape_closing_index(
+            ptr_token_vector, index_opening_token);
     // Prepare current index for iteration. Iteration start from next index.
     ptr_loader->current_index = index_opening_token + 1;
-    while ( ptr_loader->current_index < (int) ptr_token_vector->size
-            && !is_matched_closing(
-                get_token_ptr(ptr_token_vector, ptr_loader->current_index),
-                get_token_ptr(ptr_token_vector, index_opening_token)) ) {
-        if (get_token_ptr(ptr_token_vector, ptr_loader->current_index)->type == KEY) {
+    while (ptr_loader->current_index < index_closing_token) {
+        if (get_token_type(ptr_token_vector, ptr_loader->current_index) == KEY) {
             at_key(ptr_loader, dict_sptr, ptr_token_vector);
             continue;
         }
@@ -94,15 +83,14 @@ struct abel_dict* make_dict(struct json_loader* ptr_loader,
 }
 
 struct abel_list* make_list(struct json_loader* ptr_loader,
-        int index_opening_token, struct abel_vector* ptr_token_vector)
+        int index_opening_token, const struct json_token_tape* ptr_token_vector)
 {
     struct abel_list* list_sptr = abel_make_list_ptr(0);
+    int index_closing_token = (int)abel_token_tape_closing_index(
+            ptr_token_vector, index_opening_token);
     ptr_loader->current_index = index_opening_token + 1;
-    while ( ptr_loader->current_index < (int)ptr_token_vector->size
-            && !is_matched_closing(
-                get_token_ptr(ptr_token_vector, ptr_loader->current_index),
-                get_token_ptr(ptr_token_vector, index_opening_token)) ) {
-        if (get_token_ptr(ptr_token_vector, ptr_loader->current_index)->type == ITER_KEY) {
+    while (ptr_loader->current_index < index_closing_token) {
+        if (get_token_type(ptr_token_vector, ptr_loader->current_index) == ITER_KEY) {
             at_iter_key(ptr_loader, list_sptr, ptr_token_vector);
             continue;
         }
@@ -116,33 +104,39 @@ struct abel_list* make_list(struct json_loader* ptr_loader,
     into the given container passsed in as the first argument
 */
 static void set_terminal_in_list(struct abel_list* ptr_list,
-        size_t iter_key, struct json_token* ptr_token)
+        enum json_terminal_type terminal_type, char* value)
 {
-    char* value = ptr_token->literal->ptr_array;
-    if (ptr_token->terminal_type == NULL_TERM) {
+    if (terminal_type == NULL_TERM) {
         abel_list_append( ptr_list, as_null(value) );
-    } else if (ptr_token->terminal_type == BOOL_TERM) {
+    } else if (terminal_type == BOOL_TERM) {
         abel_list_append( ptr_list, as_bool(value) );
-    } else if (ptr_token->terminal_type == DOUBLE_TERM) {
+    } else if (terminal_type == DOUBLE_TERM) {
         abel_list_append( ptr_list, as_double(value) );
     } else {    // otherwise, set as string
         abel_list_append(ptr_list, value);
     }
 }
 
+/*
+    Keys of loaded dicts are interned, as documents tend to
+    repeat the same keys in many dicts.
+*/
 static void set_terminal_in_dict(struct abel_dict* ptr_dict, char* key,
-                                 struct json_token* ptr_token)
-{
-    char* value = ptr_token->literal->ptr_array;
-    if (ptr_token->terminal_type == NULL_TERM) {
-        abel_dict_insert_null( ptr_dict, key, as_null(value) );
-    } else if (ptr_token->terminal_type == BOOL_TERM) {
-        abel_dict_insert_bool( ptr_dict, key, as_bool(value) );
-    } else if (ptr_token->terminal_type == DOUBLE_TERM) {
-        abel_dict_insert_double( ptr_dict, key, as_double(value) );
+        enum json_terminal_type terminal_type, char* value)
+{
+    struct abel_object* ptr_object = NULL;
+    double double_value;
+    if (terminal_type == NULL_TERM) {
+        ptr_object = abel_null_object_ptr();
+    } else if (terminal_type == BOOL_TERM) {
+        ptr_object = abel_bool_object_ptr(as_bool(value));
+    } else if (terminal_type == DOUBLE_TERM) {
+        double_value = as_double(value);
+        ptr_object = abel_make_object_ptr_from_double_ptr(&double_value);
     } else {    // otherwise, set as string
-        abel_dict_insert_string(ptr_dict, key, value);
+        ptr_object = abel_make_object_ptr_from_string(value);
     }
+    abel_dict_insert_interned(ptr_dict, key, ptr_object);
 }
 
 /*
@@ -155,29 +149,30 @@ static void set_terminal_in_dict(struct abel_dict* ptr_dict, char* key,
     determine key and value
 */
 void fill_dict(struct json_loader* ptr_loader, struct abel_dict* ptr_dict,
-               char* key, struct abel_vector* ptr_token_vector)
+               char* key, const struct json_token_tape* ptr_token_vector)
 {
     int next_index = ptr_loader->current_index + 1;
     enum json_token_type next_token_type
-            = get_token_ptr(ptr_token_vector, next_index)->type;
+            = get_token_type(ptr_token_vector, next_index);
     if (next_token_type == TERMINAL) { // Case 1, next token is a terminal
         // set terminal value
         set_terminal_in_dict( ptr_dict, key,
-                              get_token_ptr(ptr_token_vector, next_index) );
+                get_token(ptr_token_vector, next_index).terminal_type,
+                get_literal(ptr_loader, ptr_token_vector, next_index) );
         // shift current index to point at next iter key token
         ptr_loader->current_index += 2;
     } else if (next_token_type == DICT_OPENING) { // next token is dict opening.
         // build a dict recursively
         struct abel_dict* ptr_subdict
                 = make_dict(ptr_loader, next_index, ptr_token_vector);
-        abel_dict_insert( ptr_dict, key,
-                          abel_make_object_ptr_from_dict_ptr(ptr_subdict) );
+        abel_dict_insert_interned( ptr_dict, key,
+                                   abel_make_object_ptr_from_dict_ptr(ptr_subdict) );
     } else if (next_token_type == LIST_OPENING) { // next token is list opening.
         // build a list
         struct abel_list* ptr_sublist
                 = make_list(ptr_loader, next_index, ptr_token_vector);
-        abel_dict_insert( ptr_dict, key,
-                          abel_make_object_ptr_from_list_ptr(ptr_sublist) );
+        abel_dict_insert_interned( ptr_dict, key,
+                                   abel_make_object_ptr_from_list_ptr(ptr_sublist) );
     } else { /* TODO */ }
 }
 
@@ -200,16 +195,15 @@ void fill_dict(struct json_loader* ptr_loader, struct abel_dict* ptr_dict,
  * the NEXT token.
  */
 void fill_list(struct json_loader* ptr_loader, struct abel_list* ptr_target_list,
-               int key, struct abel_vector* ptr_token_vector)
+               int key, const struct json_token_tape* ptr_token_vector)
 {
     int next_index = ptr_loader->current_index + 1;
-    // get (pointer to) token at next index
-    struct json_token* ptr_token
-            = (struct json_token*)get_token_ptr(ptr_token_vector, next_index);
     enum json_token_type next_token_type
-            = get_token_ptr(ptr_token_vector, next_index)->type;
+            = get_token_type(ptr_token_vector, next_index);
     if (next_token_type == TERMINAL) { // next token is a terminal    
-        set_terminal_in_list(ptr_target_list, key, ptr_token);
+        set_terminal_in_list( ptr_target_list,
+                get_token(ptr_token_vector, next_index).terminal_type,
+                get_literal(ptr_loader, ptr_token_vector, next_index) );
         // shift current index to point at next iter key token
         ptr_loader->current_index += 2;
     } else if (next_token_type == DICT_OPENING) { // next token is dict opening.
@@ -227,10 +221,10 @@ void fill_list(struct json_loader* ptr_loader, struct abel_list* ptr_target_list
 
 /* Operations at a key token */
 void at_key(struct json_loader* ptr_loader, struct abel_dict* dict_sptr_ref,
-            struct abel_vector* token_vector)
+            const struct json_token_tape* token_vector)
 {
     int current_index = ptr_loader->current_index;
-    char* key = get_literal(token_vector, current_index);
+    char* key = get_literal(ptr_loader, token_vector, current_index);
     fill_dict(ptr_loader, dict_sptr_ref, key, token_vector);
 }
 
@@ -246,10 +240,10 @@ void at_key(struct json_loader* ptr_loader, struct abel_dict* dict_sptr_ref,
  *        be filled up.
  */
 void at_iter_key(struct json_loader* ptr_loader,
-        struct abel_list* ptr_target_list, struct abel_vector* ptr_token_vector)
+        struct abel_list* ptr_target_list, const struct json_token_tape* ptr_token_vector)
 {
     int current_index = ptr_loader->current_index;
-    char* literal = get_literal(ptr_token_vector, current_index);
+    char* literal = get_literal(ptr_loader, ptr_token_vector, current_index);
     int iter_key = atoi(literal);  // convert to int
     // Populate target list with the token
     fill_list(ptr_loader, ptr_target_list, iter_key, ptr_token_vector);
@@ -266,15 +260,13 @@ void at_iter_key(struct json_loader* ptr_loader,
  *       to the JSON parser, to unify the APIs.
  **/
 struct abel_dict* make_root_dict(struct json_loader* ptr_loader,
-        struct abel_vector* ptr_token_vector)
+        const struct json_token_tape* ptr_token_vector)
 {
     struct abel_dict* ptr_root_dict = abel_make_dict_ptr();
     // traversing the token vector
     while(ptr_loader->current_index < (int)ptr_token_vector->size) {
         // For this method, current index shall always point at a key token.
-        struct json_token* ptr_token
-                = get_token_ptr(ptr_token_vector, ptr_loader->current_index);
-        if (ptr_token->type == KEY) {
+        if (get_token_type(ptr_token_vector, ptr_loader->current_index) == KEY) {
             at_key(ptr_loader, ptr_root_dict, ptr_token_vector);
             continue;
         }
@@ -298,13 +290,12 @@ struct abel_dict* make_root_dict(struct json_loader* ptr_loader,
  *       to the JSON parser, to unify the APIs.
  **/
 struct abel_list* make_root_list(struct json_loader* ptr_loader,
-                                 struct abel_vector* ptr_token_vector)
+                                 const struct json_token_tape* ptr_token_vector)
 {
     struct abel_list* ptr_root_list = abel_make_list_ptr(0);
     while(ptr_loader->current_index < (int)ptr_token_vector->size) {
-        struct json_token* ptr_token
-                = get_token_ptr(ptr_token_vector, ptr_loader->current_index);
-        if (ptr_token->type == ITER_KEY) {
+        if (get_token_type(ptr_token_vector, ptr_loader->current_index)
+                == ITER_KEY) {
             at_iter_key(ptr_loader, ptr_root_list, ptr_token_vector);
             continue;
         }
@@ -324,6 +315,7 @@ struct abel_list* make_root_list(struct json_loader* ptr_loader,
 void load_from_parser(struct json_loader* ptr_loader,
         struct json_parser* ptr_parser, struct abel_dict* ptr_global_dict)
 {
+    ptr_loader->ptr_parser = ptr_parser;
     ptr_loader->root_container_type
             = *(enum json_container_type*)(abel_vector_at(&(ptr_parser->current_container_type), 0).pointer);
     if (ptr_loader->root_container_type == DICT) {
@@ -335,4 +327,662 @@ void load_from_parser(struct json_loader* ptr_loader,
     } else {
         // error
     }
-}
\ No newline at end of file
+}
+
+/**
+ * JSON builder
+ * 
+ * Builder is attached to a parser as token handler and
+ * builds the containers while tokens are made. Opening and
+ * closing tokens push and pop the stack of open containers,
+ * a key is kept until its value arrives, and a terminal is
+ * set into the innermost container. Iter keys need no
+ * action, as list elements arrive in order.
+ **/
+
+/**
+ * @brief Static - the innermost open container.
+ */
+static struct abel_object* builder_top(struct json_builder* ptr_builder)
+{
+    return abel_vector_back(&ptr_builder->container_stack).pointer;
+}
+
+/**
+ * @brief Static - opens the root container.
+ * 
+ * Root container is inserted into the global dictionary as
+ * done by `load_from_parser`. Its type is known from the
+ * parser by the time the first token is made.
+ */
+static void builder_open_root(struct json_builder* ptr_builder,
+                              const struct json_parser* ptr_parser)
+{
+    enum json_container_type root_container_type
+        = *(enum json_container_type*)(ptr_parser->current_container_type.ptr_array[0]);
+    struct abel_object* ptr_object = NULL;
+    if (root_container_type == DICT) {
+        abel_dict_insert_dict_ptr(ptr_builder->ptr_global_dict, "ROOT_KEY_",
+                                  abel_make_dict_ptr());
+        ptr_object = abel_dict_get_object_ptr(ptr_builder->ptr_global_dict,
+                                              "ROOT_KEY_");
+    } else {
+        ptr_object = abel_make_object_ptr(abel_make_list_ptr(0));
+        abel_dict_insert(ptr_builder->ptr_global_dict, "ROOT_KEY_", ptr_object);
+    }
+    abel_vector_append(&ptr_builder->container_stack, ptr_object);
+}
+
+/**
+ * @brief Static - opens a container in the innermost one.
+ * 
+ * @param ptr_builder Pointer to builder.
+ * @param opening_type Either DICT_OPENING or LIST_OPENING.
+ */
+static void builder_open_container(struct json_builder* ptr_builder,
+                                   enum json_token_type opening_type)
+{
+    struct abel_object* ptr_top = builder_top(ptr_builder);
+    struct abel_object* ptr_object = NULL;
+    if (ptr_top->data_type == DICT_TYPE) {
+        if (opening_type == DICT_OPENING) {
+            ptr_object = abel_make_object_ptr_from_dict_ptr(abel_make_dict_ptr());
+        } else {
+            ptr_object = abel_make_object_ptr_from_list_ptr(abel_make_list_ptr(0));
+        }
+        abel_dict_insert_interned(ptr_top->ptr_data,
+                                  abel_string_cstr(&ptr_builder->current_key),
+                                  ptr_object);
+    } else {
+        struct abel_list* ptr_list = ptr_top->ptr_data;
+        if (opening_type == DICT_OPENING) {
+            abel_list_append(ptr_list, abel_make_dict_ptr());
+        } else {
+            abel_list_append(ptr_list, abel_make_list_ptr(0));
+        }
+        ptr_object = abel_list_get_object_pointer(ptr_list,
+                                                  abel_list_size(ptr_list) - 1);
+    }
+    abel_vector_append(&ptr_builder->container_stack, ptr_object);
+}
+
+/**
+ * @brief Static - token handler of builder.
+ */
+static void builder_on_token(void* ptr_context,
+                             const struct json_parser* ptr_parser,
+                             const struct json_token* ptr_token)
+{
+    struct json_builder* ptr_builder = ptr_context;
+    if (abel_vector_size(&ptr_builder->container_stack) == 0) {
+        builder_open_root(ptr_builder, ptr_parser);
+    }
+    char* literal = (char*)abel_json_token_literal(ptr_parser, ptr_token);
+    struct abel_object* ptr_top = builder_top(ptr_builder);
+    switch (ptr_token->type) {
+    case KEY:
+        abel_string_assign(&ptr_builder->current_key, literal);
+        break;
+    case TERMINAL:
+        if (ptr_top->data_type == DICT_TYPE) {
+            set_terminal_in_dict(ptr_top->ptr_data,
+                                 abel_string_cstr(&ptr_builder->current_key),
+                                 ptr_token->terminal_type, literal);
+        } else {
+            set_terminal_in_list(ptr_top->ptr_data,
+                                 ptr_token->terminal_type, literal);
+        }
+        break;
+    case DICT_OPENING:
+    case LIST_OPENING:
+        builder_open_container(ptr_builder, ptr_token->type);
+        break;
+    case DICT_CLOSING:
+    case LIST_CLOSING:
+        /* root container has no closing token */
+        if (abel_vector_size(&ptr_builder->container_stack) > 1) {
+            abel_vector_pop_back(&ptr_builder->container_stack);
+        }
+        break;
+    default:    /* iter key */
+        break;
+    }
+}
+
+void abel_make_json_builder(struct json_builder* ptr_builder,
+                            struct abel_dict* ptr_global_dict)
+{
+    ptr_builder->ptr_global_dict = ptr_global_dict;
+    ptr_builder->container_stack = abel_make_vector(0);
+    ptr_builder->current_key = abel_make_string("");
+}
+
+void abel_free_json_builder(struct json_builder* ptr_builder)
+{
+    abel_free_vector(&ptr_builder->container_stack);
+    abel_free_string(&ptr_builder->current_key);
+}
+
+void abel_json_builder_attach(struct json_builder* ptr_builder,
+        struct json_parser* ptr_parser, Bool is_token_vector_kept)
+{
+    struct json_token_handler handler;
+    handler.ptr_context = ptr_builder;
+    handler.on_token = builder_on_token;
+    abel_json_parser_set_token_handler(ptr_parser, handler,
+                                       is_token_vector_kept);
+}
+
+struct abel_return_option load_from_file(struct abel_dict* ptr_global_dict,
+                                         const char* file_name)
+{
+    struct json_parser parser;
+    struct json_builder builder;
+    abel_make_json_parser(&parser);
+    abel_make_json_builder(&builder, ptr_global_dict);
+    abel_json_builder_attach(&builder, &parser, false);
+    struct abel_return_option ret = abel_parse_file_mapped(&parser, file_name);
+    abel_free_json_builder(&builder);
+    abel_free_json_parser(&parser);
+    return ret;
+}
+
+/**
+ * Arena
+ **/
+
+/**
+ * @brief Static - Chunk of an arena
+ *
+ * Memory is handed out from `data` upwards. Array of
+ * `max_align_t` keeps the memory aligned for any type.
+ */
+struct abel_arena_chunk {
+    struct abel_arena_chunk* ptr_next;
+    size_t capacity;
+    size_t used;
+    max_align_t data[];
+};
+
+struct abel_arena abel_make_arena()
+{
+    struct abel_arena arena;
+    arena.ptr_chunk = NULL;
+    arena.chunk_size = ARENA_MIN_CHUNK_SIZE;
+    arena.bytes = 0;
+    return arena;
+}
+
+void* abel_arena_alloc(struct abel_arena* ptr_arena, size_t size)
+{
+    struct abel_arena_chunk* ptr_chunk = ptr_arena->ptr_chunk;
+    size_t alignment = _Alignof(max_align_t);
+    size_t capacity = ptr_arena->chunk_size;
+    void* ptr_memory = NULL;
+    size = (size + alignment - 1) / alignment * alignment;
+    if (ptr_chunk == NULL || ptr_chunk->capacity - ptr_chunk->used < size) {
+        if (size > capacity / 4) {
+            capacity = size;
+        }
+        ptr_chunk = malloc(sizeof(*ptr_chunk) + capacity);
+        if (ptr_chunk == NULL) {
+            return NULL;
+        }
+        ptr_chunk->capacity = capacity;
+        ptr_chunk->used = 0;
+        ptr_arena->bytes += capacity;
+        if (capacity == size && ptr_arena->ptr_chunk != NULL) {
+            /* own chunk goes behind, current one keeps its room */
+            ptr_chunk->ptr_next = ptr_arena->ptr_chunk->ptr_next;
+            ptr_arena->ptr_chunk->ptr_next = ptr_chunk;
+        } else {
+            ptr_chunk->ptr_next = ptr_arena->ptr_chunk;
+            ptr_arena->ptr_chunk = ptr_chunk;
+            if (ptr_arena->chunk_size < ARENA_MAX_CHUNK_SIZE) {
+                ptr_arena->chunk_size *= 2;
+            }
+        }
+    }
+    ptr_memory = (char*)ptr_chunk->data + ptr_chunk->used;
+    ptr_chunk->used += size;
+    return ptr_memory;
+}
+
+void abel_free_arena(struct abel_arena* ptr_arena)
+{
+    struct abel_arena_chunk* ptr_chunk = ptr_arena->ptr_chunk;
+    while (ptr_chunk != NULL) {
+        struct abel_arena_chunk* ptr_next = ptr_chunk->ptr_next;
+        free(ptr_chunk);
+        ptr_chunk = ptr_next;
+    }
+    *ptr_arena = abel_make_arena();
+}
+
+/**
+ * Document
+ *
+ * Document builder is attached to a parser as token handler,
+ * like the JSON builder, but makes containers only once they
+ * are closed. Until then, the elements of open containers
+ * are kept on a stack of values, each with its key on a
+ * parallel stack of keys, NULL in lists. So a container is
+ * made with exactly the room for its elements, and nothing
+ * is ever reallocated in the arena.
+ **/
+
+/**
+ * @brief Static - State of loading a document
+ *
+ * Fields
+ *
+ * ptr_document : Document being loaded.
+ * container_stack : Objects of the open containers, the
+ *     innermost one at the back. Their data is set on close.
+ * value_starts : Index of the first element of each open
+ *     container on the stack of values.
+ * keys : Interned keys of elements, or NULL in lists. Each
+ *     holds a reference until its container is made.
+ * values : Objects of the elements of open containers.
+ * is_failed : Set if malloc fails, after which tokens are
+ *     ignored.
+ */
+struct document_builder {
+    struct abel_document* ptr_document;
+    struct abel_vector container_stack;
+    struct abel_vector value_starts;
+    struct abel_vector keys;
+    struct abel_vector values;
+    Bool is_failed;
+};
+
+/**
+ * @brief Static - Make an object in the arena
+ *
+ * @return Pointer to object or NULL if malloc fails.
+ */
+static struct abel_object* document_make_object(
+        struct abel_document* ptr_document, void* ptr_data,
+        size_t data_size, enum data_type data_type)
+{
+    struct abel_object* ptr_object
+        = abel_arena_alloc(&ptr_document->arena, sizeof(*ptr_object));
+    if (ptr_object != NULL) {
+        ptr_object->ptr_data = ptr_data;
+        ptr_object->data_size = data_size;
+        ptr_object->data_type = data_type;
+        /* released with the arena, never by the object freer */
+        ABEL_OBJECT_INIT_REF_COUNT(ptr_object, OBJECT_IMMORTAL_REF_COUNT);
+    }
+    return ptr_object;
+}
+
+/**
+ * @brief Static - Make an object of a terminal in the arena
+ *
+ * Data of a string is copied into the arena and a double is
+ * stored inline in its object. Null and Bool take immortal
+ * objects.
+ */
+static struct abel_object* document_make_terminal(
+        struct abel_document* ptr_document,
+        enum json_terminal_type terminal_type, char* value)
+{
+    struct abel_object* ptr_object = NULL;
+    size_t length = 0;
+    char* ptr_str = NULL;
+    if (terminal_type != NULL_TERM && terminal_type != BOOL_TERM
+            && terminal_type != DOUBLE_TERM) {    // set as string
+        length = strlen(value);
+        ptr_str = abel_arena_alloc(&ptr_document->arena, length + 1);
+        if (ptr_str == NULL) {
+            return NULL;
+        }
+        memcpy(ptr_str, value, length + 1);
+        return document_make_object(ptr_document, ptr_str, sizeof(char),
+                                    STRING_TYPE);
+    }
+    if (terminal_type == NULL_TERM) {
+        return abel_null_object_ptr();
+    } else if (terminal_type == BOOL_TERM) {
+        return abel_bool_object_ptr(as_bool(value));
+    }
+    ptr_object = document_make_object(ptr_document, NULL, sizeof(double),
+                                      DOUBLE_TYPE);
+    if (ptr_object != NULL) {
+        ptr_object->value.double_value = as_double(value);
+        ptr_object->ptr_data = &ptr_object->value;
+    }
+    return ptr_object;
+}
+
+/**
+ * @brief Static - Make a list of the elements of a container
+ */
+static struct abel_list* document_make_list(struct abel_document* ptr_document,
+        void** ptr_elements, size_t size)
+{
+    struct abel_arena* ptr_arena = &ptr_document->arena;
+    struct abel_list* ptr_list = abel_arena_alloc(ptr_arena, sizeof(*ptr_list));
+    struct abel_vector* ptr_vector = abel_arena_alloc(ptr_arena,
+                                                      sizeof(*ptr_vector));
+    void** ptr_array = NULL;
+    if (size > 0) {
+        ptr_array = abel_arena_alloc(ptr_arena, size * sizeof(*ptr_array));
+    }
+    if (ptr_list == NULL || ptr_vector == NULL
+            || (size > 0 && ptr_array == NULL)) {
+        return NULL;
+    }
+    for (size_t i = 0; i < size; i++) {
+        ptr_array[i] = ptr_elements[i];
+    }
+    ptr_vector->ptr_array = ptr_array;
+    ptr_vector->size = size;
+    ptr_vector->capacity = size;
+    ptr_list->ptr_vector = ptr_vector;
+    ptr_list->data_type = OBJECT_TYPE;
+    ptr_list->is_read_only = true;
+    return ptr_list;
+}
+
+/**
+ * @brief Static - Make a dict of the elements of a container
+ *
+ * Dict takes shape form, unless it has more keys than a shape
+ * may have, in which case it gets a map on heap. Either is
+ * kept by the document to be released with it.
+ */
+static struct abel_dict* document_make_dict(struct abel_document* ptr_document,
+        void** ptr_keys, void** ptr_elements, size_t size)
+{
+    struct abel_dict* ptr_dict
+        = abel_arena_alloc(&ptr_document->arena, sizeof(*ptr_dict));
+    struct abel_key_shape* ptr_shape = NULL;
+    struct abel_key_shape* ptr_new_shape = NULL;
+    if (ptr_dict == NULL) {
+        return NULL;
+    }
+    ptr_dict->ptr_map = NULL;
+    ptr_dict->data_type = OBJECT_TYPE;
+    ptr_dict->ptr_shape = NULL;
+    ptr_dict->ptr_values = NULL;
+    ptr_dict->is_read_only = true;
+    if (size == 0) {
+        return ptr_dict;
+    }
+    if (size > DICT_SHAPE_MAX_SIZE) {
+        ptr_dict->ptr_map = abel_make_map_ptr();
+        if (ptr_dict->ptr_map == NULL) {
+            return NULL;
+        }
+        if (abel_vector_append(&ptr_document->maps,
+                               ptr_dict->ptr_map).is_error == true) {
+            abel_free_map_ptr(ptr_dict->ptr_map);
+            return NULL;
+        }
+        if (abel_map_reserve(ptr_dict->ptr_map, size).is_error == true) {
+            return NULL;
+        }
+        for (size_t i = 0; i < size; i++) {
+            if (abel_map_insert_interned(ptr_dict->ptr_map, ptr_keys[i],
+                                         ptr_elements[i]).is_error == true) {
+                return NULL;
+            }
+        }
+        return ptr_dict;
+    }
+    ptr_dict->ptr_values = abel_arena_alloc(&ptr_document->arena,
+                                            size * sizeof(*ptr_dict->ptr_values));
+    if (ptr_dict->ptr_values == NULL) {
+        return NULL;
+    }
+    /* parser rejects duplicated keys, so each key extends the shape */
+    for (size_t i = 0; i < size; i++) {
+        ptr_new_shape = abel_key_shape_add_key(ptr_shape, ptr_keys[i]);
+        if (ptr_shape != NULL) {
+            abel_release_key_shape(ptr_shape);
+        }
+        if (ptr_new_shape == NULL) {
+            return NULL;
+        }
+        ptr_shape = ptr_new_shape;
+        ptr_dict->ptr_values[i] = ptr_elements[i];
+    }
+    if (abel_vector_append(&ptr_document->shapes, ptr_shape).is_error == true) {
+        abel_release_key_shape(ptr_shape);
+        return NULL;
+    }
+    ptr_dict->ptr_shape = ptr_shape;
+    return ptr_dict;
+}
+
+/**
+ * @brief Static - Append an element to the innermost container
+ *
+ * Key of an element of a dict was pushed by its key token.
+ */
+static void document_append(struct document_builder* ptr_builder,
+                            struct abel_object* ptr_object)
+{
+    struct abel_object* ptr_top
+        = abel_vector_back(&ptr_builder->container_stack).pointer;
+    if (ptr_object == NULL) {
+        ptr_builder->is_failed = true;
+        return;
+    }
+    if (ptr_top->data_type == LIST_TYPE
+            && abel_vector_append(&ptr_builder->keys, NULL).is_error == true) {
+        ptr_builder->is_failed = true;
+        return;
+    }
+    if (abel_vector_append(&ptr_builder->values, ptr_object).is_error == true) {
+        ptr_builder->is_failed = true;
+    }
+}
+
+/**
+ * @brief Static - Open a container
+ *
+ * Object of the container is made at once and appended to
+ * the innermost container, unless it is the root. Its data
+ * is made on close.
+ */
+static void document_open_container(struct document_builder* ptr_builder,
+                                    enum data_type data_type)
+{
+    struct abel_document* ptr_document = ptr_builder->ptr_document;
+    size_t data_size = (data_type == DICT_TYPE) ? sizeof(struct abel_dict)
+                                                : sizeof(struct abel_list);
+    struct abel_object* ptr_object
+        = document_make_object(ptr_document, NULL, data_size, data_type);
+    if (ptr_object == NULL) {
+        ptr_builder->is_failed = true;
+        return;
+    }
+    if (ptr_document->ptr_root == NULL) {
+        ptr_document->ptr_root = ptr_object;
+    } else {
+        document_append(ptr_builder, ptr_object);
+    }
+    if (abel_vector_append(&ptr_builder->container_stack,
+                           ptr_object).is_error == true
+            || abel_vector_append(&ptr_builder->value_starts,
+                   (void*)(uintptr_t)ptr_builder->values.size).is_error == true) {
+        ptr_builder->is_failed = true;
+    }
+}
+
+/**
+ * @brief Static - Close the innermost container
+ *
+ * Container is made of the elements on top of the stack of
+ * values, which are then popped with their keys.
+ */
+static void document_close_container(struct document_builder* ptr_builder)
+{
+    struct abel_object* ptr_object
+        = abel_vector_pop_back(&ptr_builder->container_stack).pointer;
+    size_t start
+        = (uintptr_t)abel_vector_pop_back(&ptr_builder->value_starts).pointer;
+    void** ptr_keys = ptr_builder->keys.ptr_array + start;
+    void** ptr_elements = ptr_builder->values.ptr_array + start;
+    size_t size = ptr_builder->values.size - start;
+    if (ptr_builder->is_failed == false) {
+        if (ptr_object->data_type == DICT_TYPE) {
+            ptr_object->ptr_data = document_make_dict(ptr_builder->ptr_document,
+                                       ptr_keys, ptr_elements, size);
+        } else {
+            ptr_object->ptr_data = document_make_list(ptr_builder->ptr_document,
+                                       ptr_elements, size);
+        }
+        if (ptr_object->ptr_data == NULL) {
+            ptr_builder->is_failed = true;
+        }
+    }
+    for (size_t i = start; i < ptr_builder->keys.size; i++) {
+        if (ptr_builder->keys.ptr_array[i] != NULL) {
+            abel_release_interned_key(ptr_builder->keys.ptr_array[i]);
+        }
+    }
+    ptr_builder->keys.size = start;
+    ptr_builder->values.size = start;
+}
+
+/**
+ * @brief Static - token handler of document builder.
+ */
+static void document_on_token(void* ptr_context,
+                              const struct json_parser* ptr_parser,
+                              const struct json_token* ptr_token)
+{
+    struct document_builder* ptr_builder = ptr_context;
+    struct abel_document* ptr_document = ptr_builder->ptr_document;
+    char* literal = NULL;
+    const char* interned_key = NULL;
+    if (ptr_builder->is_failed == true) {
+        return;
+    }
+    if (ptr_document->ptr_root == NULL) {
+        /* root container has no opening token */
+        enum json_container_type root_container_type
+            = *(enum json_container_type*)(ptr_parser->current_container_type.ptr_array[0]);
+        document_open_container(ptr_builder, (root_container_type == DICT)
+                                             ? DICT_TYPE : LIST_TYPE);
+        if (ptr_builder->is_failed == true) {
+            return;
+        }
+    }
+    literal = (char*)abel_json_token_literal(ptr_parser, ptr_token);
+    switch (ptr_token->type) {
+    case KEY:
+        interned_key = abel_intern_key(literal);
+        if (interned_key == NULL
+                || abel_vector_append(&ptr_builder->keys,
+                                      (void*)interned_key).is_error == true) {
+            ptr_builder->is_failed = true;
+        }
+        break;
+    case TERMINAL:
+        document_append(ptr_builder, document_make_terminal(ptr_document,
+                                         ptr_token->terminal_type, literal));
+        break;
+    case DICT_OPENING:
+        document_open_container(ptr_builder, DICT_TYPE);
+        break;
+    case LIST_OPENING:
+        document_open_container(ptr_builder, LIST_TYPE);
+        break;
+    case DICT_CLOSING:
+    case LIST_CLOSING:
+        /* root container has no closing token */
+        if (abel_vector_size(&ptr_builder->container_stack) > 1) {
+            document_close_container(ptr_builder);
+        }
+        break;
+    default:    /* iter key */
+        break;
+    }
+}
+
+/**
+ * @brief Static - Load a document by a parse function
+ *
+ * Containers left open by the end of parsing, i.e. the root
+ * one and any that a parse error cuts short, are closed
+ * afterwards.
+ *
+ * @param ptr_source Either a file name or a buffer.
+ */
+static struct abel_return_option document_load(
+        struct abel_document* ptr_document, const char* ptr_source,
+        size_t length, Bool is_file)
+{
+    struct json_parser parser;
+    struct document_builder builder;
+    struct json_token_handler handler;
+    struct abel_return_option ret;
+    abel_make_json_parser(&parser);
+    builder.ptr_document = ptr_document;
+    builder.container_stack = abel_make_vector(0);
+    builder.value_starts = abel_make_vector(0);
+    builder.keys = abel_make_vector(0);
+    builder.values = abel_make_vector(0);
+    builder.is_failed = false;
+    handler.ptr_context = &builder;
+    handler.on_token = document_on_token;
+    abel_json_parser_set_token_handler(&parser, handler, false);
+    if (is_file == true) {
+        ret = abel_parse_file_mapped(&parser, ptr_source);
+    } else {
+        ret = abel_parse_buffer(&parser, ptr_source, length);
+    }
+    while (abel_vector_size(&builder.container_stack) > 0) {
+        document_close_container(&builder);
+    }
+    if (builder.is_failed == true) {
+        /* containers are not all made, none can be read */
+        ptr_document->ptr_root = NULL;
+        ret = abel_option_error( error_malloc_failure() );
+    }
+    abel_free_vector(&builder.container_stack);
+    abel_free_vector(&builder.value_starts);
+    abel_free_vector(&builder.keys);
+    abel_free_vector(&builder.values);
+    abel_free_json_parser(&parser);
+    return ret;
+}
+
+void abel_make_document(struct abel_document* ptr_document)
+{
+    ptr_document->arena = abel_make_arena();
+    ptr_document->ptr_root = NULL;
+    ptr_document->shapes = abel_make_vector(0);
+    ptr_document->maps = abel_make_vector(0);
+}
+
+struct abel_return_option abel_document_load_file(
+        struct abel_document* ptr_document, const char* file_name)
+{
+    return document_load(ptr_document, file_name, 0, true);
+}
+
+struct abel_return_option abel_document_load_buffer(
+        struct abel_document* ptr_document, const char* buffer, size_t length)
+{
+    return document_load(ptr_document, buffer, length, false);
+}
+
+void abel_document_free(struct abel_document* ptr_document)
+{
+    for (size_t i = 0; i < abel_vector_size(&ptr_document->shapes); i++) {
+        abel_release_key_shape(ptr_document->shapes.ptr_array[i]);
+    }
+    for (size_t i = 0; i < abel_vector_size(&ptr_document->maps); i++) {
+        abel_free_map_ptr(ptr_document->maps.ptr_array[i]);
+    }
+    abel_free_vector(&ptr_document->shapes);
+    abel_free_vector(&ptr_document->maps);
+    abel_free_arena(&ptr_document->arena);
+    ptr_document->ptr_root = NULL;
+}
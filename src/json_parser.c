@@ -6,27 +6,67 @@
  * Static functions are required to operate on the internal
  * vectors of the parser.
  **/
+#define _POSIX_C_SOURCE 200809L    // for mmap and friends
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef ABEL_ATOMIC_REF_COUNT
+#include <threads.h>
+#endif
+#include <unistd.h>
 #include "json_parser.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define ABEL_SCAN_X86 1    // SSE2 is always present on x86-64
+#endif
+
+/* Size of the chunks read from file by `abel_parse_file` */
+const size_t JSON_PARSER_READ_CHUNK_SIZE = 65536;
+
+/**
+ * @brief Static - Make a parser error
+ * 
+ * Message is copied into the parser, as it is usually
+ * composed in a buffer on the stack of the reporting
+ * function, and the error outlives that function.
+ * 
+ * @param ptr_parser Pointer to the parser.
+ * @param msg Error message, truncated to fit the buffer.
+ */
+static struct abel_return_option parser_error(struct json_parser* ptr_parser,
+                                              const char* msg)
+{
+    snprintf(ptr_parser->error_message, sizeof(ptr_parser->error_message),
+             "%s", msg);
+    return abel_option_error( error_parser_error(ptr_parser->error_message,
+                                                 ptr_parser->current_line) );
+}
+
 /** 
  * Static functions for token vector
  * 
- * @brief Token vector stores pointer to tokens stored
- *        on heap. Actual operations in the following
- *        functions are delegated to the ones for vector.
+ * @brief Token vector is a token tape, which stores the
+ *        fields of tokens in contiguous arrays. Actual
+ *        operations in the following functions are
+ *        delegated to the ones for token tape.
  * 
- * token_vector_size : Returns the size of token vector.
- *     Size is the total number of tokens stored in the
- *     token vector.
+ *        Every token made by the parser is pushed back via
+ *        these functions, which also pass it to the token
+ *        handler if any. If token vector is not kept, the
+ *        token is only passed to the handler.
+ * 
+ * token_vector_size : Returns the total number of tokens
+ *     made so far, whether kept or not.
  * 
  * token_vector_push_back : Pushes back a new token into
  *     token vector.
  * 
- * token_vector_at : Returns a pointer to the token at
- *     given index.
+ * token_vector_last_type : Returns the type of the last
+ *     token.
  * 
- * token_vector_last : Returns the last token (pointer to
- *     token) in the vector.
+ * token_vector_set_last_referenced_type : Updates the
+ *     referenced type of the last token in the vector.
  * 
  * free_token_vector : Releases all resource held by the
  *     token vector.
@@ -35,84 +75,87 @@
 /**
  * @brief Token vector - size.
  * 
- * Size of a token vector is the total number of token
- * (pointers) stored in the vector.
+ * Size of a token vector is the total number of tokens
+ * that have been pushed back. If token vector is not kept,
+ * the tokens are counted all the same.
  * 
  * @param ptr_parser Pointer to the parser.
- * @return Total number of tokens (pointers) stored in
- *     vector.
+ * @return Total number of tokens pushed back.
  */
 static size_t token_vector_size(const struct json_parser* ptr_parser)
 {
-    return abel_vector_size( (struct abel_vector*)&ptr_parser->token_vector );
+    return ptr_parser->token_count;
 }
 
 /**
  * @brief Token vector - pushes back new token.
  * 
- * A token instance is copied onto to heap and the pointer
- * to that on-heap instance is stored in token vector.
+ * Fields of the token instance are copied onto the tape,
+ * then the token is passed to the token handler. If token
+ * vector is not kept, the literal of the token is dropped
+ * from the literal pool once the handler returns.
  * 
  * @param ptr_parser Pointer to the parser.
  * @param ref_token Pointer to the token to be copied and
  *                  stored in token vector.
  * @return struct abel_return_option instance.
- *         - If success, is_okay is true and pointer is the
- *           to the newly added token pointer.
+ *         - If success, is_okay is true and pointer is NULL.
  *         - If failure, is_error is true and error contains
  *           the error instance.
  */
 static struct abel_return_option token_vector_push_back(
         struct json_parser* ptr_parser, struct json_token* ref_token)
 {
-    struct abel_return_option ret;
-    json_token_ptr ptr_token = abel_make_token_ptr(ref_token);
-    ret = abel_vector_append(&ptr_parser->token_vector, ptr_token);
+    struct abel_return_option ret = abel_option_okay(NULL);
+    if (ptr_parser->is_token_vector_kept == true) {
+        ret = abel_token_tape_push_back(&ptr_parser->token_vector, ref_token);
+    }
     if (ret.is_okay == true) {
-        ret.pointer = ptr_token;
+        ptr_parser->token_count += 1;
+        ptr_parser->last_token_type = ref_token->type;
+        if (ptr_parser->token_handler.on_token != NULL) {
+            ptr_parser->token_handler.on_token(
+                ptr_parser->token_handler.ptr_context, ptr_parser, ref_token);
+        }
+        if (ptr_parser->is_token_vector_kept == false) {
+            /* literal is the last one in pool */
+            abel_string_truncate(&ptr_parser->literal_pool,
+                                 ref_token->literal.offset);
+        }
     }
     return ret;
 }
 
 /**
- * @brief Token vector - returns a JSON token pointer.
+ * @brief Token vector - returns the type of the last token
  * 
  * @param ptr_parser Pointer to the parser.
- * @param idx Index of the token in the vector.
- * @return A JSON token pointer is returned. If the index
- *         is out of range, a NULL pointer is returned. 
+ * @return Type of the last token.
+ * @note If no token has been made, UNKNOWN_TOKEN is
+ *       returned.
  */
-static json_token_ptr token_vector_at(struct json_parser* ptr_parser, size_t idx)
+static enum json_token_type token_vector_last_type(
+        const struct json_parser* ptr_parser)
 {
-    struct abel_return_option ret
-            = abel_vector_at(&ptr_parser->token_vector, idx);
-    json_token_ptr ptr_token;
-    if (ret.is_okay == true) {
-        ptr_token = abel_vector_at(&ptr_parser->token_vector, idx).pointer;
-    } else {
-        ptr_token = NULL;
-    }
-    return ptr_token;
+    return ptr_parser->last_token_type;
 }
 
 /**
- * @brief Token vector - returns the last token
+ * @brief Token vector - updates referenced type of last token
  * 
  * @param ptr_parser Pointer to the parser.
- * @return Pointer to the last token in the vector.
- * @note If the last token doesn't exist, in for example
- *       an empty vector, a NULL pointer is returned.
+ * @param referenced_type One of the static strings "Terminal",
+ *                        "Dict" and "List".
+ * @note Nothing to update if token vector is not kept.
  */
-static json_token_ptr token_vector_last(struct json_parser* ptr_parser)
+static void token_vector_set_last_referenced_type(
+        struct json_parser* ptr_parser, const char* referenced_type)
 {
-    struct abel_return_option ret = abel_vector_back(&ptr_parser->token_vector);
-    json_token_ptr ptr_token;
-    if (ret.is_okay == true) {
-        ptr_token = abel_vector_back(&ptr_parser->token_vector).pointer;
-    } else {
-        ptr_token = NULL;
+    size_t size = abel_token_tape_size(&ptr_parser->token_vector);
+    if (ptr_parser->is_token_vector_kept == true && size > 0) {
+        ptr_parser->token_vector.ptr_referenced_types[size - 1]
+            = referenced_type;
     }
-    return ptr_token;
 }
 
 /**
@@ -121,20 +164,10 @@ static json_token_ptr token_vector_last(struct json_parser* ptr_parser)
  * Frees all resources held by the token vector.
  * 
  * @param ptr_parser Pointer to the parser.
- * @note Since all tokens are freed by whilst freeing this
- *       vector, one must NOT free them again whilst freeing
- *       keys-per-level vector. Otherwise, error in freeing
- *       memories that are not to be freed.
  */
 static void free_token_vector(struct json_parser* ptr_parser)
 {
-    size_t token_vector_len = token_vector_size(ptr_parser);
-    json_token_ptr ptr_token = NULL;
-    for (int i = 0; i < token_vector_len; i++) {
-        ptr_token = token_vector_at(ptr_parser, i);
-        if (ptr_token != NULL) abel_free_json_token_ptr(ptr_token);
-    }
-    abel_free_vector(&ptr_parser->token_vector);
+    abel_free_token_tape(&ptr_parser->token_vector);
 }
 
 /**
@@ -381,21 +414,18 @@ static struct abel_return_option set_root_container_type(
 {
     struct abel_return_option ret;
     char errmsg[128] = "\0";
-    struct abel_error err;
     if (type != NONE_CONTAINER) {
         enum json_container_type root = cct_vector_at(ptr_parser, 0);
         if (root == LIST || root == DICT) {
             strcat(errmsg, "Manual override of root contianer type is forbidden");
-            err = error_parser_error(errmsg, ptr_parser->current_line);
-            ret = abel_option_error(err);
+            ret = parser_error(ptr_parser, errmsg);
         } else {
             cct_vector_emplace(ptr_parser, 0, type);
             ret = abel_option_okay(NULL);
         }
     } else {
         strcat(errmsg, "Unknown type for root container.");
-        err = error_parser_error(errmsg, ptr_parser->current_line);
-        ret = abel_option_error(err);
+        ret = parser_error(ptr_parser, errmsg);
     }
     return ret;
 }
@@ -575,26 +605,92 @@ static void free_cii_vector(struct json_parser* ptr_parser)
     abel_free_vector(&ptr_parser->current_iter_index);
 }
 
+/**
+ * Static functions for interned parent keys
+ * 
+ * @brief Every parent key is interned once: the key is stored
+ *        in the parent-key map, which associates it with an
+ *        id, and the table maps the id back to the key. Tokens
+ *        carry the id only. Iter keys of list elements are
+ *        not interned, their id is the tagged iter index.
+ * 
+ * intern_parent_key : Returns the id of a key, interning it
+ *     if it is new.
+ * 
+ * parent_key_by_id : Returns the interned key of an id.
+ * 
+ * free_parent_key_table : Freer.
+ **/
+
+/**
+ * @brief Parent key - intern.
+ * 
+ * Ids are assigned in order of interning, starting from 0.
+ * Map stores the id itself in place of the data pointer.
+ * 
+ * @param ptr_parser Pointer to parser.
+ * @param key Parent key as C string.
+ * @return Id of the key.
+ */
+static size_t intern_parent_key(struct json_parser* ptr_parser, char* key)
+{
+    struct abel_return_option ret
+            = abel_map_find(ptr_parser->ptr_parent_key_ids, key);
+    size_t id = 0;
+    if (ret.is_okay == true) {
+        id = (size_t)(uintptr_t)((struct abel_key_value_pair*)ret.pointer)->ptr_data;
+    } else {
+        id = abel_vector_size(&ptr_parser->parent_key_table);
+        ret = abel_map_insert(ptr_parser->ptr_parent_key_ids, key,
+                              (void*)(uintptr_t)id);
+        /* table refers to the key owned by the map */
+        abel_vector_append(&ptr_parser->parent_key_table,
+                           ((struct abel_key_value_pair*)ret.pointer)->key);
+    }
+    return id;
+}
+
+/**
+ * @brief Parent key - by id.
+ */
+static const char* parent_key_by_id(const struct json_parser* ptr_parser,
+                                    size_t id)
+{
+    return ptr_parser->parent_key_table.ptr_array[id];
+}
+
+/**
+ * @brief Parent key - freer.
+ * 
+ * Keys are owned by the map, the table only refers to them.
+ */
+static void free_parent_key_table(struct json_parser* ptr_parser)
+{
+    abel_free_map_ptr(ptr_parser->ptr_parent_key_ids);
+    abel_free_vector(&ptr_parser->parent_key_table);
+}
+
 /**
  * Static functions for parent key vector
  * 
- * @brief Parent-key vector stores pointers to struct abel_string
- *        intances created on the heap. In the following,
- *        parent-key vector is abbreviated as `pk_vector`.
+ * @brief Parent-key vector stores the ids of the interned
+ *        parent keys, one per level. As ids are integers,
+ *        they are stored in place of the pointers. In the
+ *        following, parent-key vector is abbreviated as
+ *        `pk_vector`.
  * 
  * pk_vector_init : Parent key vector is initialised to
- *     [struct abel_string*("ROOT_KEY_")].
+ *     [id("ROOT_KEY_")].
  * 
  * pk_vector_size : Returns the size of the parent-key
  *     vector.
  * 
- * pk_vector_push_back : Push a parent key into the vector
+ * pk_vector_push_back : Push a parent key id into the vector
  *     and effectively opens a new level.
  * 
- * pk_vector_at : Returns a struct abel_string* at the given level.
+ * pk_vector_at : Returns the parent key id at the given level.
  * 
- * pk_vector_assign : Assign a parent key string to the
- *     given level. It also frees the previous key string.
+ * pk_vector_assign : Assign a parent key id to the given level.
  * 
  * free_pk_vector : Freer.
  **/
@@ -602,15 +698,15 @@ static void free_cii_vector(struct json_parser* ptr_parser)
 /**
  * @brief Parent key vector - init.
  * 
- * Initialise pk vector to [struct abel_string*("ROOT_KEY_")].
+ * Initialise pk vector to [id("ROOT_KEY_")].
  * 
  * @param ptr_parser Pointer to parser.
  */
 static void pk_vector_init(struct json_parser* ptr_parser)
 {
     char root_key[] = "ROOT_KEY_";
-    struct abel_string* ptr_pk = abel_make_string_ptr(root_key);
-    abel_vector_append(&ptr_parser->parent_key, ptr_pk);
+    size_t id = intern_parent_key(ptr_parser, root_key);
+    abel_vector_append(&ptr_parser->parent_key, (void*)(uintptr_t)id);
 }
 
 /**
@@ -627,18 +723,14 @@ static size_t pk_vector_size(struct json_parser* ptr_parser)
 /**
  * @brief Parent key vector - push back.
  * 
- * Pushes a parent key in the vector. Note that this vector
- * works with struct abel_string instances, as most fields in the parser
- * are struct abel_string objects.
+ * Pushes a parent key id in the vector.
  * 
  * @param ptr_parser Pointer to parser.
- * @param ref_str A pointer to struct abel_string instance.
+ * @param id Id of an interned parent key.
  */
-static void pk_vector_push_back(struct json_parser* ptr_parser,
-                                struct abel_string* ref_str)
+static void pk_vector_push_back(struct json_parser* ptr_parser, size_t id)
 {
-    struct abel_string* ptr_str = abel_make_string_ptr(ref_str->ptr_array);
-    abel_vector_append(&ptr_parser->parent_key, ptr_str);
+    abel_vector_append(&ptr_parser->parent_key, (void*)(uintptr_t)id);
 }
 
 /**
@@ -646,36 +738,35 @@ static void pk_vector_push_back(struct json_parser* ptr_parser,
  * 
  * @param ptr_parser Pointer to parser.
  * @param level Level at which the parent is requested.
- * @return A parent key (string pointer) at given level.
+ * @param ptr_id Id of the parent key at given level.
+ * @return Option instance. Error PARSER_ERROR is returned if
+ *         no parent key is set at the level, e.g. a terminal
+ *         follows a key without colon.
  */
-static struct abel_string* pk_vector_at(struct json_parser* ptr_parser,
-                                        size_t level)
+static struct abel_return_option pk_vector_at(struct json_parser* ptr_parser,
+                                              size_t level, size_t* ptr_id)
 {
-    struct abel_string* ptr
-            = abel_vector_at(&ptr_parser->parent_key, level).pointer;
-    return ptr;
+    struct abel_return_option ret = abel_vector_at(&ptr_parser->parent_key, level);
+    if (ret.is_error == true) {
+        return parser_error(ptr_parser, "Parent key is missing.");
+    }
+    *ptr_id = (size_t)(uintptr_t)ret.pointer;
+    return ret;
 }
 
 /**
  * @brief Parent key vector - assign.
  * 
- * Assign a parent key to the given level. It also frees
- * the previous struct abel_string at the same level.
+ * Assign a parent key id to the given level.
  * 
  * @param ptr_parser Pointer to parser.
  * @param level Level to which the parent is assigned.
- * @param ref_str A pointer to struct abel_string instance.
+ * @param id Id of an interned parent key.
  */
 static void pk_vector_assign(struct json_parser* ptr_parser, size_t level,
-                             struct abel_string* ref_str)
+                             size_t id)
 {
-    struct abel_string* ptr_pk = abel_make_string_ptr(ref_str->ptr_array);
-    struct abel_return_option ret
-            = abel_vector_emplace(&ptr_parser->parent_key, level, ptr_pk);
-    /* free the previous key string ptr */
-    if (ret.is_okay && ret.pointer != NULL) { // free the previous key string
-        abel_free_string_ptr(ret.pointer);
-    }
+    abel_vector_emplace(&ptr_parser->parent_key, level, (void*)(uintptr_t)id);
 }
 
 /**
@@ -687,12 +778,6 @@ static void pk_vector_assign(struct json_parser* ptr_parser, size_t level,
  */
 static void free_pk_vector(struct json_parser* ptr_parser)
 {
-    size_t pk_len = pk_vector_size(ptr_parser);
-    struct abel_string* ptr_str = NULL;
-    for (int i = 0; i < pk_len; i++) {
-        ptr_str = pk_vector_at(ptr_parser, i);
-        abel_free_string_ptr(ptr_str);
-    }
     abel_free_vector(&ptr_parser->parent_key);
 }
 
@@ -702,57 +787,54 @@ static void free_pk_vector(struct json_parser* ptr_parser)
  * In the following I use `kpl_vector_` prefix to mark all
  * functions for this vector.
  * 
- * @brief Keys per level is a 2D vector. In the first dimension,
- *        each element is a pointer to a (sub)vector. The element
- *        in each subvector is a pointer to a JSON key token stored
- *        in the token vector. This design synchronises the keys
- *        in token vector and this one. When freeing the kpl vector
- *        there is no need to separately free the key tokens (pointers)
- *        stored here, as they are freed whilst freeing the token
- *        vector.
+ * @brief Keys per level is a vector of maps. Each element is
+ *        a pointer to the map that collects the keys of the
+ *        dictionary open at that level. As at most one
+ *        dictionary is open per level, the map is cleared once
+ *        the dictionary closes, and memory is bounded by the
+ *        dictionaries being open rather than the document.
+ *        Map doesn't refer to any token, so it works whether
+ *        or not the token vector is kept.
  * 
- * kpl_vector_init : struct abel_vector initialised to [[]]
+ * kpl_vector_init : struct abel_vector initialised to [{}]
  * 
- * kpl_vector_size : Total number of elements in the first
- *     dimension, i.e. total number of subvectors.
+ * kpl_vector_size : Total number of levels, i.e. total
+ *     number of maps.
  * 
- * kpl_vector_at : Returns the subvector at the given level.
+ * kpl_vector_at : Returns the map at the given level.
  * 
  * kpl_vector_new_level : Create a new level, i.e. pushing back
- *     a new subvector, in the vector.
+ *     a new map, in the vector.
  * 
- * kpl_vector_last : Returns the pointer to the last subvector.
+ * kpl_vector_insert_at : Inserts a key into the map at the
+ *     given level.
  * 
- * kpl_vector_push_back_at : Pushes back a key-token pointer
- *     into the subvector at the given level.
+ * kpl_vector_clear_at : Clears the map at the given level.
  * 
- * kpl_vector_push_back_last : Pushes back a key-token pointer
- *     into the last subvector.
+ * free_kpl_vector : Freer.
  */
 
 /**
  * @brief Keys-per-level vector - init.
  * 
  * Initialises the kpl vector by pushing back an empty
- * (sub)vector as its first element. Note that kpl vector
- * is a 2D vector.
+ * map as its first element.
  * 
  * @param ptr_parser Pointer to parser.
  */
 static void kpl_vector_init(struct json_parser* ptr_parser)
 {
-    struct abel_vector* ptr = abel_make_vector_ptr(0);
+    struct abel_map* ptr = abel_make_map_ptr();
     abel_vector_append(&ptr_parser->keys_per_level, ptr);
 }
 
 /**
  * @brief Keys-per-level vector - size.
  * 
- * The total number of subvectors in the kpl vector, i.e.
- * the size of the first dimension.
+ * The total number of maps in the kpl vector.
  * 
  * @param ptr_parser Pointer to parser.
- * @return Total number of subvectors.
+ * @return Total number of maps.
  */
 static size_t kpl_vector_size(struct json_parser* ptr_parser)
 {
@@ -762,94 +844,73 @@ static size_t kpl_vector_size(struct json_parser* ptr_parser)
 /**
  * @brief Keys-per-level - at.
  * 
- * Returns the subvector at given level.
+ * Returns the map at given level.
  * 
  * @param ptr_parser Pointer to parser.
- * @param level Level for which the subvector is requested.
+ * @param level Level for which the map is requested.
  */
-static struct abel_vector* kpl_vector_at(struct json_parser* ptr_parser,
-                                         size_t level)
+static struct abel_map* kpl_vector_at(struct json_parser* ptr_parser,
+                                      size_t level)
 {
-    struct abel_vector* ptr
-            = abel_vector_at(&ptr_parser->keys_per_level, level).pointer;
-    return ptr;
+    return ptr_parser->keys_per_level.ptr_array[level];
 }
 
 /**
  * @brief Keys-per-level vector - create a new level
  * 
- * It pushes back a vector pointer into the current
+ * It pushes back a map pointer into the current
  * kpl vector and is thus creating a new level.
  * 
  * @param ptr_parser Pointer to parser.
- * @return The pointer to the newly added vector.
+ * @return The pointer to the newly added map.
  */
-static struct abel_vector* kpl_vector_new_level(struct json_parser* ptr_parser)
+static struct abel_map* kpl_vector_new_level(struct json_parser* ptr_parser)
 {
-    struct abel_vector* ptr = abel_make_vector_ptr(0);
+    struct abel_map* ptr = abel_make_map_ptr();
     abel_vector_append(&ptr_parser->keys_per_level, ptr);
     return ptr;
 }
 
 /**
- * @brief Keys-per-level vector - last subvector
+ * @brief Keys-per-level - inserts a key into given level
  * 
- * Returns the pointer to the last subvector.
+ * Levels up to the given one are created if they don't
+ * exist yet.
  * 
  * @param ptr_parser Pointer to parser.
- * @return Pointer to the last subvector.
+ * @param level Level at which the key is inserted.
+ * @param key Key as C string.
+ * @return Option instance returned by the map insertion.
+ *         Error KEY_EXISTS is returned if the key has been
+ *         inserted into the dictionary before.
  */
-static struct abel_vector* kpl_vector_last(struct json_parser* ptr_parser)
-{
-    struct abel_return_option ret
-            = abel_vector_back(&ptr_parser->keys_per_level);
-    struct abel_vector* ptr_vector = NULL;
-    if (ret.is_okay == true) {
-        ptr_vector = ret.pointer;
-    } else {
-        ptr_vector = NULL;
-    }
-    return ptr_vector;
-}
-
-/**
- * @brief Keys-per-level - pushes a token into given subvector
- * 
- * Pushes back a key-token pointer into the subvector at the
- * given level.
- * 
- * @param ptr_parser Pointer to parser.
- * @param level Level at which the token is pushed into.
- * @param ref_token Pointer to the token which is to be stored
- *                  in this vector.
- */
-static struct abel_return_option kpl_vector_push_back_at(
+static struct abel_return_option kpl_vector_insert_at(
     struct json_parser* ptr_parser,
     const size_t level,
-    const json_token_ptr ref_token)
+    const char* key)
 {
-    struct abel_return_option ret;
-    struct abel_vector* ptr_subvector = kpl_vector_at(ptr_parser, level);
-    ret = abel_vector_append(ptr_subvector, ref_token);
-    return ret;
+    while (kpl_vector_size(ptr_parser) <= level) {
+        kpl_vector_new_level(ptr_parser);
+    }
+    return abel_map_insert(kpl_vector_at(ptr_parser, level), (char*)key, NULL);
 }
 
 /**
- * @brief Keys-per-level - pushes a token into last subvector
+ * @brief Keys-per-level - clears given level
  * 
- * Pushes back a key-token pointer into the last subvector.
+ * Called when the dictionary at the given level closes. The
+ * map is cleared in place and reused by the next dictionary
+ * at the same level.
  * 
  * @param ptr_parser Pointer to parser.
- * @param ref_token Pointer to the token which is to be stored
- *                  in the last subvector.
+ * @param level Level of the keys of the closing dictionary.
  */
-static struct abel_return_option kpl_vector_push_back_last(
-        struct json_parser* ptr_parser, json_token_ptr ref_token)
+static void kpl_vector_clear_at(struct json_parser* ptr_parser,
+                                const size_t level)
 {
-    struct abel_return_option ret;
-    struct abel_vector* ptr_subvector = kpl_vector_last(ptr_parser);
-    ret = abel_vector_append(ptr_subvector, ref_token);
-    return ret;
+    if (level < kpl_vector_size(ptr_parser)) {
+        abel_map_clear(kpl_vector_at(ptr_parser, level));
+    }
 }
 
 /**
@@ -858,18 +919,15 @@ static struct abel_return_option kpl_vector_push_back_last(
  * Frees the resource held by kpl vector.
  * 
  * @param ptr_parser Pointer to parser.
- * @note Do not free the token pointers stored in subvectors,
- *       as they are already freed whilst freeing the token
- *       vector.
  */
 static void free_kpl_vector(struct json_parser* ptr_parser)
 {
     size_t vector_size = abel_vector_size(&ptr_parser->keys_per_level);
-    struct abel_vector* ptr_subvector = NULL;
+    struct abel_map* ptr_map = NULL;
     for (size_t i = 0; i < vector_size; i++) {
-        ptr_subvector = abel_vector_get(&ptr_parser->keys_per_level, i).pointer;
-        if (ptr_subvector != NULL) {
-            abel_free_vector_ptr(ptr_subvector);
+        ptr_map = abel_vector_get(&ptr_parser->keys_per_level, i).pointer;
+        if (ptr_map != NULL) {
+            abel_free_map_ptr(ptr_map);
         }
     }
     abel_free_vector(&ptr_parser->keys_per_level);
@@ -901,7 +959,7 @@ static void free_kpl_vector(struct json_parser* ptr_parser)
 static Bool is_first_noncomment_character(struct json_parser* ptr_parser)
 {
     return (abel_string_eq_cstring(&ptr_parser->current_literal, "") == true
-            && abel_vector_size(&ptr_parser->token_vector) == 0);
+            && token_vector_size(ptr_parser) == 0);
 }
 
 /**
@@ -915,12 +973,10 @@ static struct abel_return_option illegal_first_noncomment_character(
         struct json_parser* ptr_parser, char* first_char)
 {
     struct abel_return_option ret;
-    struct abel_error err;
     char errmsg[64] = "Symbol '";
     strcat(errmsg, first_char);
     strcat(errmsg, "' cannot be the first character in JSON format.");
-    err = error_parser_error(errmsg, ptr_parser->current_line);
-    ret = abel_option_error(err);
+    ret = parser_error(ptr_parser, errmsg);
     return ret;
 }
 
@@ -929,40 +985,25 @@ static struct abel_return_option illegal_first_noncomment_character(
  * 
  * JSON doesn't allow indetical keys in the same level of
  * a dictionary. This function checks keys-per-level vector
- * to identify duplicate.
+ * to identify duplicate, and collects the key if it is not.
+ * 
+ * @param ptr_parser Pointer to parser.
+ * @param key Key as C string.
+ * @param errmsg Buffer of the caller that receives the error
+ *        message, if any.
+ * @param errmsg_size Size of the buffer.
  */
 static struct abel_return_option report_duplicate_key(
-        struct json_parser* ptr_parser, struct json_token* token)
+        struct json_parser* ptr_parser, const char* key,
+        char* errmsg, size_t errmsg_size)
 {
     struct abel_return_option ret = abel_option_okay(NULL);
-    struct abel_error err;
-    Bool is_duplicate = false;
-    char errmsg[128] = "\0";
-    if (kpl_vector_size(ptr_parser) <= (size_t)ptr_parser->current_level) {
-        /* Keys at this level don't exist, add a new level and collect it. */ 
-        kpl_vector_new_level(ptr_parser);
-        kpl_vector_push_back_last(ptr_parser, token);
-    } else {
-        struct abel_vector* ptr_subvector = kpl_vector_at(ptr_parser,
-                                                 ptr_parser->current_level);
-        size_t veclen = abel_vector_size(ptr_subvector);
-        for (size_t i = 0; i < veclen; i++) {
-            json_token_ptr ptr_token_in = abel_vector_at(ptr_subvector, i).pointer;
-            if (abel_string_eq(ptr_token_in->parent_key, token->parent_key) == true
-                    && abel_string_eq(ptr_token_in->literal, token->literal) == true)
-            {
-                is_duplicate = true;
-                strcat(errmsg, "Key '");
-                strcat(errmsg, (token->literal)->ptr_array);
-                strcat(errmsg, "' is a duplicate.");
-            }
-        }
-        if (is_duplicate == false) {
-            /* If no duplicate, collect the key. */ 
-            kpl_vector_push_back_at(ptr_parser, ptr_parser->current_level, token);
+    ret = kpl_vector_insert_at(ptr_parser, ptr_parser->current_level, key);
+    if (ret.is_error == true) {
+        if (ret.error.error_type == KEY_EXISTS) {
+            snprintf(errmsg, errmsg_size, "Key '%s' is a duplicate.", key);
         } else {
-            err = error_parser_error(errmsg, ptr_parser->current_line);
-            ret = abel_option_error(err);
+            snprintf(errmsg, errmsg_size, "%s", ret.error.msg);
         }
     }
     return ret;
@@ -984,7 +1025,6 @@ static struct abel_return_option report_duplicate_key(
 static struct abel_return_option push_key_token(struct json_parser* ptr_parser)
 {
     struct abel_return_option ret;
-    struct abel_error err;
     char errmsg[128] = "\0";
     /* Preliminary checks */
     if (get_current_container_type(ptr_parser) != DICT) {
@@ -992,8 +1032,7 @@ static struct abel_return_option push_key_token(struct json_parser* ptr_parser)
         strcat(errmsg, "Key is not in a dictionary.");
     } else {
         /* previous token cannot be key */
-        if (token_vector_size(ptr_parser) > 0
-                && token_vector_last(ptr_parser)->type == KEY) {
+        if (token_vector_last_type(ptr_parser) == KEY) {
             strcat(errmsg, "Key cannot follow a key immediately.");
         }
     }
@@ -1001,35 +1040,46 @@ static struct abel_return_option push_key_token(struct json_parser* ptr_parser)
     if (strcmp(errmsg, "") == 0) {
         /* Important: JSON keys must be all in delimited scheme */
         if (ptr_parser->current_literal_scheme == DELIMITED) {
-            struct json_token key_token = tokenize_key(
-                &ptr_parser->current_literal,
-                pk_vector_at(ptr_parser, ptr_parser->current_level),
-                ptr_parser->current_level,
-                ptr_parser->current_line,
-                get_current_container_type(ptr_parser),
-                ptr_parser->current_literal_scheme);
-            /* TODO This may report error which must be propagated. */    
-            json_token_ptr ptr_token
-                    = token_vector_push_back(ptr_parser, &key_token).pointer;
-            /* Must check duplicate key.*/
-            ret = report_duplicate_key(ptr_parser, ptr_token);
-            /* If no duplicate key, set parent key for the next level. */
+            /* Must check duplicate key before pushing.*/
+            ret = report_duplicate_key(ptr_parser,
+                    abel_string_cstr(&ptr_parser->current_literal),
+                    errmsg, sizeof(errmsg));
+            /* If no duplicate key, push the key token and set parent key
+             * for the next level. */
+            size_t parent_key_id = 0;
+            if (ret.is_okay == true) {
+                ret = pk_vector_at(ptr_parser, ptr_parser->current_level,
+                                   &parent_key_id);
+                if (ret.is_error == true) {
+                    snprintf(errmsg, sizeof(errmsg), "%s", ret.error.msg);
+                }
+            }
             if (ret.is_okay == true) {
+                struct json_token key_token = tokenize_key(
+                    json_slice_append(&ptr_parser->literal_pool,
+                                      abel_string_cstr(&ptr_parser->current_literal),
+                                      ptr_parser->current_literal.length),
+                    parent_key_id,
+                    ptr_parser->current_level,
+                    ptr_parser->current_line,
+                    get_current_container_type(ptr_parser),
+                    ptr_parser->current_literal_scheme);
+                /* TODO This may report error which must be propagated. */    
+                token_vector_push_back(ptr_parser, &key_token);
+                size_t pk_id = intern_parent_key(ptr_parser,
+                        abel_string_cstr(&ptr_parser->current_literal));
                 if (pk_vector_size(ptr_parser) >= ptr_parser->current_level + 2)
                 {
                     pk_vector_assign(ptr_parser, ptr_parser->current_level + 1,
-                                     &ptr_parser->current_literal);
+                                     pk_id);
                 } else {
                     /* This key becomes the parent key for the next level. */
-                    pk_vector_push_back(ptr_parser, &ptr_parser->current_literal);
+                    pk_vector_push_back(ptr_parser, pk_id);
                 }
-            } else {
-                /* Collect error due to duplicate key check. */
-                strcat(errmsg, ret.error.msg);
-            }
+            }    /* else error of duplicate key check is in errmsg */
         } else {
             strcat(errmsg, "JSON does'nt accept unquoted key '");
-            strcat(errmsg, (ptr_parser->current_literal).ptr_array);
+            strcat(errmsg, abel_string_cstr(&ptr_parser->current_literal));
             strcat(errmsg, "'.");
         }
     }
@@ -1055,8 +1105,7 @@ static struct abel_return_option push_key_token(struct json_parser* ptr_parser)
         ret = abel_option_okay(NULL);
     } else {
         /* if error, report */
-        err = error_parser_error(errmsg, ptr_parser->current_line);
-        ret = abel_option_error(err);
+        ret = parser_error(ptr_parser, errmsg);
     }
     return ret;
 }
@@ -1076,28 +1125,35 @@ static struct abel_return_option per_iterable_container(
         struct json_parser* ptr_parser)
 {
     struct abel_return_option ret = abel_option_okay(NULL);
+    size_t parent_key_id = 0;
     if (is_current_container_iterable(ptr_parser) == true) {
         if (cii_vector_size(ptr_parser) == 0) {
             cii_vector_append(ptr_parser, 0);
         }
+        ret = pk_vector_at(ptr_parser, ptr_parser->current_level, &parent_key_id);
+        if (ret.is_error == true) {
+            return ret;
+        }
         struct abel_string name_string = abel_string_from_int(
             cii_vector_at(ptr_parser, ptr_parser->current_level)
         );
         struct json_token iter_key_token = tokenize_iter_key(
-            &name_string,
-            pk_vector_at(ptr_parser, ptr_parser->current_level),
+            json_slice_append(&ptr_parser->literal_pool,
+                              abel_string_cstr(&name_string), name_string.length),
+            parent_key_id,
             ptr_parser->current_level,
             ptr_parser->current_line,
             get_current_container_type(ptr_parser),
             cii_vector_at(ptr_parser, ptr_parser->current_level)
         );
         ret = token_vector_push_back(ptr_parser, &iter_key_token);
-        /* update parent key */
+        /* update parent key, iter index is kept in the id itself */
+        size_t pk_id = JSON_TOKEN_ITER_KEY_ID
+                | cii_vector_at(ptr_parser, ptr_parser->current_level);
         if (pk_vector_size(ptr_parser) >= ptr_parser->current_level + 2) {
-            pk_vector_assign(ptr_parser, ptr_parser->current_level + 1,
-                             &name_string);
+            pk_vector_assign(ptr_parser, ptr_parser->current_level + 1, pk_id);
         } else {
-            pk_vector_push_back(ptr_parser, &name_string);
+            pk_vector_push_back(ptr_parser, pk_id);
         }
         /* Must free the temporary name string */
         abel_free_string(&name_string);
@@ -1119,17 +1175,14 @@ static struct abel_return_option per_terminal_token(
         struct json_parser* ptr_parser)
 {
     struct abel_return_option ret;
-    struct abel_error err;
     char errmsg[128] = "\0";
-    json_token_ptr ptr_last_token = token_vector_last(ptr_parser);
-    enum json_token_type last_token_type = ptr_last_token->type;
+    enum json_token_type last_token_type = token_vector_last_type(ptr_parser);
     if ( !(last_token_type == KEY || last_token_type == ITER_KEY) ) {
         strcat(errmsg, "Terminal isn't preceeded by key or iter key.");
-        err = error_parser_error(errmsg, ptr_parser->current_line);
-        ret = abel_option_error(err);
+        ret = parser_error(ptr_parser, errmsg);
     } else {
         /* update previous key's referenced type */
-        abel_string_assign(ptr_last_token->referenced_type, "Terminal");   
+        token_vector_set_last_referenced_type(ptr_parser, "Terminal");
         ret = abel_option_okay(NULL);
     }
     return ret;
@@ -1177,22 +1230,23 @@ static TermTypeOption get_terminal_type(struct json_parser* ptr_parser,
     /* return */
     enum json_terminal_type terminal_type = STRING_TERM;
     /* make a copy of the literal */
-    struct abel_string literal_copied = abel_make_string(literal->ptr_array);
+    struct abel_string literal_copied = abel_make_string(
+                                            abel_string_cstr(literal));
     if (scheme == LIBERAL) {
-        if (is_null(literal_copied.ptr_array) ==true) {
+        if (is_null(abel_string_cstr(&literal_copied)) ==true) {
             terminal_type = NULL_TERM;
-        } else if (is_bool(literal_copied.ptr_array) == true) {
+        } else if (is_bool(abel_string_cstr(&literal_copied)) == true) {
             terminal_type = BOOL_TERM;
-        } else if (is_double(literal_copied.ptr_array) == true) {
+        } else if (is_double(abel_string_cstr(&literal_copied)) == true) {
             terminal_type = DOUBLE_TERM;
         } else {
             strcat(errmsg, "Type of unquoted string '");
-            strcat(errmsg, literal->ptr_array);
+            strcat(errmsg, abel_string_cstr(literal));
             strcat(errmsg, "' cannot be recognised.");
         }
     } else if (scheme == NONE_SCHEME) {
         strcat(errmsg, "Collection scheme of '");
-        strcat(errmsg, literal->ptr_array);
+        strcat(errmsg, abel_string_cstr(literal));
         strcat(errmsg, "' is not set.");
     } else {
         /* delimited string is always considered as string */
@@ -1224,14 +1278,21 @@ static struct abel_return_option push_terminal_token(
         struct json_parser* ptr_parser)
 {
     struct abel_return_option ret;
+    size_t parent_key_id = 0;
     ret = per_iterable_container(ptr_parser);
+    if (ret.is_okay == true) {
+        ret = pk_vector_at(ptr_parser, ptr_parser->current_level + 1,
+                           &parent_key_id);
+    }
     if (ret.is_okay == true) {
         TermTypeOption term_type_option = get_terminal_type(ptr_parser,
                 &ptr_parser->current_literal, ptr_parser->current_literal_scheme);
         if (term_type_option.is_okay == true) {
             struct json_token terminal_token = tokenize_terminal(
-                &ptr_parser->current_literal,
-                pk_vector_at(ptr_parser, ptr_parser->current_level + 1),
+                json_slice_append(&ptr_parser->literal_pool,
+                                  abel_string_cstr(&ptr_parser->current_literal),
+                                  ptr_parser->current_literal.length),
+                parent_key_id,
                 ptr_parser->current_level,
                 ptr_parser->current_line,
                 get_current_container_type(ptr_parser),
@@ -1264,31 +1325,32 @@ static struct abel_return_option per_container_opening_token(
     struct abel_error err;
     char* msg = "";
     if (token_vector_size(ptr_parser) > 0) {
-        json_token_ptr ptr_last_token = token_vector_last(ptr_parser);
+        enum json_token_type last_token_type
+                = token_vector_last_type(ptr_parser);
         if (get_current_container_type(ptr_parser) == DICT) {
-            if (ptr_last_token->type != KEY) {
+            if (last_token_type != KEY) {
                 msg = "In dictionary, any object must be preceeded by a key.";
                 err = error_parser_error(msg, ptr_parser->current_line);
             } else {
             /* Update reference type according to the container to be created.*/
                 if (strcmp(opening_symbol, L_BRACE) == 0) {
-                    abel_string_assign(ptr_last_token->referenced_type, "Dict");
+                    token_vector_set_last_referenced_type(ptr_parser, "Dict");
                 } else if (strcmp(opening_symbol, L_BRACKET) == 0) {
-                    abel_string_assign(ptr_last_token->referenced_type, "List");
+                    token_vector_set_last_referenced_type(ptr_parser, "List");
                 }
             }
         }
         if (is_current_container_iterable(ptr_parser) == true) {
-            if (ptr_last_token->type != ITER_KEY) {
+            if (last_token_type != ITER_KEY) {
                 msg = "In iterable container, any object must be preceeded "
                       "by an iter key.";
                 err = error_parser_error(msg, ptr_parser->current_line);
             } else {
                 // TODO Make a function to update last token.
                 if (strcmp(opening_symbol, L_BRACE) == 0) {
-                    abel_string_assign(ptr_last_token->referenced_type, "Dict");
+                    token_vector_set_last_referenced_type(ptr_parser, "Dict");
                 } else if (strcmp(opening_symbol, L_BRACKET) == 0) {
-                    abel_string_assign(ptr_last_token->referenced_type, "List");
+                    token_vector_set_last_referenced_type(ptr_parser, "List");
                 }
             }
         }
@@ -1313,23 +1375,26 @@ static struct abel_return_option per_container_opening_token(
 static struct abel_return_option push_container_opening_token(
         struct json_parser* ptr_parser, char* opening_symbol)
 {
+    size_t parent_key_id = 0;
     struct abel_return_option ret = per_iterable_container(ptr_parser);
     if (ret.is_okay == true) {
         ret = per_container_opening_token(ptr_parser, opening_symbol);
         if (ret.is_okay == true) {
-            struct abel_string opening_symbol_str = abel_make_string(opening_symbol);
+            ret = pk_vector_at(ptr_parser, ptr_parser->current_level + 1,
+                               &parent_key_id);
+        }
+        if (ret.is_okay == true) {
             struct json_token opening_token = tokenize(
-                //opening_symbol,
-                &opening_symbol_str,
+                json_slice_append(&ptr_parser->literal_pool, opening_symbol,
+                                  strlen(opening_symbol)),
                 get_token_type_by_symbol(opening_symbol),
                 //parent_key[current_level + 1], // Note the level
-                pk_vector_at(ptr_parser, ptr_parser->current_level + 1),
+                parent_key_id,
                 ptr_parser->current_level,
                 ptr_parser->current_line,
                 get_current_container_type(ptr_parser) );
             /* TODO this may cause error too! */
             token_vector_push_back(ptr_parser, &opening_token);
-            abel_free_string(&opening_symbol_str);
         }
     }
     return ret;
@@ -1345,23 +1410,31 @@ static struct abel_return_option push_container_opening_token(
 static struct abel_return_option push_container_closing_token(
         struct json_parser* ptr_parser, char* closing_symbol)
 {
-    struct abel_return_option ret = abel_option_okay(NULL);
+    size_t parent_key_id = 0;
+    struct abel_return_option ret
+            = pk_vector_at(ptr_parser, ptr_parser->current_level, &parent_key_id);
+    if (ret.is_error == true) {
+        return ret;
+    }
     /* Before pushing closing token, must adjust the iter-key at this level. */
     if (get_current_container_type(ptr_parser) == LIST) {
         cii_vector_emplace(ptr_parser, ptr_parser->current_level, 0);
     }
-    struct abel_string closing_symbol_str = abel_make_string(closing_symbol);
+    /* Keys of a closing dict can't be duplicated any more. */
+    if (get_current_container_type(ptr_parser) == DICT) {
+        kpl_vector_clear_at(ptr_parser, ptr_parser->current_level);
+    }
     struct json_token closing_token = tokenize(
-        &closing_symbol_str,
+        json_slice_append(&ptr_parser->literal_pool, closing_symbol,
+                          strlen(closing_symbol)),
         get_token_type_by_symbol(closing_symbol),
-        pk_vector_at(ptr_parser, ptr_parser->current_level),
+        parent_key_id,
         ptr_parser->current_level - 1,
         ptr_parser->current_line,
         // Caution. Must use the container of the outer (higher) level, since
         // level switching is performed after pushing the closing token.
         cct_vector_at(ptr_parser, ptr_parser->current_level - 1));
     ret = token_vector_push_back(ptr_parser, &closing_token);
-    abel_free_string(&closing_symbol_str);
     return ret;
 }
 
@@ -1382,9 +1455,51 @@ static struct abel_return_option push_container_closing_token(
  * at_other_symbol
  * 
  * free_parser
- * parse_line
+ * parse_buffer_range
  **/
 
+/**
+ * @brief Character class
+ * 
+ * Each char is classified once by a table lookup, and the
+ * class selects the workflow function to be called.
+ */
+enum char_class {
+    OTHER_CHAR = 0,    /* default of table entries */
+    BACK_SLASH_CHAR,
+    DOUBLE_QUOTE_CHAR,
+    SPACE_CHAR,
+    SHARP_CHAR,
+    COLON_CHAR,
+    COMMA_CHAR,
+    OPENING_CHAR,
+    CLOSING_CHAR,
+    NEW_LINE_CHAR
+};
+
+/**
+ * @brief Character class table
+ * 
+ * Indexed by the unsigned value of a char. The entries must
+ * agree with the symbols defined in symbol.c and with the
+ * opening and closing symbols in json_token.c.
+ */
+static const unsigned char CHAR_CLASS_TABLE[256] = {
+    ['\\'] = BACK_SLASH_CHAR,
+    ['"'] = DOUBLE_QUOTE_CHAR,
+    [' '] = SPACE_CHAR,
+    ['#'] = SHARP_CHAR,
+    [':'] = COLON_CHAR,
+    [','] = COMMA_CHAR,
+    ['{'] = OPENING_CHAR,
+    ['['] = OPENING_CHAR,
+    ['('] = OPENING_CHAR,
+    ['}'] = CLOSING_CHAR,
+    [']'] = CLOSING_CHAR,
+    [')'] = CLOSING_CHAR,
+    ['\n'] = NEW_LINE_CHAR
+};
+
 /**
  * @brief Static - At back slash
  * 
@@ -1428,7 +1543,12 @@ static struct abel_return_option at_back_slash(struct json_parser* ptr_parser)
 static struct abel_return_option at_double_quotation(struct json_parser* ptr_parser)
 {
     struct abel_return_option retopt = abel_option_okay(NULL);
-    if (literal_is_empty(ptr_parser) == true) { /* current literal is empty */
+    if (ptr_parser->is_delimited_string_open == true
+            && ptr_parser->is_escaping == true) {
+        /* escaped quote is a char, also as the first one of string */
+        literal_append(ptr_parser, (char*)DOUBLE_QUOTE);
+        ptr_parser->is_escaping = false;
+    } else if (literal_is_empty(ptr_parser) == true) { /* current literal is empty */
         if (ptr_parser->is_delimited_string_open == false) {
             /* not in a delimited string */
             ptr_parser->is_delimited_string_open = true;
@@ -1441,14 +1561,10 @@ static struct abel_return_option at_double_quotation(struct json_parser* ptr_par
         }
     } else { /* current literal is non-empty */
         if (ptr_parser->is_delimited_string_open == true) { // a delimited string has opened...
-            if (ptr_parser->is_escaping == true) { // previous char is escaping
-                literal_append(ptr_parser, (char*)DOUBLE_QUOTE);
-                ptr_parser->is_escaping = false; // turn off flag
-            } else { // then double quote is a string-closing operator
-                ptr_parser->is_delimited_string_open = false;
-                abel_string_assign(&ptr_parser->latest_syntactic_operator,
-                                   (char*)DOUBLE_QUOTE);
-            }
+            /* not escaped, double quote is a string-closing operator */
+            ptr_parser->is_delimited_string_open = false;
+            abel_string_assign(&ptr_parser->latest_syntactic_operator,
+                               (char*)DOUBLE_QUOTE);
         } else {    // delimited string is not open
             if (ptr_parser->current_literal_scheme == LIBERAL) {
                 literal_append(ptr_parser, (char*)DOUBLE_QUOTE);
@@ -1492,7 +1608,6 @@ static struct abel_return_option at_space(struct json_parser* ptr_parser)
 static struct abel_return_option at_colon(struct json_parser* ptr_parser)
 {
     struct abel_return_option retopt;
-    struct abel_error err;
     char errmsg[128] = "\0";
     if (ptr_parser->is_delimited_string_open == true) {    /* part of literal */
         literal_append(ptr_parser, (char*)COLON);
@@ -1515,8 +1630,7 @@ static struct abel_return_option at_colon(struct json_parser* ptr_parser)
             }
             /* make return option */
             if (strcmp(errmsg, "") != 0) {
-                err = error_parser_error(errmsg, ptr_parser->current_line);
-                retopt = abel_option_error(err);
+                retopt = parser_error(ptr_parser, errmsg);
             }
         }
 
@@ -1547,7 +1661,6 @@ static struct abel_return_option at_colon(struct json_parser* ptr_parser)
 static struct abel_return_option at_comma(struct json_parser* ptr_parser)
 {
     struct abel_return_option ret = abel_option_okay(NULL);
-    struct abel_error err;
     char errmsg[128] = "\0";
     if (ptr_parser->is_delimited_string_open == true) {
         literal_append(ptr_parser, (char*)COMMA);
@@ -1563,8 +1676,7 @@ static struct abel_return_option at_comma(struct json_parser* ptr_parser)
             {    
                 strcat(errmsg, "Comma appears only after a terminal, "
                                "a string, or a container closing operator.");
-                err = error_parser_error(errmsg, ptr_parser->current_line);
-                ret = abel_option_error(err);
+                ret = parser_error(ptr_parser, errmsg);
             }
         }
 
@@ -1584,12 +1696,11 @@ static struct abel_return_option at_comma(struct json_parser* ptr_parser)
         }
         /* Must perform Post-pushing check */
         enum json_token_type last_token_type
-                = token_vector_last(ptr_parser)->type;
+                = token_vector_last_type(ptr_parser);
         if ( !(last_token_type == TERMINAL || last_token_type == DICT_CLOSING
                 || last_token_type == LIST_CLOSING) ) {
             strcat(errmsg, "Comma is meaningless.");
-            err = error_parser_error(errmsg, ptr_parser->current_line);
-            ret = abel_option_error(err);
+            ret = parser_error(ptr_parser, errmsg);
         }
         abel_string_append(&ptr_parser->latest_syntactic_operator, (char*)COMMA);
     }
@@ -1618,9 +1729,10 @@ static struct abel_return_option at_container_opening(
                 set_root_container_type(ptr_parser, LIST);
             }
             /* only one parent key so far */
-            if (pk_vector_size(ptr_parser) == 1) {
-                pk_vector_push_back( ptr_parser,
-                        pk_vector_at(ptr_parser, ptr_parser->current_level) );
+            size_t root_key_id = 0;
+            if (pk_vector_size(ptr_parser) == 1
+                    && pk_vector_at(ptr_parser, 0, &root_key_id).is_okay == true) {
+                pk_vector_push_back(ptr_parser, root_key_id);
             }
         }
         // TODO Implement bracket match
@@ -1661,6 +1773,9 @@ static struct abel_return_option at_container_closing(
     struct abel_return_option ret = abel_option_okay(NULL);
     if (ptr_parser->is_delimited_string_open == true) {
         literal_append(ptr_parser, closing_symbol);
+    } else if (ptr_parser->current_level == 0) {
+        /* no container is open, e.g. an extra closing symbol */
+        ret = parser_error(ptr_parser, "Closing symbol has no opening symbol.");
     } else {
         if ( is_first_noncomment_character(ptr_parser) ) {
             illegal_first_noncomment_character(ptr_parser, closing_symbol);
@@ -1673,7 +1788,9 @@ static struct abel_return_option at_container_closing(
             ret = push_terminal_token(ptr_parser);
             literal_reset(ptr_parser);
         }
-        ret = push_container_closing_token(ptr_parser, closing_symbol);
+        if (ret.is_okay == true) {
+            ret = push_container_closing_token(ptr_parser, closing_symbol);
+        }
         // FIXME The following iter-key adjustment doesn't seem to work.
         if (get_parent_container_type(ptr_parser) == LIST) {
             cii_vector_emplace(ptr_parser, ptr_parser->current_level, 0);
@@ -1683,6 +1800,9 @@ static struct abel_return_option at_container_closing(
                                parent_level_iter_index + 1);
         }
         ptr_parser->current_level -= 1;
+        if (ptr_parser->current_level == 0) {
+            ptr_parser->is_root_closed = true;
+        }
         abel_string_assign(&ptr_parser->latest_syntactic_operator, closing_symbol);
 
     }
@@ -1699,7 +1819,6 @@ static struct abel_return_option at_other_symbol(struct json_parser* ptr_parser,
                                                  char* current_char)
 {
     struct abel_return_option ret = abel_option_okay(NULL);
-    struct abel_error err;
     char errmsg[128] = "\0";
     /* Current literal is empty, new literal collection starts */ 
     if (literal_is_empty(ptr_parser) == true) {
@@ -1720,8 +1839,7 @@ static struct abel_return_option at_other_symbol(struct json_parser* ptr_parser,
                one is not allowed. */
             strcat(errmsg, "Appending a liberal string to a "
                            "delimited one is not allowed.");
-            err = error_parser_error(errmsg, ptr_parser->current_line);
-            ret = abel_option_error(err);
+            ret = parser_error(ptr_parser, errmsg);
         } else {
             /* TODO there is a bug! */
             literal_append(ptr_parser, current_char);
@@ -1740,55 +1858,291 @@ static void free_parser(struct json_parser* ptr_parser)
     /* free a vector of strings */
     free_cii_vector(ptr_parser);
     free_pk_vector(ptr_parser);
+    free_parent_key_table(ptr_parser);
     free_kpl_vector(ptr_parser);
     abel_free_string(&ptr_parser->latest_syntactic_operator);
+    abel_free_string(&ptr_parser->literal_pool);
 }
 
 /**
- * @brief Static - Line parser.
+ * Static functions for bulk scanning
+ * 
+ * Most chars inside a delimited string and most spaces in
+ * a pretty-printed file don't change the state of parser.
+ * Before dispatching a char, the scanner measures the run
+ * of such chars starting from it and consumes the run in
+ * one step.
  * 
- * Line parser processes and parses a line char by char.
+ * A run is measured in blocks of 32 (AVX2) or 16 (SSE2)
+ * bytes, comparing all bytes of a block at once. Version
+ * is selected once per process according to cpuid, when
+ * the first parser is made. The
+ * scalar version is used on the other platforms, and for
+ * the tail of a buffer shorter than a block.
+ * 
+ * string_run_length
+ * space_run_length
+ **/
+
+/**
+ * @brief Static - Is char a stop inside delimited string
+ * 
+ * Back slash and double quote change the state of string.
+ * New line is counted by the scanner. Null char is a stop
+ * only because a literal cannot hold it.
+ */
+static Bool is_string_stop(char c)
+{
+    return (c == '"' || c == '\\' || c == '\n' || c == '\0');
+}
+
+static size_t string_run_length_scalar(const char* buffer, size_t length)
+{
+    size_t pos = 0;
+    while (pos < length && is_string_stop(buffer[pos]) == false) {
+        pos++;
+    }
+    return pos;
+}
+
+static size_t space_run_length_scalar(const char* buffer, size_t length)
+{
+    size_t pos = 0;
+    while (pos < length && buffer[pos] == ' ') {
+        pos++;
+    }
+    return pos;
+}
+
+#ifdef ABEL_SCAN_X86
+static size_t string_run_length_sse2(const char* buffer, size_t length)
+{
+    size_t pos = 0;
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i back_slash = _mm_set1_epi8('\\');
+    const __m128i new_line = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    for (; pos + 16 <= length; pos += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(buffer + pos));
+        __m128i stops = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                             _mm_cmpeq_epi8(block, back_slash)),
+                _mm_or_si128(_mm_cmpeq_epi8(block, new_line),
+                             _mm_cmpeq_epi8(block, zero)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(stops);
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return pos + string_run_length_scalar(buffer + pos, length - pos);
+}
+
+static size_t space_run_length_sse2(const char* buffer, size_t length)
+{
+    size_t pos = 0;
+    const __m128i space = _mm_set1_epi8(' ');
+    for (; pos + 16 <= length; pos += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(buffer + pos));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(
+                _mm_cmpeq_epi8(block, space)) & 0xFFFFu;
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return pos + space_run_length_scalar(buffer + pos, length - pos);
+}
+
+__attribute__((target("avx2")))
+static size_t string_run_length_avx2(const char* buffer, size_t length)
+{
+    size_t pos = 0;
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i back_slash = _mm256_set1_epi8('\\');
+    const __m256i new_line = _mm256_set1_epi8('\n');
+    const __m256i zero = _mm256_setzero_si256();
+    for (; pos + 32 <= length; pos += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(buffer + pos));
+        __m256i stops = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, quote),
+                                _mm256_cmpeq_epi8(block, back_slash)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, new_line),
+                                _mm256_cmpeq_epi8(block, zero)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(stops);
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return pos + string_run_length_sse2(buffer + pos, length - pos);
+}
+
+__attribute__((target("avx2")))
+static size_t space_run_length_avx2(const char* buffer, size_t length)
+{
+    size_t pos = 0;
+    const __m256i space = _mm256_set1_epi8(' ');
+    for (; pos + 32 <= length; pos += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(buffer + pos));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(block, space));
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return pos + space_run_length_sse2(buffer + pos, length - pos);
+}
+#endif
+
+/* Run-length functions selected once per process */
+static size_t (*selected_string_run_length)(const char*, size_t) = NULL;
+static size_t (*selected_space_run_length)(const char*, size_t) = NULL;
+#ifdef ABEL_ATOMIC_REF_COUNT
+static once_flag run_length_once = ONCE_FLAG_INIT;
+#endif
+
+/**
+ * @brief Static - Select run-length functions
+ * 
+ * Called once by the parser maker, so the selection is
+ * complete before any parser scans. If the library is built
+ * with ABEL_ATOMIC_REF_COUNT defined, it is called through
+ * `call_once`, such that parsers can be made in several
+ * threads at once.
+ */
+static void select_run_length_functions()
+{
+#ifdef ABEL_SCAN_X86
+    if (__builtin_cpu_supports("avx2")) {
+        selected_space_run_length = space_run_length_avx2;
+        selected_string_run_length = string_run_length_avx2;
+    } else {
+        selected_space_run_length = space_run_length_sse2;
+        selected_string_run_length = string_run_length_sse2;
+    }
+#else
+    selected_space_run_length = space_run_length_scalar;
+    selected_string_run_length = string_run_length_scalar;
+#endif
+}
+
+/**
+ * @brief Static - Length of a run inside delimited string
+ * 
+ * Returns the number of chars from the start of buffer up
+ * to the first stop char or the end of buffer.
+ */
+static size_t string_run_length(const char* buffer, size_t length)
+{
+    return selected_string_run_length(buffer, length);
+}
+
+/**
+ * @brief Static - Length of a run of spaces
+ */
+static size_t space_run_length(const char* buffer, size_t length)
+{
+    return selected_space_run_length(buffer, length);
+}
+
+/**
+ * @brief Static - Buffer scanner.
+ * 
+ * Scanner processes a buffer char by char. The buffer may
+ * hold any number of lines, or part of a line. The scanner
+ * itself keeps track of line and column: a new line char
+ * advances the line and resets the column, while the other
+ * chars advance the column in the workflow functions. A `#`
+ * outside of delimited string comments out the rest of the
+ * line. All states live in the parser, so a document can be
+ * fed to the scanner in consecutive ranges.
+ * 
+ * Runs of chars that only extend the literal of a delimited
+ * string, runs of spaces outside of it and comments are
+ * consumed in bulk before dispatching.
  * 
  * @todo Propagate and handle error.
  */
-static struct abel_return_option parse_line(struct json_parser* ptr_parser, char* line)
+static struct abel_return_option parse_buffer_range(
+        struct json_parser* ptr_parser, const char* buffer, size_t length)
 {
     struct abel_return_option retopt = abel_option_okay(NULL);
-    size_t raw_length = strlen(line);
-    while (ptr_parser->current_column < raw_length) {
-        /* convert char into C string */
-        char current_char[] = {line[ptr_parser->current_column], '\0'};
+    enum char_class current_class;
+    const char* ptr_new_line = NULL;
+    size_t run_length = 0;
+    for (size_t pos = 0; pos < length; pos++) {
+        if (ptr_parser->is_in_comment == true) {
+            /* skip to the new line that ends the comment */
+            ptr_new_line = memchr(buffer + pos, '\n', length - pos);
+            if (ptr_new_line == NULL) {
+                break;
+            }
+            pos = ptr_new_line - buffer;
+        } else if (ptr_parser->is_delimited_string_open == true) {
+            run_length = string_run_length(buffer + pos, length - pos);
+            if (run_length > 0) {
+                abel_string_append_n(&ptr_parser->current_literal,
+                                     buffer + pos, run_length);
+                ptr_parser->current_column += run_length;
+                pos += run_length - 1;
+                continue;
+            }
+        } else if (buffer[pos] == ' ') {
+            run_length = space_run_length(buffer + pos, length - pos);
+            ptr_parser->current_column += run_length;
+            pos += run_length - 1;
+            continue;
+        }
+        current_class = CHAR_CLASS_TABLE[(unsigned char)buffer[pos]];
+        if (current_class == NEW_LINE_CHAR) {    /* line is complete */
+            ptr_parser->current_line += 1;
+            ptr_parser->current_column = 0;
+            ptr_parser->is_in_comment = false;
+            continue;
+        }
+        /* an extra closing symbol is reported by at_container_closing */
+        if (ptr_parser->is_root_closed == true && current_class != SPACE_CHAR
+                && current_class != SHARP_CHAR && current_class != CLOSING_CHAR) {
+            retopt = parser_error(ptr_parser, "Content after root container.");
+            break;
+        }
+        /* workflow functions expect char as C string */
+        char current_char[] = {buffer[pos], '\0'};
         /* branching */
-        if (abel_cstring_eq(current_char, (char*)BACK_SLASH) == true) {
+        switch (current_class) {
+        case BACK_SLASH_CHAR:
             retopt = at_back_slash(ptr_parser);
-        } else if (abel_cstring_eq(current_char, (char*)DOUBLE_QUOTE) == true) {
+            break;
+        case DOUBLE_QUOTE_CHAR:
             retopt = at_double_quotation(ptr_parser);
-        } else if (abel_cstring_eq(current_char, (char*)SPACE) == true) {
+            break;
+        case SPACE_CHAR:
             retopt = at_space(ptr_parser);
-        } else if (abel_cstring_eq(current_char, (char*)SHARP) == true) {/* # comment */
+            break;
+        case SHARP_CHAR:    /* # comment */
             if (ptr_parser->is_delimited_string_open) {
                 literal_append(ptr_parser, current_char);
                 ptr_parser->current_column += 1;
-                continue;
             } else {
-                break;
+                ptr_parser->is_in_comment = true;
             }
-        } else if (abel_cstring_eq(current_char, (char*)COLON) == true) {
+            break;
+        case COLON_CHAR:
             retopt = at_colon(ptr_parser);
-        } else if (abel_cstring_eq(current_char, (char*)COMMA) == true) {
+            break;
+        case COMMA_CHAR:
             retopt = at_comma(ptr_parser);
-        } else if (is_opening_symbol(current_char) == true) {    /* opening */
+            break;
+        case OPENING_CHAR:
             retopt = at_container_opening(ptr_parser, current_char);
-        } else if (is_closing_symbol(current_char) == true) {    /* closing */
+            break;
+        case CLOSING_CHAR:
             retopt = at_container_closing(ptr_parser, current_char);
-        } else {    /* none of the above */
+            break;
+        default:    /* none of the above */
             retopt = at_other_symbol(ptr_parser, current_char);
-            //continue;
+            break;
         }
         /* error handling */
-        if (retopt.is_okay == true) {
-            continue;
-        } else {
+        if (retopt.is_okay == false) {
             break;
         }
     }
@@ -1796,16 +2150,18 @@ static struct abel_return_option parse_line(struct json_parser* ptr_parser, char
 }
 
 /**
- * @brief Exit parser gracefully
+ * @brief Static - Start scanning
  * 
- * Exiting parser due to error must be come after all resources
- * are freed to prevent memory leak. This is graceful shut down.
+ * Line number starts from 1 as soon as there is anything
+ * to be scanned.
  */
-static void safe_exit(struct json_parser* ptr_parser)
+static void start_scanning(struct json_parser* ptr_parser)
 {
-    free_parser(ptr_parser);
-
+    if (ptr_parser->current_line == 0) {
+        ptr_parser->current_line = 1;
+    }
 }
+
 /**
  * Public interface
  * 
@@ -1815,6 +2171,21 @@ static void safe_exit(struct json_parser* ptr_parser)
  *     JSON parser.
  * 
  * abel_parse_file : Parses a JSON file
+ * 
+ * abel_parse_buffer : Parses a JSON document in memory
+ * 
+ * abel_parse_file_mapped : Parses a memory-mapped JSON file
+ * 
+ * abel_parser_feed : Parses a chunk of a JSON document
+ * 
+ * abel_parser_finish : Checks that a fed document is complete
+ * 
+ * abel_json_parser_set_token_handler : Attaches a token
+ *     handler
+ * 
+ * abel_json_token_literal : Literal of a token
+ * 
+ * abel_json_token_parent_key : Parent key of a token
  **/
 
 /**
@@ -1824,7 +2195,14 @@ static void safe_exit(struct json_parser* ptr_parser)
  */
 void abel_make_json_parser(struct json_parser* ptr_parser)
 {
-    ptr_parser->token_vector = abel_make_vector(0);
+#ifdef ABEL_ATOMIC_REF_COUNT
+    call_once(&run_length_once, select_run_length_functions);
+#else
+    if (selected_string_run_length == NULL) {
+        select_run_length_functions();
+    }
+#endif
+    ptr_parser->token_vector = abel_make_token_tape();
     ptr_parser->current_line = 0;
     ptr_parser->current_column = 0;
     ptr_parser->current_literal = abel_make_string("");
@@ -1837,6 +2215,16 @@ void abel_make_json_parser(struct json_parser* ptr_parser)
     /* current iter index (cii) vector */
     ptr_parser->current_iter_index = abel_make_vector(0);
     cii_vector_init(ptr_parser);
+    /* literal pool and interned parent keys */
+    ptr_parser->literal_pool = abel_make_string("");
+    ptr_parser->parent_key_table = abel_make_vector(0);
+    ptr_parser->ptr_parent_key_ids = abel_make_map_ptr();
+    /* no token handler, tokens are kept */
+    ptr_parser->token_handler.ptr_context = NULL;
+    ptr_parser->token_handler.on_token = NULL;
+    ptr_parser->is_token_vector_kept = true;
+    ptr_parser->token_count = 0;
+    ptr_parser->last_token_type = UNKNOWN_TOKEN;
     /* parent key (pk) vector */
     ptr_parser->parent_key = abel_make_vector(0);
     pk_vector_init(ptr_parser);
@@ -1848,8 +2236,12 @@ void abel_make_json_parser(struct json_parser* ptr_parser)
     /* escaping and delimiting flags */
     ptr_parser->is_escaping = false;
     ptr_parser->is_delimited_string_open = false;
+    ptr_parser->is_in_comment = false;
+    ptr_parser->is_root_closed = false;
     /* literal scheme */
     ptr_parser->current_literal_scheme = NONE_SCHEME;
+    ptr_parser->error_message[0] = '\0';
+    ptr_parser->iter_key[0] = '\0';
     /* initiliase error register */
     //ptr_parser->error_register[0] = error_none();
 }
@@ -1858,39 +2250,227 @@ void abel_make_json_parser(struct json_parser* ptr_parser)
  * @brief File parser
  * 
  * File parser opens and parses a file. It reads the file
- * line by line and processes each line by calling the line
- * parser (static function `parse_line`).
- * 
- * @todo If file opening fails, 
+ * in chunks of JSON_PARSER_READ_CHUNK_SIZE bytes and feeds
+ * each chunk to the buffer scanner. Lines are thus no longer
+ * limited in length. Reading stops at the first error;
+ * otherwise the document is checked by `abel_parser_finish`.
  */
-void abel_parse_file(struct json_parser* ptr_parser, char* file_name)
+struct abel_return_option abel_parse_file(struct json_parser* ptr_parser,
+                                          char* file_name)
 {
-    FILE* file = fopen(file_name, "r");    // should check the result
-    char line[255];
-    struct abel_return_option retopt_line_parser = abel_option_okay(NULL);
+    FILE* file = NULL;
+    char* chunk = NULL;
+    size_t chunk_length = 0;
+    struct abel_return_option retopt = abel_option_okay(NULL);
 
-    while ( fgets(line, sizeof(line), file) ) {
-        /* note that fgets don't strip the terminating \n, checking its
-           presence would allow to handle lines longer that sizeof(line) */
-        size_t raw_length = strlen(line);    // may contain the newline char
-        if (line[raw_length - 1] == '\n') {
-            line[raw_length - 1] = '\0';
-        }
-        ptr_parser->current_line += 1;
-        ptr_parser->current_column = 0;
-        if (strlen(line) == 0) continue;
-        retopt_line_parser = parse_line(ptr_parser, line);
-        /* TODO check error and stop parsing */
-        if (retopt_line_parser.is_okay == true) {
-            continue;
-        } else {
-            safe_exit(ptr_parser);
+    file = fopen(file_name, "r");
+    if (file == NULL) {
+        return abel_option_error( error_parser_error("Failed to open file.", -1) );
+    }
+    chunk = malloc(JSON_PARSER_READ_CHUNK_SIZE);
+    if (chunk == NULL) {
+        fclose(file);
+        return abel_option_error( error_malloc_failure() );
+    }
+    while ( (chunk_length = fread(chunk, 1, JSON_PARSER_READ_CHUNK_SIZE, file)) > 0 ) {
+        retopt = abel_parser_feed(ptr_parser, chunk, chunk_length);
+        if (retopt.is_okay == false) {
+            break;
         }
     }
+    free(chunk);
     fclose(file);
+    if (retopt.is_okay == true) {
+        retopt = abel_parser_finish(ptr_parser);
+    }
+    return retopt;
+}
+
+struct abel_return_option abel_parse_buffer(struct json_parser* ptr_parser,
+                                            const char* buffer, size_t length)
+{
+    struct abel_return_option retopt = abel_parser_feed(ptr_parser, buffer, length);
+    if (retopt.is_okay == true) {
+        retopt = abel_parser_finish(ptr_parser);
+    }
+    return retopt;
+}
+
+struct abel_return_option abel_parser_feed(struct json_parser* ptr_parser,
+                                           const char* chunk, size_t length)
+{
+    start_scanning(ptr_parser);
+    return parse_buffer_range(ptr_parser, chunk, length);
+}
+
+struct abel_return_option abel_parser_finish(struct json_parser* ptr_parser)
+{
+    char* errmsg = NULL;
+    if (ptr_parser->token_count == 0) {
+        errmsg = "Document is empty.";
+    } else if (ptr_parser->is_delimited_string_open == true) {
+        errmsg = "Delimited string is not closed.";
+    } else if (ptr_parser->current_level > 0) {
+        errmsg = "Container is not closed.";
+    } else if (literal_is_empty(ptr_parser) == false) {
+        errmsg = "Literal is outside of root container.";
+    }
+    if (errmsg != NULL) {
+        return abel_option_error(
+            error_parser_error(errmsg, ptr_parser->current_line) );
+    }
+    return abel_option_okay(NULL);
+}
+
+struct abel_return_option abel_parse_file_mapped(struct json_parser* ptr_parser,
+                                                 const char* file_name)
+{
+    struct abel_return_option retopt = abel_option_okay(NULL);
+    struct stat file_stat;
+    void* ptr_mapped = NULL;
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        return abel_option_error( error_parser_error("Failed to open file.", -1) );
+    }
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return abel_option_error( error_parser_error("Failed to stat file.", -1) );
+    }
+    if (file_stat.st_size == 0) {    /* nothing to map */
+        close(fd);
+        return abel_parser_finish(ptr_parser);
+    }
+    ptr_mapped = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);    /* mapping stays valid after closing */
+    if (ptr_mapped == MAP_FAILED) {
+        return abel_option_error( error_parser_error("Failed to map file.", -1) );
+    }
+    retopt = abel_parse_buffer(ptr_parser, ptr_mapped, (size_t)file_stat.st_size);
+    munmap(ptr_mapped, (size_t)file_stat.st_size);
+    return retopt;
 }
 
 void abel_free_json_parser(struct json_parser* ptr_parser)
 {
     free_parser(ptr_parser);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Attach a token handler
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param handler Token handler.
+ * @param is_token_vector_kept False to drop tokens once they
+ *        are handled.
+ */
+void abel_json_parser_set_token_handler(struct json_parser* ptr_parser,
+                                        struct json_token_handler handler,
+                                        Bool is_token_vector_kept)
+{
+    ptr_parser->token_handler = handler;
+    ptr_parser->is_token_vector_kept = is_token_vector_kept;
+}
+
+/**
+ * @brief Static - translates a token into SAX events.
+ * 
+ * Iter keys are not reported, as the position of a value in
+ * a list is known to the handler by counting.
+ */
+static void sax_on_token(void* ptr_context,
+                         const struct json_parser* ptr_parser,
+                         const struct json_token* ptr_token)
+{
+    struct json_sax_handler* ptr_handler = ptr_context;
+    struct json_sax_value value;
+    const char* literal = abel_json_token_literal(ptr_parser, ptr_token);
+    switch (ptr_token->type) {
+    case KEY:
+        if (ptr_handler->on_key != NULL) {
+            ptr_handler->on_key(ptr_handler->ptr_context, literal,
+                                ptr_token->literal.length, ptr_token->level);
+        }
+        break;
+    case TERMINAL:
+        if (ptr_handler->on_terminal != NULL) {
+            value.terminal_type = ptr_token->terminal_type;
+            value.literal = literal;
+            value.length = ptr_token->literal.length;
+            value.bool_value = false;
+            value.double_value = 0.0;
+            if (value.terminal_type == BOOL_TERM) {
+                value.bool_value = as_bool((char*)literal);
+            } else if (value.terminal_type == DOUBLE_TERM) {
+                value.double_value = as_double((char*)literal);
+            }
+            ptr_handler->on_terminal(ptr_handler->ptr_context, &value,
+                                     ptr_token->level);
+        }
+        break;
+    case DICT_OPENING:
+    case LIST_OPENING:
+        if (ptr_handler->on_container_open != NULL) {
+            ptr_handler->on_container_open(ptr_handler->ptr_context,
+                ptr_token->type == DICT_OPENING ? DICT : LIST,
+                ptr_token->level);
+        }
+        break;
+    case DICT_CLOSING:
+    case LIST_CLOSING:
+        if (ptr_handler->on_container_close != NULL) {
+            ptr_handler->on_container_close(ptr_handler->ptr_context,
+                ptr_token->type == DICT_CLOSING ? DICT : LIST,
+                ptr_token->level);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Attach a SAX handler
+ * 
+ * @param ptr_parser Pointer to JSON parser.
+ * @param ptr_handler Pointer to SAX handler, owned by caller.
+ */
+void abel_json_parser_set_sax_handler(struct json_parser* ptr_parser,
+                                      struct json_sax_handler* ptr_handler)
+{
+    struct json_token_handler handler;
+    handler.ptr_context = ptr_handler;
+    handler.on_token = sax_on_token;
+    abel_json_parser_set_token_handler(ptr_parser, handler, false);
+}
+
+/**
+ * @brief Literal of a token
+ * 
+ * @param ptr_parser Pointer to the parser that made the token.
+ * @param ptr_token Pointer to token.
+ * @return Literal as C string in the literal pool.
+ */
+const char* abel_json_token_literal(const struct json_parser* ptr_parser,
+                                    const struct json_token* ptr_token)
+{
+    return json_slice_cstr(&ptr_parser->literal_pool, ptr_token->literal);
+}
+
+/**
+ * @brief Parent key of a token
+ * 
+ * @param ptr_parser Pointer to the parser that made the token.
+ * @param ptr_token Pointer to token.
+ * @return Interned parent key as C string.
+ */
+const char* abel_json_token_parent_key(struct json_parser* ptr_parser,
+                                       const struct json_token* ptr_token)
+{
+    size_t id = ptr_token->parent_key_id;
+    if ((id & JSON_TOKEN_ITER_KEY_ID) != 0) {
+        snprintf(ptr_parser->iter_key, sizeof(ptr_parser->iter_key), "%zu",
+                 id & ~JSON_TOKEN_ITER_KEY_ID);
+        return ptr_parser->iter_key;
+    }
+    return parent_key_by_id(ptr_parser, id);
+}
@@ -63,21 +63,39 @@ const char* get_json_terminal_type_str(enum json_terminal_type term_type)
     return JsonTerminalTypeString[term_type];
 }
 
+/* Literal pool */
+
+struct json_slice json_slice_append(struct abel_string* ptr_pool,
+                                    const char* literal, size_t length)
+{
+    struct json_slice slice;
+    slice.offset = ptr_pool->length;
+    slice.length = length;
+    /* null char is copied as well */
+    abel_string_append_n(ptr_pool, literal, length + 1);
+    return slice;
+}
+
+const char* json_slice_cstr(const struct abel_string* ptr_pool,
+                            struct json_slice slice)
+{
+    return abel_string_cstr(ptr_pool) + slice.offset;
+}
+
 /* Tokenizers for various token types */
 
 struct json_token tokenize_iter_key(
-    struct abel_string* literal,
-    struct abel_string* pk,
+    struct json_slice literal,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type,
     int iter_index)
 {
     struct json_token token;
-    token.literal = abel_make_string_ptr(literal->ptr_array);
+    token.literal = literal;
     token.type = ITER_KEY;
-    //token.parent_key = pk;
-    token.parent_key = abel_make_string_ptr(pk->ptr_array);
+    token.parent_key_id = pk_id;
     token.level = level;
     token.line = line;
     token.container_type = container_type;
@@ -85,22 +103,22 @@ struct json_token tokenize_iter_key(
     /* not used by iter key */
     token.terminal_type = NONE_TERM;
     token.literal_scheme = NONE_SCHEME;
-    token.referenced_type = abel_make_string_ptr("");
+    token.referenced_type = "";
     return token;
 }
 
 struct json_token tokenize_key(
-    struct abel_string* literal,
-    struct abel_string* pk,
+    struct json_slice literal,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type,
     enum literal_scheme scheme)
 {
     struct json_token token;
-    token.literal = abel_make_string_ptr(literal->ptr_array);
+    token.literal = literal;
     token.type = KEY;
-    token.parent_key = abel_make_string_ptr(pk->ptr_array);
+    token.parent_key_id = pk_id;
     token.level = level;
     token.line = line;
     token.container_type = container_type;
@@ -108,13 +126,13 @@ struct json_token tokenize_key(
     /* not used by key */
     token.iter_index = 0;
     token.terminal_type = NONE_TERM;
-    token.referenced_type = abel_make_string_ptr("");
+    token.referenced_type = "";
     return token;
 }
 
 struct json_token tokenize_terminal(
-    struct abel_string* literal,
-    struct abel_string* pk,
+    struct json_slice literal,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type,
@@ -122,9 +140,9 @@ struct json_token tokenize_terminal(
     enum literal_scheme scheme)
 {
     struct json_token token;
-    token.literal = abel_make_string_ptr(literal->ptr_array);
+    token.literal = literal;
     token.type = TERMINAL;
-    token.parent_key = abel_make_string_ptr(pk->ptr_array);
+    token.parent_key_id = pk_id;
     token.level = level;
     token.line = line;
     token.container_type = container_type;
@@ -132,26 +150,26 @@ struct json_token tokenize_terminal(
     token.literal_scheme = scheme;
     /* not used by terminal */
     token.iter_index = 0;
-    token.referenced_type = abel_make_string_ptr("");
+    token.referenced_type = "";
     return token;
 }
 
 struct json_token tokenize(
-    struct abel_string* literal,
+    struct json_slice literal,
     enum json_token_type type,
-    struct abel_string* pk,
+    size_t pk_id,
     int level,
     int line,
     enum json_container_type container_type)
 {
     struct json_token token;
-    token.literal = abel_make_string_ptr(literal->ptr_array);
+    token.literal = literal;
     token.type = type;
-    token.parent_key = abel_make_string_ptr(pk->ptr_array);
+    token.parent_key_id = pk_id;
     token.level = level;
     token.line = line;
     token.container_type = container_type;
-    token.referenced_type = abel_make_string_ptr("");
+    token.referenced_type = "";
     /* not used in opening/closing token */
     token.iter_index = 0;
     token.terminal_type = NONE_TERM;
@@ -162,34 +180,166 @@ struct json_token tokenize(
 json_token_ptr abel_make_token_ptr(const struct json_token* ref_token)
 {
     struct json_token* ptr_token = malloc( sizeof(*ptr_token) );
-    /* copy pointer to the literal string */
-    ptr_token->literal = ref_token->literal;
-    ptr_token->type = ref_token->type;
-    /* copy pointer to the parent-key string */
-    ptr_token->parent_key = ref_token->parent_key;
-    ptr_token->level = ref_token->level;
-    ptr_token->line = ref_token->line;
-    ptr_token->container_type = ref_token->container_type;
-    ptr_token->iter_index = ref_token->iter_index;
-    ptr_token->terminal_type = ref_token->terminal_type;
-    ptr_token->literal_scheme = ref_token->literal_scheme;
-    ptr_token->referenced_type = ref_token->referenced_type;
+    *ptr_token = *ref_token;
     return ptr_token;
 }
 
-void abel_free_json_token(struct json_token* ptr_token)
+void abel_free_json_token_ptr(json_token_ptr ptr_token)
 {
-    abel_free_string_ptr(ptr_token->literal);
-    abel_free_string_ptr(ptr_token->parent_key);
-    abel_free_string_ptr(ptr_token->referenced_type);
+    free(ptr_token);
 }
 
-void abel_free_json_token_ptr(json_token_ptr ptr_token)
+/* Token tape */
+
+/* Initial number of tokens a tape can hold */
+const size_t TOKEN_TAPE_MIN_CAPACITY = 64;
+
+/**
+ * @brief Static - reallocates one array of the tape.
+ * 
+ * @return True if success. Upon failure, the array is kept.
+ */
+static Bool tape_realloc(void** ptr_array, size_t capacity, size_t elem_size)
 {
-    abel_free_string_ptr(ptr_token->literal);
-    abel_free_string_ptr(ptr_token->parent_key);
-    abel_free_string_ptr(ptr_token->referenced_type);
-    free(ptr_token);
+    void* ptr_new = realloc(*ptr_array, capacity * elem_size);
+    if (ptr_new == NULL) {
+        return false;
+    }
+    *ptr_array = ptr_new;
+    return true;
+}
+
+/**
+ * @brief Static - grows all arrays of the tape to capacity.
+ * 
+ * Arrays that are grown before a failure keep their new
+ * size, which is harmless as the capacity is only updated
+ * once all arrays are grown.
+ */
+static Bool tape_grow(struct json_token_tape* ptr_tape, size_t capacity)
+{
+    Bool is_grown
+        = tape_realloc((void**)&ptr_tape->ptr_types, capacity,
+                       sizeof(*ptr_tape->ptr_types))
+        && tape_realloc((void**)&ptr_tape->ptr_levels, capacity,
+                        sizeof(*ptr_tape->ptr_levels))
+        && tape_realloc((void**)&ptr_tape->ptr_terminal_types, capacity,
+                        sizeof(*ptr_tape->ptr_terminal_types))
+        && tape_realloc((void**)&ptr_tape->ptr_literals, capacity,
+                        sizeof(*ptr_tape->ptr_literals))
+        && tape_realloc((void**)&ptr_tape->ptr_parent_key_ids, capacity,
+                        sizeof(*ptr_tape->ptr_parent_key_ids))
+        && tape_realloc((void**)&ptr_tape->ptr_matching_indices, capacity,
+                        sizeof(*ptr_tape->ptr_matching_indices))
+        && tape_realloc((void**)&ptr_tape->ptr_lines, capacity,
+                        sizeof(*ptr_tape->ptr_lines))
+        && tape_realloc((void**)&ptr_tape->ptr_container_types, capacity,
+                        sizeof(*ptr_tape->ptr_container_types))
+        && tape_realloc((void**)&ptr_tape->ptr_iter_indices, capacity,
+                        sizeof(*ptr_tape->ptr_iter_indices))
+        && tape_realloc((void**)&ptr_tape->ptr_literal_schemes, capacity,
+                        sizeof(*ptr_tape->ptr_literal_schemes))
+        && tape_realloc((void**)&ptr_tape->ptr_referenced_types, capacity,
+                        sizeof(*ptr_tape->ptr_referenced_types));
+    if (is_grown == true) {
+        ptr_tape->capacity = capacity;
+    }
+    return is_grown;
+}
+
+struct json_token_tape abel_make_token_tape()
+{
+    struct json_token_tape tape;
+    memset(&tape, 0, sizeof(tape));
+    tape.open_index = JSON_TOKEN_NO_INDEX;
+    return tape;
+}
+
+void abel_free_token_tape(struct json_token_tape* ptr_tape)
+{
+    free(ptr_tape->ptr_types);
+    free(ptr_tape->ptr_levels);
+    free(ptr_tape->ptr_terminal_types);
+    free(ptr_tape->ptr_literals);
+    free(ptr_tape->ptr_parent_key_ids);
+    free(ptr_tape->ptr_matching_indices);
+    free(ptr_tape->ptr_lines);
+    free(ptr_tape->ptr_container_types);
+    free(ptr_tape->ptr_iter_indices);
+    free(ptr_tape->ptr_literal_schemes);
+    free(ptr_tape->ptr_referenced_types);
+    *ptr_tape = abel_make_token_tape();
+}
+
+size_t abel_token_tape_size(const struct json_token_tape* ptr_tape)
+{
+    return ptr_tape->size;
+}
+
+struct abel_return_option abel_token_tape_push_back(
+    struct json_token_tape* ptr_tape, const struct json_token* ref_token)
+{
+    if (ptr_tape->size == ptr_tape->capacity) {
+        size_t capacity = ptr_tape->capacity == 0
+                        ? TOKEN_TAPE_MIN_CAPACITY : 2 * ptr_tape->capacity;
+        if (tape_grow(ptr_tape, capacity) == false) {
+            return abel_option_error( error_realloc_failure() );
+        }
+    }
+    size_t idx = ptr_tape->size;
+    ptr_tape->ptr_types[idx] = ref_token->type;
+    ptr_tape->ptr_levels[idx] = ref_token->level;
+    ptr_tape->ptr_terminal_types[idx] = ref_token->terminal_type;
+    ptr_tape->ptr_literals[idx] = ref_token->literal;
+    ptr_tape->ptr_parent_key_ids[idx] = ref_token->parent_key_id;
+    ptr_tape->ptr_lines[idx] = ref_token->line;
+    ptr_tape->ptr_container_types[idx] = ref_token->container_type;
+    ptr_tape->ptr_iter_indices[idx] = ref_token->iter_index;
+    ptr_tape->ptr_literal_schemes[idx] = ref_token->literal_scheme;
+    ptr_tape->ptr_referenced_types[idx] = ref_token->referenced_type;
+    ptr_tape->ptr_matching_indices[idx] = JSON_TOKEN_NO_INDEX;
+    if (ref_token->type == DICT_OPENING || ref_token->type == LIST_OPENING) {
+        /* link to the enclosing open container until closed */
+        ptr_tape->ptr_matching_indices[idx] = ptr_tape->open_index;
+        ptr_tape->open_index = idx;
+    } else if ((ref_token->type == DICT_CLOSING
+                || ref_token->type == LIST_CLOSING)
+               && ptr_tape->open_index != JSON_TOKEN_NO_INDEX) {
+        size_t opening_idx = ptr_tape->open_index;
+        ptr_tape->open_index = ptr_tape->ptr_matching_indices[opening_idx];
+        ptr_tape->ptr_matching_indices[opening_idx] = idx;
+        ptr_tape->ptr_matching_indices[idx] = opening_idx;
+    }
+    ptr_tape->size += 1;
+    return abel_option_okay(NULL);
+}
+
+size_t abel_token_tape_closing_index(const struct json_token_tape* ptr_tape,
+                                     size_t opening_idx)
+{
+    size_t closing_idx = ptr_tape->ptr_matching_indices[opening_idx];
+    /* an open container links backwards, or to no index */
+    if (closing_idx == JSON_TOKEN_NO_INDEX || closing_idx < opening_idx) {
+        return ptr_tape->size;
+    }
+    return closing_idx;
+}
+
+struct json_token abel_token_tape_at(const struct json_token_tape* ptr_tape,
+                                     size_t idx)
+{
+    struct json_token token;
+    token.literal = ptr_tape->ptr_literals[idx];
+    token.type = ptr_tape->ptr_types[idx];
+    token.parent_key_id = ptr_tape->ptr_parent_key_ids[idx];
+    token.level = ptr_tape->ptr_levels[idx];
+    token.line = ptr_tape->ptr_lines[idx];
+    token.container_type = ptr_tape->ptr_container_types[idx];
+    token.iter_index = ptr_tape->ptr_iter_indices[idx];
+    token.terminal_type = ptr_tape->ptr_terminal_types[idx];
+    token.literal_scheme = ptr_tape->ptr_literal_schemes[idx];
+    token.referenced_type = ptr_tape->ptr_referenced_types[idx];
+    return token;
 }
 
 Bool is_opening_symbol(char* src_str)
@@ -12,6 +12,7 @@ struct abel_list abel_make_list(size_t size)
     struct abel_list list;
     list.ptr_vector = abel_make_vector_ptr(size);
     list.data_type = OBJECT_TYPE;
+    list.is_read_only = false;
     return list;
 }
 
@@ -20,6 +21,7 @@ struct abel_list* abel_make_list_ptr(size_t size)
     struct abel_list* ptr_list = malloc( sizeof(*ptr_list) ); // instance itself
     ptr_list->ptr_vector = abel_make_vector_ptr(size);
     ptr_list->data_type = OBJECT_TYPE;
+    ptr_list->is_read_only = false;
     return ptr_list;
 }
 
@@ -63,12 +65,16 @@ Bool abel_list_is_valid_index(struct abel_list* ptr_list, size_t idx)
  * the ref count of the object by 1.
  * 
  * @note Vector append returns option that contains
- *       either NULL pointer or error.
+ *       either NULL pointer or error. Error READ_ONLY is
+ *       returned if the list belongs to a document.
  */
 static struct abel_return_option append_object_ptr_to_list(
         struct abel_list* ptr_list, struct abel_object* ptr_obj)
 {
-    ptr_obj->ref_count += 1;    /* increase the ref count by 1 */
+    if (ptr_list->is_read_only == true) {
+        return abel_option_error( error_read_only() );
+    }
+    abel_object_add_ref(ptr_obj);    /* increase the ref count by 1 */
     return abel_vector_append(ptr_list->ptr_vector, ptr_obj);
 }
 
@@ -78,7 +84,7 @@ struct abel_return_option abel_list_append_bool_ptr(
 {
     struct abel_object* ptr_object_on_heap = NULL;
     struct abel_return_option ret_option;
-    ptr_object_on_heap = abel_make_object_ptr(ptr_src_data);
+    ptr_object_on_heap = abel_bool_object_ptr(*ptr_src_data);
     ret_option = append_object_ptr_to_list(ptr_list, ptr_object_on_heap);
     return ret_option;
 }
@@ -95,7 +101,7 @@ struct abel_return_option abel_list_append_null_ptr(
 {
     struct abel_object* ptr_object_on_heap = NULL;
     struct abel_return_option ret_option;
-    ptr_object_on_heap = abel_make_object_ptr(ptr_src_data);
+    ptr_object_on_heap = abel_null_object_ptr();
     ret_option = append_object_ptr_to_list(ptr_list, ptr_object_on_heap);
     return ret_option;
 }
@@ -197,16 +203,20 @@ struct abel_return_option abel_list_append_dict_ptr(
  *         - If failure, flag is_error is true and error is
  *           returned in the option.
  * @note Vector set function returns the previous occupant at
- *       the given index.
+ *       the given index. Error READ_ONLY is returned if the
+ *       list belongs to a document.
  */
 static struct abel_return_option set_object_ptr_on_list(
         struct abel_list* ptr_list, size_t idx, struct abel_object* ptr_src)
 {
     struct abel_return_option ret_from_vector;
+    if (ptr_list->is_read_only == true) {
+        return abel_option_error( error_read_only() );
+    }
     ret_from_vector = abel_vector_set(ptr_list->ptr_vector, idx, ptr_src);
     if (ret_from_vector.is_okay == true) {
         /* increase the ref count only if insertion succeeds */
-        ptr_src->ref_count += 1;
+        abel_object_add_ref(ptr_src);
         /* free previous occupant if any */
         if (ret_from_vector.pointer != NULL) {
             abel_free_object_ptr( (struct abel_object*)ret_from_vector.pointer );
@@ -222,7 +232,7 @@ struct abel_return_option abel_list_set_bool_ptr(
 {
     struct abel_object* ptr_object_on_heap = NULL;
     struct abel_return_option ret_option;
-    ptr_object_on_heap = abel_make_object_ptr(ptr_src_data);
+    ptr_object_on_heap = abel_bool_object_ptr(*ptr_src_data);
     ret_option = set_object_ptr_on_list(ptr_list, idx, ptr_object_on_heap);
     return ret_option;
 }
@@ -239,7 +249,7 @@ struct abel_return_option abel_list_set_null_ptr(
 {
     struct abel_object* ptr_object_on_heap = NULL;
     struct abel_return_option ret_option;
-    ptr_object_on_heap = abel_make_object_ptr(ptr_src_data);
+    ptr_object_on_heap = abel_null_object_ptr();
     ret_option = set_object_ptr_on_list(ptr_list, idx, ptr_object_on_heap);
     return ret_option;
 }
@@ -368,7 +378,9 @@ struct abel_return_option abel_list_delete(struct abel_list* ptr_list, size_t id
 {
     struct abel_return_option ret;
     struct abel_return_option ret_vector_get;
-    if ( abel_list_is_valid_index(ptr_list, idx) ) {
+    if (ptr_list->is_read_only == true) {
+        ret = abel_option_error( error_read_only() );
+    } else if ( abel_list_is_valid_index(ptr_list, idx) ) {
         /* current list is the only owner of the object */
         ret_vector_get = abel_vector_get(ptr_list->ptr_vector, idx);
         if (ret_vector_get.pointer != NULL) {
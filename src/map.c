@@ -1,377 +1,955 @@
 /* Source map.c */
+#ifdef ABEL_ATOMIC_REF_COUNT
+#include <stdatomic.h>
+#include <threads.h>
+#endif
 #include "map.h"
 
-const size_t MAP_DEFAULT_VECTOR_SIZE = 2048;
+/* Slot table allocated when a small map is promoted */
+const size_t MAP_MIN_CAPACITY = 2 * MAP_SMALL_CAPACITY;
+
+/* Table grows once the number of pairs exceeds this fraction */
+const double MAP_MAX_LOAD_FACTOR = 0.85;
+
+/* Table shrinks once the number of pairs drops below this fraction */
+const double MAP_MIN_LOAD_FACTOR = 0.2;
+
+/* Number of slots migrated from the previous table per operation */
+const size_t MAP_REHASH_STEP = 16;
+
+/**
+ * @brief Static - Marker of a migrated slot
+ *
+ * Once the pair in a slot of the previous table has been
+ * migrated (or erased), the slot keeps its hash and probe
+ * length but points at this marker. Probing of the previous
+ * table therefore steps over it instead of stopping early.
+ */
+static struct abel_key_value_pair MIGRATED_PAIR;
 
 /**
- * @brief Static - Hash function
+ * @brief Static - Table of interned keys
  *
- * Value returned from this function cannot be  used directly
- * as the index, but its modulus againt vector size can.
- * 
- * One-byte-at-a-time hash based on Murmur's mix
- * Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
+ * Interned keys are the pairs of this map. Chars of a key
+ * are stored inline in its pair, and the data pointer points
+ * at the reference count of the key. Map is made on the first
+ * interning and freed once the last key is released.
  */
-static uint32_t MurmurOAAT_32(const char* str, uint32_t h)
+static struct abel_map* ptr_interned_keys = NULL;
+
+/**
+ * @brief Static - Reference count of an interned key
+ *
+ * Count is a C11 atomic if the library is built with
+ * ABEL_ATOMIC_REF_COUNT defined, such that a holder of the
+ * key takes another reference without locking the tables.
+ * Count drops to zero only under the lock, see
+ * `abel_release_interned_key`.
+ */
+struct interned_ref_count {
+#ifdef ABEL_ATOMIC_REF_COUNT
+    _Atomic size_t count;
+#else
+    size_t count;
+#endif
+};
+
+/**
+ * @brief Static - Empty key shape
+ *
+ * Root of the tree of shapes. It is made when the first
+ * shape is and freed with the last one.
+ */
+static struct abel_key_shape* ptr_root_shape = NULL;
+
+/* Id of the next shape made */
+static uint64_t next_shape_id = 1;
+
+#ifdef ABEL_ATOMIC_REF_COUNT
+/**
+ * @brief Static - Lock of the shared tables
+ *
+ * Guards the table of interned keys and the tree of shapes,
+ * which are shared by all dicts. Lock is taken to intern,
+ * release and find a key and to add or release a shape, not
+ * to take another reference to a key or to look up a key in
+ * a shape. Lock is recursive, as releasing a shape releases
+ * its parent and its last key.
+ */
+static mtx_t table_lock;
+static once_flag table_lock_once = ONCE_FLAG_INIT;
+
+static void init_table_lock(void)
 {
-    for (; *str; ++str) {
-        h ^= *str;
-        h *= 0x5bd1e995;
-        h ^= h >> 15;
-    }
-    return h;
+    mtx_init(&table_lock, mtx_plain | mtx_recursive);
 }
+#endif
 
 /**
- * @brief Static - Convert key to index
- * 
- * Index is computed as the remainder of the hashing value
- * divided by vector size.
- * 
- * @param key_str : Key string to be projected into index
- *                  in the vector of the map.
+ * @brief Static - Lock the shared tables
+ *
+ * Does nothing unless the library is built with
+ * ABEL_ATOMIC_REF_COUNT defined.
  */
-static size_t key_string_to_index(const char* key_str)
+static void lock_tables(void)
 {
-    size_t idx = MurmurOAAT_32(key_str, 1) % MAP_DEFAULT_VECTOR_SIZE;
-    return idx;
+#ifdef ABEL_ATOMIC_REF_COUNT
+    call_once(&table_lock_once, init_table_lock);
+    mtx_lock(&table_lock);
+#endif
+}
+
+/**
+ * @brief Static - Unlock the shared tables
+ */
+static void unlock_tables(void)
+{
+#ifdef ABEL_ATOMIC_REF_COUNT
+    mtx_unlock(&table_lock);
+#endif
+}
+
+/**
+ * @brief Static - Hash a key
+ *
+ * Hash function and seed are those of the map. Slot index
+ * of a key is the hash value masked by the table capacity,
+ * which is always a power of 2. A 64-bit value is folded
+ * into the 32 bits kept by a slot.
+ *
+ * @param ptr_map : Map whose hash function is used.
+ * @param key_str : Key string to be hashed.
+ * @param key_length : Number of chars of the key.
+ */
+static uint32_t hash_key_string(const struct abel_map* ptr_map,
+                                const char* key_str, size_t key_length)
+{
+    uint64_t hash = ptr_map->hash_func(key_str, key_length, ptr_map->hash_seed);
+    return (uint32_t)(hash ^ (hash >> 32));
 }
 
 /**
  * @brief Static - Make a pair
- * 
- * Returns a pointer of MapItem created on heap. Map item is
- * an intermediary that establishes connection between key
+ *
+ * Returns a pointer of pair created on heap. Pair is an
+ * intermediary that establishes connection between key
  * and value, it is thus only used by the map. The value is
- * a pointer to the data.
- * 
- * @note Resource allocated to store the key must be freed.
+ * a pointer to the data. Key is copied into the same
+ * allocation as the pair, unless it is interned, in which
+ * case the pair refers to the interned chars.
+ *
+ * @return Pointer to the pair, or NULL if malloc fails.
  */
-static struct abel_key_value_pair* make_pair_ptr(char* key, void* ptr_data)
+static struct abel_key_value_pair* make_pair_ptr(const char* key,
+    size_t key_length, uint32_t hash, void* ptr_data, Bool is_interned)
 {
     struct abel_key_value_pair* ptr_pair = NULL;
-    ptr_pair = malloc( sizeof(*ptr_pair) );
-    ptr_pair->key = malloc(strlen(key) + 1);
-    strcpy(ptr_pair->key, key);
+    if (is_interned == true) {
+        ptr_pair = malloc( sizeof(*ptr_pair) );
+    } else {
+        ptr_pair = malloc( sizeof(*ptr_pair) + key_length + 1 );
+    }
+    if (ptr_pair == NULL) {
+        return NULL;
+    }
     ptr_pair->ptr_data = ptr_data;
+    ptr_pair->hash = hash;
+    ptr_pair->key_length = (uint32_t)key_length;
+    if (is_interned == true) {
+        ptr_pair->key = (char*)key;
+    } else {
+        ptr_pair->key = ptr_pair->key_chars;
+        memcpy(ptr_pair->key_chars, key, key_length);
+        ptr_pair->key_chars[key_length] = '\0';
+    }
     return ptr_pair;
 }
 
+/**
+ * @brief Static - Does the pair hold the key
+ *
+ * Interned keys are equal if they are the same pointer.
+ * Otherwise, hash and length are compared before the chars.
+ */
+static Bool pair_has_key(const struct abel_key_value_pair* ptr_pair,
+    uint32_t hash, const char* key_str, size_t key_length)
+{
+    return ((ptr_pair->key == key_str && ptr_pair->key_length == key_length)
+            || (ptr_pair->hash == hash && ptr_pair->key_length == key_length
+                && memcmp(ptr_pair->key, key_str, key_length) == 0));
+}
+
+/**
+ * @brief Static - Interned key of the chars
+ *
+ * Chars of an interned key are inline in its pair of the
+ * table of interned keys.
+ */
+static struct abel_key_value_pair* interned_pair(const char* interned_key)
+{
+    return (struct abel_key_value_pair*)(interned_key
+            - offsetof(struct abel_key_value_pair, key_chars));
+}
+
+/**
+ * @brief Static - Take another reference to an interned key
+ *
+ * Caller holds a reference to the key already, so the count
+ * cannot drop to zero meanwhile and the tables need not be
+ * locked. Relaxed in the atomic mode, as for objects.
+ */
+static void add_interned_key_ref(const char* interned_key)
+{
+    struct interned_ref_count* ptr_count = interned_pair(interned_key)->ptr_data;
+#ifdef ABEL_ATOMIC_REF_COUNT
+    atomic_fetch_add_explicit(&ptr_count->count, 1, memory_order_relaxed);
+#else
+    ptr_count->count++;
+#endif
+}
+
 struct abel_return_option abel_free_pair(struct abel_key_value_pair* ptr_pair)
 {
     struct abel_return_option ret;
     /* return the pointer to the data held by pair */
     ret.pointer = ptr_pair->ptr_data;
-    free(ptr_pair->key);
+    if (ptr_pair->key != ptr_pair->key_chars) {
+        abel_release_interned_key(ptr_pair->key);
+    }
     free(ptr_pair);
     return ret;
 }
 
+Bool abel_map_slot_is_live(const struct abel_map_slot* ptr_slot)
+{
+    return (ptr_slot->probe_length != 0 && ptr_slot->ptr_pair != &MIGRATED_PAIR);
+}
+
 /**
- * @todo How to return errors?
- * 
+ * @brief Static - Find the slot that holds the key
+ *
+ * Probes the given table from the home slot of the hash.
+ * Probing stops at an empty slot or at a slot whose probe
+ * length is shorter than the current one, since by Robin
+ * Hood invariant the key cannot be found any further.
+ *
+ * @return Pointer to the slot holding the key, or NULL if
+ *         the key is not in this table.
  */
+static struct abel_map_slot* table_find_slot(struct abel_map_slot* ptr_slots,
+    size_t capacity, uint32_t hash, const char* key_str, size_t key_length)
+{
+    size_t mask = capacity - 1;
+    size_t idx = 0;
+    uint32_t probe_length = 1;
+    if (ptr_slots == NULL) {
+        return NULL;
+    }
+    idx = hash & mask;
+    while (ptr_slots[idx].probe_length >= probe_length) {
+        if (ptr_slots[idx].hash == hash
+                && abel_map_slot_is_live(&ptr_slots[idx])
+                && pair_has_key(ptr_slots[idx].ptr_pair,
+                                hash, key_str, key_length)) {
+            return &ptr_slots[idx];
+        }
+        idx = (idx + 1) & mask;
+        probe_length++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Static - Place a pair into a table
+ *
+ * Robin Hood insertion. Whenever the incoming pair has
+ * probed further than the occupant, they swap and the
+ * displaced occupant continues probing. The key must not
+ * exist in the table and the table must have an empty slot.
+ */
+static void table_place(struct abel_map_slot* ptr_slots, size_t capacity,
+    struct abel_key_value_pair* ptr_pair, uint32_t hash)
+{
+    size_t mask = capacity - 1;
+    size_t idx = hash & mask;
+    struct abel_map_slot incoming = { ptr_pair, hash, 1 };
+    struct abel_map_slot displaced;
+    while (ptr_slots[idx].probe_length != 0) {
+        if (ptr_slots[idx].probe_length < incoming.probe_length) {
+            displaced = ptr_slots[idx];
+            ptr_slots[idx] = incoming;
+            incoming = displaced;
+        }
+        idx = (idx + 1) & mask;
+        incoming.probe_length++;
+    }
+    ptr_slots[idx] = incoming;
+}
+
+/**
+ * @brief Static - Remove a slot by backward shift
+ *
+ * The slot is emptied and the following slots of the same
+ * cluster are shifted back by one, such that no tombstone
+ * is left in the table.
+ */
+static void table_remove_slot(struct abel_map_slot* ptr_slots, size_t capacity,
+    struct abel_map_slot* ptr_target)
+{
+    size_t mask = capacity - 1;
+    size_t idx = ptr_target - ptr_slots;
+    size_t next = (idx + 1) & mask;
+    while (ptr_slots[next].probe_length > 1) {
+        ptr_slots[idx] = ptr_slots[next];
+        ptr_slots[idx].probe_length--;
+        idx = next;
+        next = (next + 1) & mask;
+    }
+    ptr_slots[idx] = (struct abel_map_slot){ NULL, 0, 0 };
+}
+
+/**
+ * @brief Static - Migrate slots from the previous table
+ *
+ * Moves the pairs of at most `steps` slots of the previous
+ * table into the current one. Once all slots are visited,
+ * the previous table is freed.
+ */
+static void map_rehash_step(struct abel_map* ptr_map, size_t steps)
+{
+    struct abel_map_slot* ptr_slot = NULL;
+    while (ptr_map->ptr_old_slots != NULL && steps > 0) {
+        ptr_slot = &ptr_map->ptr_old_slots[ptr_map->rehash_index];
+        if (abel_map_slot_is_live(ptr_slot)) {
+            table_place(ptr_map->ptr_slots, ptr_map->capacity,
+                        ptr_slot->ptr_pair, ptr_slot->hash);
+            ptr_slot->ptr_pair = &MIGRATED_PAIR;
+        }
+        ptr_map->rehash_index++;
+        steps--;
+        if (ptr_map->rehash_index == ptr_map->old_capacity) {
+            free(ptr_map->ptr_old_slots);
+            ptr_map->ptr_old_slots = NULL;
+            ptr_map->old_capacity = 0;
+            ptr_map->rehash_index = 0;
+        }
+    }
+}
+
+/**
+ * @brief Static - Grow the slot table
+ *
+ * Allocates a table of twice the capacity and retires the
+ * current one as the previous table, whose pairs will be
+ * migrated incrementally. A migration still in progress is
+ * completed first.
+ *
+ * A map in small mode is promoted instead: the first slot
+ * table is allocated and the inline pairs are placed into
+ * it at once.
+ *
+ * @return Option instance. Per failure of calloc, error
+ *         MALLOC_FAILURE is returned and map is unchanged.
+ */
+static struct abel_return_option map_grow(struct abel_map* ptr_map)
+{
+    size_t new_capacity = MAP_MIN_CAPACITY;
+    struct abel_map_slot* ptr_new_slots = NULL;
+    if (ptr_map->capacity > 0) {
+        new_capacity = ptr_map->capacity * 2;
+    }
+    struct abel_key_value_pair** ptr_entries = NULL;
+    ptr_new_slots = calloc( new_capacity, sizeof(*ptr_new_slots) );
+    if (ptr_new_slots == NULL) {
+        return abel_option_error( error_malloc_failure() );
+    }
+    if (ptr_map->ptr_slots == NULL) {
+        ptr_entries = malloc( new_capacity * sizeof(*ptr_entries) );
+        if (ptr_entries == NULL) {
+            free(ptr_new_slots);
+            return abel_option_error( error_malloc_failure() );
+        }
+        for (size_t i = 0; i < ptr_map->size; i++) {
+            table_place(ptr_new_slots, new_capacity,
+                        ptr_map->small_slots[i].ptr_pair,
+                        ptr_map->small_slots[i].hash);
+            ptr_entries[i] = ptr_map->small_slots[i].ptr_pair;
+            ptr_entries[i]->entry_index = i;
+        }
+        memset(ptr_map->small_slots, 0, sizeof(ptr_map->small_slots));
+        ptr_map->ptr_slots = ptr_new_slots;
+        ptr_map->capacity = new_capacity;
+        ptr_map->ptr_entries = ptr_entries;
+        ptr_map->entry_count = ptr_map->size;
+        ptr_map->entry_capacity = new_capacity;
+        return abel_option_okay(NULL);
+    }
+    map_rehash_step(ptr_map, ptr_map->old_capacity);
+    ptr_map->ptr_old_slots = ptr_map->ptr_slots;
+    ptr_map->old_capacity = ptr_map->capacity;
+    ptr_map->rehash_index = 0;
+    ptr_map->ptr_slots = ptr_new_slots;
+    ptr_map->capacity = new_capacity;
+    return abel_option_okay(NULL);
+}
+
+/**
+ * @brief Static - Find the slot of a key in small mode
+ *
+ * Inline slots are searched linearly. Hash is compared
+ * first such that strcmp is mostly run on the match only.
+ */
+static struct abel_map_slot* small_find_slot(struct abel_map* ptr_map,
+    uint32_t hash, const char* key_str, size_t key_length)
+{
+    for (size_t i = 0; i < ptr_map->size; i++) {
+        if (ptr_map->small_slots[i].hash == hash
+                && pair_has_key(ptr_map->small_slots[i].ptr_pair,
+                                hash, key_str, key_length)) {
+            return &ptr_map->small_slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Static - Find the slot of a key in either table
+ */
+#ifdef ABEL_MAP_COUNTERS
+/**
+ * @brief Static - Number of slots probed by a miss
+ */
+static size_t table_miss_probes(const struct abel_map_slot* ptr_slots,
+    size_t capacity, uint32_t hash)
+{
+    size_t mask = capacity - 1;
+    size_t idx = hash & mask;
+    uint32_t probe_length = 1;
+    if (ptr_slots == NULL) {
+        return 0;
+    }
+    while (ptr_slots[idx].probe_length >= probe_length) {
+        idx = (idx + 1) & mask;
+        probe_length++;
+    }
+    return probe_length;
+}
+
+/**
+ * @brief Static - Count a lookup
+ *
+ * @param ptr_slot : Slot found by the lookup, NULL if missed.
+ */
+static void count_lookup(struct abel_map* ptr_map,
+    const struct abel_map_slot* ptr_slot, uint32_t hash)
+{
+    ptr_map->lookup_count++;
+    if (ptr_slot != NULL) {
+        ptr_map->hit_count++;
+        ptr_map->probe_count += (ptr_map->ptr_slots == NULL)
+                ? (size_t)(ptr_slot - ptr_map->small_slots) + 1
+                : ptr_slot->probe_length;
+    } else {
+        ptr_map->miss_count++;
+        ptr_map->probe_count += (ptr_map->ptr_slots == NULL)
+                ? ptr_map->size
+                : table_miss_probes(ptr_map->ptr_slots, ptr_map->capacity, hash)
+                  + table_miss_probes(ptr_map->ptr_old_slots,
+                                      ptr_map->old_capacity, hash);
+    }
+}
+#endif
+
+static struct abel_map_slot* map_find_slot(struct abel_map* ptr_map,
+    uint32_t hash, const char* key_str, size_t key_length)
+{
+    struct abel_map_slot* ptr_slot = NULL;
+    if (ptr_map->ptr_slots == NULL) {
+        ptr_slot = small_find_slot(ptr_map, hash, key_str, key_length);
+    } else {
+        ptr_slot = table_find_slot(ptr_map->ptr_slots, ptr_map->capacity,
+                                   hash, key_str, key_length);
+        if (ptr_slot == NULL) {
+            ptr_slot = table_find_slot(ptr_map->ptr_old_slots,
+                                       ptr_map->old_capacity,
+                                       hash, key_str, key_length);
+        }
+    }
+#ifdef ABEL_MAP_COUNTERS
+    count_lookup(ptr_map, ptr_slot, hash);
+#endif
+    return ptr_slot;
+}
+
 struct abel_map* abel_make_map_ptr()
+{
+    return abel_make_map_ptr_with_hash(abel_hash_wy, abel_hash_process_seed());
+}
+
+struct abel_map* abel_make_map_ptr_with_hash(HashFunc hash_func, uint64_t seed)
 {
     struct abel_map* ptr_map = NULL;
     ptr_map = malloc( sizeof(*ptr_map) );
-    ptr_map->ptr_pair_vector = abel_make_vector_ptr(MAP_DEFAULT_VECTOR_SIZE);
-    ptr_map->ptr_coll_vector = abel_make_vector_ptr(MAP_DEFAULT_VECTOR_SIZE);;
-    ptr_map->size = 0;
+    if (ptr_map != NULL) {
+        memset(ptr_map->small_slots, 0, sizeof(ptr_map->small_slots));
+        ptr_map->ptr_slots = NULL;
+        ptr_map->capacity = 0;
+        ptr_map->ptr_old_slots = NULL;
+        ptr_map->old_capacity = 0;
+        ptr_map->rehash_index = 0;
+        ptr_map->size = 0;
+        ptr_map->hash_func = hash_func;
+        ptr_map->hash_seed = seed;
+        ptr_map->ptr_entries = NULL;
+        ptr_map->entry_count = 0;
+        ptr_map->entry_capacity = 0;
+#ifdef ABEL_MAP_COUNTERS
+        ptr_map->lookup_count = 0;
+        ptr_map->hit_count = 0;
+        ptr_map->miss_count = 0;
+        ptr_map->probe_count = 0;
+#endif
+    }
     return ptr_map;
 }
 
+void abel_free_map_ptr(struct abel_map* ptr_map)
+{
+    struct abel_map_iterator iter = abel_map_iter_begin(ptr_map);
+    struct abel_key_value_pair* ptr_pair = NULL;
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        abel_free_pair(ptr_pair);
+    }
+    free(ptr_map->ptr_entries);
+    free(ptr_map->ptr_slots);
+    free(ptr_map->ptr_old_slots);
+    free(ptr_map);
+}
+
 size_t abel_map_size(struct abel_map* ptr_map)
 {
     return ptr_map->size;
 }
 
+size_t abel_map_capacity(struct abel_map* ptr_map)
+{
+    if (ptr_map->ptr_slots == NULL) {
+        return MAP_SMALL_CAPACITY;
+    }
+    return ptr_map->capacity;
+}
+
 /**
- * @brief Static - Resolve collision
+ * @brief Static - Move all pairs into a new table
+ *
+ * Unlike growth, which migrates pairs incrementally, all
+ * pairs are placed into the new table at once, and erased
+ * entries are dropped. Previous tables and entries are
+ * freed. A map in small mode leaves it.
  *
- * Collision resolution operates on the linked list created
- * for each key-converted index on the collision vector. It
- * is only called internally by `abel_map_insert` method.
- * 
- * @note
- *     1. Collision vector always stores the pointer to the
- *        head of the linked list. 
- * 
- * Only called internally by `abel_dict_insert` method. Argument
- * `index` must be generated by hashing function from the given
- * key string.
- * 
- * Caution
- * 
- * Always update the ref count before insertion or deletion.
+ * @param new_capacity : Slot count of the new table, a
+ *                       power of 2 larger than the size.
+ * @param entry_capacity : Entry count, not less than the size.
+ * @return Option instance. Per failure of malloc, error
+ *         MALLOC_FAILURE is returned and map is unchanged.
  */
-static struct abel_return_option resolve_collision(
-    struct abel_map* ptr_map, struct abel_vector* ptr_coll_vector,
-    size_t idx, char* key_str, void* ptr_data)
+static struct abel_return_option map_resize(struct abel_map* ptr_map,
+    size_t new_capacity, size_t entry_capacity)
 {
-    struct abel_return_option ret;
-    if (abel_vector_at(ptr_coll_vector, idx).pointer != NULL) {
-    /*  Case 0: Collisions have already been registered,
-        then search the linked list for the given key.
-    */
-        /* Get head of the linked list */
-       struct abel_linked_list* ptr_current_node
-           = abel_vector_at(ptr_coll_vector, idx).pointer;
-        Bool key_found = false;               
-        while (ptr_current_node != NULL) {
-            struct abel_key_value_pair* ptr_current_pair = ptr_current_node->ptr_data;
-            /* key found */
-            if (strcmp(ptr_current_pair->key, key_str) == 0) {
-                key_found = true;
-                break;
-            }
-            ptr_current_node = ptr_current_node->next;
-        }
-        if (key_found == false) {
-            /*  Key is not found and is thus new;
-                append new pair to the linked list
-            */
-            struct abel_key_value_pair* ptr_new_pair = make_pair_ptr(key_str, ptr_data); 
-            abel_linked_list_append(
-                abel_vector_at(ptr_coll_vector, idx).pointer, ptr_new_pair);
-            ptr_map->size++;    // increase map size
-            ret = abel_option_okay(ptr_new_pair);
-        } else {
-            /* If key is found, return KEY_EXISTS error */
-            ret = abel_option_error( error_key_exists() );
-        }
-    } else {
-    /*  Case 1: No collision has been registered, then register it.
-        Make a linked list node and store its address in collision
-        vector; the node is pointing at the pair object.
-    */
-        struct abel_key_value_pair* ptr_new_pair = make_pair_ptr(key_str, ptr_data);
-        abel_vector_emplace(ptr_coll_vector, idx,
-                            abel_make_linked_list_node(ptr_new_pair) );
-        ptr_map->size++;    // increase map size
-        ret = abel_option_okay(ptr_new_pair);
+    struct abel_map_slot* ptr_new_slots = NULL;
+    struct abel_key_value_pair** ptr_entries = NULL;
+    struct abel_map_iterator iter = abel_map_iter_begin(ptr_map);
+    struct abel_key_value_pair* ptr_pair = NULL;
+    size_t count = 0;
+    ptr_new_slots = calloc( new_capacity, sizeof(*ptr_new_slots) );
+    ptr_entries = malloc( entry_capacity * sizeof(*ptr_entries) );
+    if (ptr_new_slots == NULL || ptr_entries == NULL) {
+        free(ptr_new_slots);
+        free(ptr_entries);
+        return abel_option_error( error_malloc_failure() );
     }
-    return ret;
+    /* Hash of a pair is the hash of its slot */
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        table_place(ptr_new_slots, new_capacity, ptr_pair, ptr_pair->hash);
+        ptr_pair->entry_index = count;
+        ptr_entries[count++] = ptr_pair;
+    }
+    memset(ptr_map->small_slots, 0, sizeof(ptr_map->small_slots));
+    free(ptr_map->ptr_slots);
+    free(ptr_map->ptr_old_slots);
+    free(ptr_map->ptr_entries);
+    ptr_map->ptr_slots = ptr_new_slots;
+    ptr_map->capacity = new_capacity;
+    ptr_map->ptr_old_slots = NULL;
+    ptr_map->old_capacity = 0;
+    ptr_map->rehash_index = 0;
+    ptr_map->ptr_entries = ptr_entries;
+    ptr_map->entry_count = count;
+    ptr_map->entry_capacity = entry_capacity;
+    return abel_option_okay(NULL);
 }
 
 /**
- * @brief Static - Insert a pair into map
- * 
- * Performs the insertion. This function is invoked by
- * by public interface `abel_map_insert`.
- * 
- * @param ptr_map : Pointer to the target map
- * 
- * @param idx : Index on pair vector or collision vector.
- *              It must be converted from the `key_str` by
- *              a hashing function
- * @param key_str : Key in pair to be inserted into map
- * 
- * @param ptr_data : Pointer to the data to be associated
- *                   with the key, i.e the actual value the
- *                   pair is pointing at.
- * @return If the index has been occupied, there are further
- *         2 scenarios: (1) If given key is identical to the
- *         key of the current occupant, report KEY_EXISTS error.
- *         (2) If not, this is collision and we must resolve it.
- *         Should the key-value pair is inserted successfully,
- *         a pointer to the pair is returned.
- * @note 
- *     1. Called internally by public method `abel_map_insert`.
- *        The index must be generated from the key string by the
- *        designated hashing function.
- *     2. Insert is different from action replace, 
- */
-static struct abel_return_option map_insert(
-    struct abel_map* ptr_map, size_t idx, char* key_str, void* ptr_data)
+ * @brief Static - Smallest capacity for a number of pairs
+ *
+ * @return Smallest power of 2, not less than MAP_MIN_CAPACITY,
+ *         such that the load factor is at most `load_factor`.
+ */
+static size_t capacity_for(size_t count, double load_factor)
 {
-    struct abel_return_option ret;
-    struct abel_key_value_pair* ptr_current_pair = NULL;
-    /* current pair at given index */
-    ptr_current_pair = abel_vector_at(ptr_map->ptr_pair_vector, idx).pointer;
-    if (ptr_map->size == ptr_map->ptr_pair_vector->capacity) {
-    /* Case 0: pair vector full, map is thus full */
-        ret = abel_option_error( error_map_full() );
-    } else if (ptr_current_pair == NULL) {
-    /* Case 1: given index is not taken, therefore the key is new */
-        /* Make a pair and emplace it in map */
-        struct abel_key_value_pair* ptr_new_pair = make_pair_ptr(key_str, ptr_data);
-        abel_vector_emplace(ptr_map->ptr_pair_vector, idx, ptr_new_pair);
-        ptr_map->size++;
-        ret = abel_option_okay(ptr_new_pair);
-    } else {
-    /* Case 2: Index on vector has already been occupied */
-        if (strcmp(ptr_current_pair->key, key_str) == 0) {
-            /* Scenario 1: Existing key is identical to the given one,
-               then returns an error KEY_EXISTS. Insert is not replacement.
-            */
-            ret = abel_option_error( error_key_exists() );
-        } else {
-            /* Scenario 2: No identical key in pair vector, which means
-               two key strings are converted into the same index. Collision!
-               Now, we must resolve collision.
-            */
-            ret = resolve_collision(ptr_map, ptr_map->ptr_coll_vector, idx,
-                                    key_str, ptr_data);
-        }
+    size_t capacity = MAP_MIN_CAPACITY;
+    while ( (double)count > load_factor * (double)capacity ) {
+        capacity *= 2;
     }
-    return ret;
+    return capacity;
 }
 
-struct abel_return_option abel_map_insert(
-    struct abel_map* ptr_map, char* key_str, void* ptr_data)
+struct abel_return_option abel_map_reserve(struct abel_map* ptr_map,
+                                           size_t count)
 {
-    size_t idx = key_string_to_index(key_str);
-    return map_insert(ptr_map, idx, key_str, ptr_data);
-}
-
-/**
- * @brief Struct - Node found on linked list
- * 
- * This struct is used exclusively as a the return type
- * by the following static key-based searching functions
- * for linked list.
- * 
- * Fields
- * 
- * is_found : A Bool type. Set to `true` if the node satisfies
- *            the given criterion; set to `false` if not found.
- * 
- * node_index : Index of the found node on the original linked
- *              list. It is set to a negative number if node is
- *              not found.
- * 
- * ptr_node : Pointer to the found node. If the node is found,
- *            this pointer is not NULL; otherwise NULL.
- */
-struct node_found {
-    Bool is_found;
-    int node_index;
-    void* ptr_node;
-};
+    size_t new_capacity = capacity_for(count, MAP_MAX_LOAD_FACTOR);
+    struct abel_key_value_pair** ptr_entries = NULL;
+    if (ptr_map->ptr_slots == NULL && count <= MAP_SMALL_CAPACITY) {
+        return abel_option_okay(NULL);
+    }
+    if (new_capacity > ptr_map->capacity) {
+        return map_resize(ptr_map, new_capacity,
+                          (count > ptr_map->entry_capacity)
+                          ? count : ptr_map->entry_capacity);
+    }
+    if (count > ptr_map->entry_capacity) {
+        ptr_entries = realloc( ptr_map->ptr_entries,
+                               count * sizeof(*ptr_entries) );
+        if (ptr_entries == NULL) {
+            return abel_option_error( error_malloc_failure() );
+        }
+        ptr_map->ptr_entries = ptr_entries;
+        ptr_map->entry_capacity = count;
+    }
+    return abel_option_okay(NULL);
+}
 
 /**
- * @brief Static - Find a node on linked list by key
- * 
- * This function is used to search along a linked list to
- * find a node that is connected to a pair object with the
- * given key.
- * 
- * Seaching for a key in a dict often requires searching the
- * linked list that is used to register key collision. Each
- * node on this linked list is connect to a pair object.
- * 
- * @param ptr_head : Pointer to the head node of the linked
- *                   list.
- * @param key_str : The key to be searched along the pairs
- *                  objects connected to the linked list nodes.
- * @return A `node_found` instance.
- *         - If key exists on the linked list, flag `is_found`
- *           is true, the index of the connected node is stored
- *           in `node_index`, and the pointer to the node is
- *           stored in field `ptr_node`.
- *         - If not, flag `is_found` is `false`, `node_index` is
- *           a negative integer, and `ptr_node` is empty.
- */
-static struct node_found linked_list_find_node(
-    struct abel_linked_list* ptr_head, char* key_str)
-{
-    struct node_found ret;
-    Bool key_found = false;
-    int counter = 0;
-    struct abel_linked_list* ptr_current_node = ptr_head;
-    while (ptr_current_node != NULL) {
-        struct abel_key_value_pair* ptr_current_pair = ptr_current_node->ptr_data;
-        if (strcmp(ptr_current_pair->key, key_str) == 0) {
-            //ret = abel_option_okay(ptr_current_pair);
-            key_found = true;
-            ret.is_found = true;
-            ret.ptr_node = ptr_current_node;
-            ret.node_index = counter;
-            break;
-        }
-        counter += 1;
-        ptr_current_node = ptr_current_node->next;    /* move to next */
+ * @brief Static - Shrink a sparse table
+ *
+ * Once the load factor of the table drops below
+ * MAP_MIN_LOAD_FACTOR after erase, the table is replaced by
+ * one at most half full. Map stays as it is if malloc fails.
+ */
+static void map_shrink(struct abel_map* ptr_map)
+{
+    size_t new_capacity = 0;
+    if (ptr_map->capacity <= MAP_MIN_CAPACITY
+            || (double)ptr_map->size
+               >= MAP_MIN_LOAD_FACTOR * (double)ptr_map->capacity) {
+        return;
+    }
+    new_capacity = capacity_for(ptr_map->size, 0.5);
+    map_resize(ptr_map, new_capacity, new_capacity);
+}
+
+struct abel_return_option abel_map_compact(struct abel_map* ptr_map)
+{
+    struct abel_map_iterator iter = abel_map_iter_begin(ptr_map);
+    struct abel_key_value_pair* ptr_pair = NULL;
+    size_t count = 0;
+    if (ptr_map->ptr_slots == NULL) {
+        return abel_option_okay(NULL);
     }
-    if (key_found == false) {
-        //ret = abel_option_error( error_key_not_found() );
-        ret.is_found = false;
-        ret.ptr_node = NULL;
-        ret.node_index = -99;
+    if (ptr_map->size > MAP_SMALL_CAPACITY) {
+        return map_resize(ptr_map,
+                          capacity_for(ptr_map->size, MAP_MAX_LOAD_FACTOR),
+                          ptr_map->size);
     }
-    return ret;
+    /* Back to small mode, inline slots in insertion order */
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        ptr_map->small_slots[count++]
+            = (struct abel_map_slot){ ptr_pair, ptr_pair->hash, 1 };
+    }
+    free(ptr_map->ptr_slots);
+    free(ptr_map->ptr_old_slots);
+    free(ptr_map->ptr_entries);
+    ptr_map->ptr_slots = NULL;
+    ptr_map->capacity = 0;
+    ptr_map->ptr_old_slots = NULL;
+    ptr_map->old_capacity = 0;
+    ptr_map->rehash_index = 0;
+    ptr_map->ptr_entries = NULL;
+    ptr_map->entry_count = 0;
+    ptr_map->entry_capacity = 0;
+    return abel_option_okay(NULL);
 }
 
 /**
- * @brief Static - Find a pair on linked list by key
- * 
- * This function first calls `_find_node` to find the node
- * that has the matching key and then access the pair object
- * connected to the node.
- * 
- * @param ptr_head : Pointer to the head node of the linked
- *                   list.
- * @param key_str : The key to be searched along the linked
- *                  list.
- * @return Option instance.
- *         - If key exists (on linked list), flag is_okay is
- *           true and the pointer to the pair is stored in
- *           option.
- *         - If not, flag is_error is true and error
- *           KEY_NOT_FOUND is stored in option.
+ * @brief Static - Add the probe lengths of a table to stats
  */
-static struct abel_return_option linked_list_find_pair(
-    struct abel_linked_list* ptr_head, char* key_str)
+static void stats_add_slots(struct abel_map_stats* ptr_stats,
+    const struct abel_map_slot* ptr_slots, size_t capacity)
 {
-    struct abel_return_option ret;
+    size_t probe_length = 0;
+    for (size_t i = 0; ptr_slots != NULL && i < capacity; i++) {
+        if (abel_map_slot_is_live(&ptr_slots[i])) {
+            probe_length = ptr_slots[i].probe_length;
+            if (probe_length > ptr_stats->max_probe_length) {
+                ptr_stats->max_probe_length = probe_length;
+            }
+            ptr_stats->mean_probe_length += (double)probe_length;
+            if (probe_length > MAP_STATS_HISTOGRAM_SIZE) {
+                probe_length = MAP_STATS_HISTOGRAM_SIZE;
+            }
+            ptr_stats->probe_histogram[probe_length - 1]++;
+        }
+    }
+}
+
+struct abel_map_stats abel_map_stats(struct abel_map* ptr_map)
+{
+    struct abel_map_stats stats = { 0 };
+    struct abel_map_iterator iter = abel_map_iter_begin(ptr_map);
     struct abel_key_value_pair* ptr_pair = NULL;
-    struct node_found node = linked_list_find_node(ptr_head, key_str);
-    if (node.is_found == true) {
-        ptr_pair = ( (struct abel_linked_list*)node.ptr_node )->ptr_data;
-        ret = abel_option_okay(ptr_pair);
+    struct abel_map_slot small_slot = { NULL, 0, 0 };
+    stats.size = ptr_map->size;
+    stats.capacity = abel_map_capacity(ptr_map);
+    stats.load_factor = (double)stats.size / (double)stats.capacity;
+    if (ptr_map->ptr_slots == NULL) {
+        /* Small mode, a key is found after probing the ones before it */
+        for (size_t i = 0; i < ptr_map->size; i++) {
+            small_slot = ptr_map->small_slots[i];
+            small_slot.probe_length = (uint32_t)(i + 1);
+            stats_add_slots(&stats, &small_slot, 1);
+        }
     } else {
-        ret = abel_option_error( error_key_not_found() );
+        stats_add_slots(&stats, ptr_map->ptr_slots, ptr_map->capacity);
+        stats_add_slots(&stats, ptr_map->ptr_old_slots, ptr_map->old_capacity);
     }
-    return ret;
+    if (stats.size > 0) {
+        stats.mean_probe_length /= (double)stats.size;
+    }
+    stats.bytes = sizeof(*ptr_map)
+            + (ptr_map->capacity + ptr_map->old_capacity)
+              * sizeof(struct abel_map_slot)
+            + ptr_map->entry_capacity * sizeof(*ptr_map->ptr_entries);
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        stats.bytes += sizeof(*ptr_pair);
+        if (ptr_pair->key == ptr_pair->key_chars) {
+            stats.bytes += ptr_pair->key_length + 1;
+        }
+    }
+#ifdef ABEL_MAP_COUNTERS
+    stats.lookup_count = ptr_map->lookup_count;
+    stats.hit_count = ptr_map->hit_count;
+    stats.miss_count = ptr_map->miss_count;
+    stats.probe_count = ptr_map->probe_count;
+#endif
+    return stats;
 }
 
-struct abel_return_option abel_map_find(struct abel_map* ptr_map, char* key_str)
+/**
+ * @brief Static - Double the entries
+ *
+ * @return Option instance. Per failure of realloc, error
+ *         MALLOC_FAILURE is returned and map is unchanged.
+ */
+static struct abel_return_option map_grow_entries(struct abel_map* ptr_map)
+{
+    size_t new_capacity = 2 * ptr_map->entry_capacity;
+    struct abel_key_value_pair** ptr_entries
+            = realloc( ptr_map->ptr_entries,
+                       new_capacity * sizeof(*ptr_entries) );
+    if (ptr_entries == NULL) {
+        return abel_option_error( error_malloc_failure() );
+    }
+    ptr_map->ptr_entries = ptr_entries;
+    ptr_map->entry_capacity = new_capacity;
+    return abel_option_okay(NULL);
+}
+
+/**
+ * @brief Static - Remove a pair from the entries
+ *
+ * Entry of the pair is set to NULL. Once more than half of
+ * the entries are erased, the remaining ones are moved to
+ * the front, keeping their order.
+ */
+static void map_remove_entry(struct abel_map* ptr_map,
+    struct abel_key_value_pair* ptr_pair)
+{
+    size_t count = 0;
+    ptr_map->ptr_entries[ptr_pair->entry_index] = NULL;
+    if (2 * ptr_map->size >= ptr_map->entry_count) {
+        return;
+    }
+    for (size_t i = 0; i < ptr_map->entry_count; i++) {
+        if (ptr_map->ptr_entries[i] != NULL) {
+            ptr_map->ptr_entries[count] = ptr_map->ptr_entries[i];
+            ptr_map->ptr_entries[count]->entry_index = count;
+            count++;
+        }
+    }
+    ptr_map->entry_count = count;
+}
+
+/**
+ * @brief Static - Insert a key of given hash
+ *
+ * @param is_interned True if key is an interned key, which
+ *        is then referred to instead of copied.
+ */
+static struct abel_return_option map_insert_key(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length, uint32_t hash,
+    Bool is_interned, void* ptr_data)
 {
     struct abel_return_option ret;
-    size_t idx = key_string_to_index(key_str);
-    Bool key_found = false;
-    if (ptr_map->ptr_pair_vector->ptr_array[idx] != NULL) {
-    /* Case 0: Index is occupied */
-        struct abel_key_value_pair* ptr_this_pair = ptr_map->ptr_pair_vector->ptr_array[idx];
-        if (strcmp(ptr_this_pair->key, key_str) == 0) {
-        /* key exists in pair vector */
-            key_found = true;
-            ret = abel_option_okay(ptr_this_pair);
-            return ret;
-        } else {
-        /* key may exist on collision vector */
-            if (ptr_map->ptr_coll_vector->ptr_array[idx] != NULL) {
-            /* given index on collision vector is occupied */
-                ret = linked_list_find_pair(
-                        ptr_map->ptr_coll_vector->ptr_array[idx], key_str);
+    struct abel_key_value_pair* ptr_new_pair = NULL;
+    if (key_length > UINT32_MAX) {
+        return abel_option_error( error_out_of_range() );
+    }
+    if (map_find_slot(ptr_map, hash, key_str, key_length) != NULL) {
+        /* Insert is not replacement, returns KEY_EXISTS error */
+        return abel_option_error( error_key_exists() );
+    }
+    if (ptr_map->ptr_slots != NULL || ptr_map->size == MAP_SMALL_CAPACITY) {
+        if ( (double)(ptr_map->size + 1)
+                > MAP_MAX_LOAD_FACTOR * (double)ptr_map->capacity ) {
+            ret = map_grow(ptr_map);
+            if (ret.is_error == true) {
                 return ret;
-            } else {
-            /* no collision has been registered */
-                ret = abel_option_error(error_key_not_found());
+            }
+        }
+        if (ptr_map->entry_count == ptr_map->entry_capacity) {
+            ret = map_grow_entries(ptr_map);
+            if (ret.is_error == true) {
                 return ret;
             }
         }
+    }
+    ptr_new_pair = make_pair_ptr(key_str, key_length, hash, ptr_data,
+                                 is_interned);
+    if (ptr_new_pair == NULL) {
+        return abel_option_error( error_malloc_failure() );
+    }
+    if (is_interned == true) {
+        /* pair holds a reference to the interned key */
+        add_interned_key_ref(key_str);
+    }
+    if (ptr_map->ptr_slots == NULL) {
+        /* Small mode, append to the inline slots */
+        ptr_map->small_slots[ptr_map->size]
+            = (struct abel_map_slot){ ptr_new_pair, hash, 1 };
+        ptr_map->size++;
+        return abel_option_okay(ptr_new_pair);
+    }
+    table_place(ptr_map->ptr_slots, ptr_map->capacity, ptr_new_pair, hash);
+    ptr_new_pair->entry_index = ptr_map->entry_count;
+    ptr_map->ptr_entries[ptr_map->entry_count++] = ptr_new_pair;
+    ptr_map->size++;
+    map_rehash_step(ptr_map, MAP_REHASH_STEP);
+    return abel_option_okay(ptr_new_pair);
+}
+
+struct abel_return_option abel_map_insert(
+    struct abel_map* ptr_map, char* key_str, void* ptr_data)
+{
+    return abel_map_insert_n(ptr_map, key_str, strlen(key_str), ptr_data);
+}
+
+struct abel_return_option abel_map_insert_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length, void* ptr_data)
+{
+    return map_insert_key(ptr_map, key_str, key_length,
+                          hash_key_string(ptr_map, key_str, key_length),
+                          false, ptr_data);
+}
+
+/**
+ * @brief Static - Hash of an interned key in a map
+ *
+ * Hash kept with the interned key is reused if the map hashes
+ * keys the same way as the table of interned keys.
+ */
+static uint32_t interned_key_hash(const struct abel_map* ptr_map,
+    const char* interned_key)
+{
+    struct abel_key_value_pair* ptr_interned = interned_pair(interned_key);
+    if (ptr_map->hash_func != ptr_interned_keys->hash_func
+            || ptr_map->hash_seed != ptr_interned_keys->hash_seed) {
+        return hash_key_string(ptr_map, interned_key, ptr_interned->key_length);
+    }
+    return ptr_interned->hash;
+}
+
+struct abel_return_option abel_map_insert_interned(
+    struct abel_map* ptr_map, const char* interned_key, void* ptr_data)
+{
+    return map_insert_key(ptr_map, interned_key,
+                          interned_pair(interned_key)->key_length,
+                          interned_key_hash(ptr_map, interned_key),
+                          true, ptr_data);
+}
+
+struct abel_return_option abel_map_find(struct abel_map* ptr_map, char* key_str)
+{
+    return abel_map_find_n(ptr_map, key_str, strlen(key_str));
+}
+
+struct abel_return_option abel_map_find_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length)
+{
+    uint32_t hash = hash_key_string(ptr_map, key_str, key_length);
+    struct abel_map_slot* ptr_slot
+            = map_find_slot(ptr_map, hash, key_str, key_length);
+    if (ptr_slot != NULL) {
+        return abel_option_okay(ptr_slot->ptr_pair);
     } else {
-    /* Case 1: Index is not occupied, definitely not found */
-        ret = abel_option_error(error_key_not_found());
-        return ret;
+        return abel_option_error( error_key_not_found() );
     }
 }
 
+struct abel_return_option abel_map_find_interned(struct abel_map* ptr_map,
+    const char* interned_key, size_t* ptr_slot_hint)
+{
+    struct abel_map_slot* ptr_slot = NULL;
+    size_t hint = *ptr_slot_hint;
+    size_t key_length = interned_pair(interned_key)->key_length;
+    uint32_t hash = interned_key_hash(ptr_map, interned_key);
+    if (ptr_map->ptr_slots == NULL) {
+        if (hint < ptr_map->size) {
+            ptr_slot = &ptr_map->small_slots[hint];
+        }
+    } else if (hint < ptr_map->capacity
+            && abel_map_slot_is_live(&ptr_map->ptr_slots[hint])) {
+        ptr_slot = &ptr_map->ptr_slots[hint];
+    }
+    if (ptr_slot != NULL && ptr_slot->hash == hash
+            && pair_has_key(ptr_slot->ptr_pair, hash, interned_key, key_length)) {
+#ifdef ABEL_MAP_COUNTERS
+        count_lookup(ptr_map, ptr_slot, hash);
+#endif
+        return abel_option_okay(ptr_slot->ptr_pair);
+    }
+    ptr_slot = map_find_slot(ptr_map, hash, interned_key, key_length);
+    if (ptr_slot == NULL) {
+        return abel_option_error( error_key_not_found() );
+    }
+    if (ptr_map->ptr_slots == NULL) {
+        *ptr_slot_hint = ptr_slot - ptr_map->small_slots;
+    } else if (ptr_slot >= ptr_map->ptr_slots
+            && ptr_slot < ptr_map->ptr_slots + ptr_map->capacity) {
+        *ptr_slot_hint = ptr_slot - ptr_map->ptr_slots;
+    }
+    return abel_option_okay(ptr_slot->ptr_pair);
+}
+
 struct abel_return_option abel_map_at(struct abel_map* ptr_map, char* key_str)
+{
+    return abel_map_at_n(ptr_map, key_str, strlen(key_str));
+}
+
+struct abel_return_option abel_map_at_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length)
 {
     struct abel_return_option ret;
-    ret = abel_map_find(ptr_map, key_str);
+    ret = abel_map_find_n(ptr_map, key_str, key_length);
     if (ret.is_okay == true) {
         ret.pointer = ( (struct abel_key_value_pair*)ret.pointer )->ptr_data;
     }
@@ -393,74 +971,364 @@ struct abel_return_option abel_map_assign(
 }
 
 struct abel_return_option abel_map_erase(struct abel_map* ptr_map, char* key_str)
+{
+    return abel_map_erase_n(ptr_map, key_str, strlen(key_str));
+}
+
+struct abel_return_option abel_map_erase_n(struct abel_map* ptr_map,
+    const char* key_str, size_t key_length)
 {
     struct abel_return_option ret;
-    size_t idx = key_string_to_index(key_str);
-    Bool key_found = false;
-    struct node_found node;
-    struct abel_key_value_pair* ptr_target_pair = abel_vector_at(ptr_map->ptr_pair_vector, idx).pointer;
-    if (ptr_target_pair != NULL) {
-    /* Case 0: Index is occupied */
-        if (strcmp(ptr_target_pair->key, key_str) == 0) {
-        /* Case 0.1 key exists in pair vector */
-            key_found = true;
-            ret = abel_option_okay(ptr_target_pair);
-            /* set corresponding index on vector to empty */
-            abel_vector_emplace(ptr_map->ptr_pair_vector, idx, NULL);
-            /* adjust map size */
-            ptr_map->size--;
-            return ret;
-        } else {
-        /* Caes 0.2 key may exist on collision vector */
-            struct abel_linked_list* ptr_head
-                = abel_vector_at(ptr_map->ptr_coll_vector,idx).pointer;
-            if (ptr_head != NULL) {
-            /* given index on collision vector is occupied */
-                node = linked_list_find_node(ptr_head, key_str);
-                if (node.is_found == true) {
-                    /*
-                        Erase and free the returned node. Note that the node
-                        found in the above is identical to the node that is
-                        to be erased.
-                    */
-                    struct abel_return_option ret_erase
-                        = abel_linked_list_erase(&ptr_head, node.node_index);
-                    if (ret_erase.is_okay == true && ptr_head == NULL) {
-                        /*
-                            Should the ptr_head be NULL, the only node is erased.
-                            In this case, the element on the collision vector
-                            is set to NULL, as the connected linked list is
-                            erase completely. Then, the pair attached to the
-                            only node is returned.
-                        */
-                        abel_vector_emplace(ptr_map->ptr_coll_vector, idx, NULL);
-                        ret = abel_option_okay( ((struct abel_linked_list*)node.ptr_node)->ptr_data );
-                        free(ret_erase.pointer);
-                    } else {
-                        /*
-                            Looks like the linked list has more than one node.
-                            In this case, the collision vector must register
-                            the new head node and return the pair from old node.
-                        */
-                        abel_vector_emplace(ptr_map->ptr_coll_vector, idx, ptr_head);
-                        ret = abel_option_okay( ((struct abel_linked_list*)node.ptr_node)->ptr_data );
-                    }
-                    /* in any case, adjust map size */
-                    ptr_map->size--;
-                } else {
-                    ret = abel_option_error( error_key_not_found() );
-                }
-                return ret;
-            } else {
-            /* no collision has been registered */
-                ret = abel_option_error( error_key_not_found() );
-                return ret;
+    uint32_t hash = hash_key_string(ptr_map, key_str, key_length);
+    struct abel_map_slot* ptr_slot = NULL;
+    size_t idx = 0;
+    ptr_slot = map_find_slot(ptr_map, hash, key_str, key_length);
+    if (ptr_slot == NULL) {
+        return abel_option_error( error_key_not_found() );
+    }
+    ret = abel_option_okay(ptr_slot->ptr_pair);
+    if (ptr_map->ptr_slots == NULL) {
+        /* Small mode, close the gap to keep insertion order */
+        idx = ptr_slot - ptr_map->small_slots;
+        memmove(ptr_slot, ptr_slot + 1,
+                (ptr_map->size - idx - 1) * sizeof(*ptr_slot));
+        ptr_map->size--;
+        ptr_map->small_slots[ptr_map->size] = (struct abel_map_slot){ NULL, 0, 0 };
+        return ret;
+    }
+    if (ptr_slot >= ptr_map->ptr_slots
+            && ptr_slot < ptr_map->ptr_slots + ptr_map->capacity) {
+    /* Case 0: key is in the current table */
+        table_remove_slot(ptr_map->ptr_slots, ptr_map->capacity, ptr_slot);
+    } else {
+    /* Case 1: key is yet to be migrated, mark its slot as migrated */
+        ptr_slot->ptr_pair = &MIGRATED_PAIR;
+    }
+    ptr_map->size--;
+    map_remove_entry(ptr_map, ret.pointer);
+    map_rehash_step(ptr_map, MAP_REHASH_STEP);
+    map_shrink(ptr_map);
+    return ret;
+}
+
+void abel_map_clear(struct abel_map* ptr_map)
+{
+    struct abel_map_iterator iter = abel_map_iter_begin(ptr_map);
+    struct abel_key_value_pair* ptr_pair = NULL;
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        abel_free_pair(ptr_pair);
+    }
+    memset(ptr_map->small_slots, 0, sizeof(ptr_map->small_slots));
+    if (ptr_map->ptr_slots != NULL) {
+        memset(ptr_map->ptr_slots, 0,
+               ptr_map->capacity * sizeof(*ptr_map->ptr_slots));
+    }
+    /* nothing is left to migrate */
+    free(ptr_map->ptr_old_slots);
+    ptr_map->ptr_old_slots = NULL;
+    ptr_map->old_capacity = 0;
+    ptr_map->rehash_index = 0;
+    ptr_map->entry_count = 0;
+    ptr_map->size = 0;
+}
+
+struct abel_map_iterator abel_map_iter_begin(struct abel_map* ptr_map)
+{
+    struct abel_map_iterator iter = { ptr_map, 0 };
+    return iter;
+}
+
+struct abel_key_value_pair* abel_map_iter_next(
+    struct abel_map_iterator* ptr_iter)
+{
+    struct abel_map* ptr_map = ptr_iter->ptr_map;
+    struct abel_key_value_pair* ptr_pair = NULL;
+    if (ptr_map->ptr_slots == NULL) {
+        if (ptr_iter->index < ptr_map->size) {
+            ptr_pair = ptr_map->small_slots[ptr_iter->index++].ptr_pair;
+        }
+        return ptr_pair;
+    }
+    while (ptr_pair == NULL && ptr_iter->index < ptr_map->entry_count) {
+        ptr_pair = ptr_map->ptr_entries[ptr_iter->index++];
+    }
+    return ptr_pair;
+}
+
+const char* abel_intern_key(const char* key_str)
+{
+    return abel_intern_key_n(key_str, strlen(key_str));
+}
+
+/**
+ * @brief Static - Intern a key
+ *
+ * Called with the shared tables locked.
+ */
+static const char* intern_key(const char* key_str, size_t key_length)
+{
+    struct abel_return_option ret;
+    struct interned_ref_count* ptr_count = NULL;
+    if (ptr_interned_keys == NULL) {
+        ptr_interned_keys = abel_make_map_ptr();
+        if (ptr_interned_keys == NULL) {
+            return NULL;
+        }
+    }
+    ret = abel_map_find_n(ptr_interned_keys, key_str, key_length);
+    if (ret.is_okay == true) {
+        add_interned_key_ref(((struct abel_key_value_pair*)ret.pointer)->key);
+        return ((struct abel_key_value_pair*)ret.pointer)->key;
+    }
+    ptr_count = malloc( sizeof(*ptr_count) );
+    if (ptr_count == NULL) {
+        return NULL;
+    }
+    ret = abel_map_insert_n(ptr_interned_keys, key_str, key_length, ptr_count);
+    if (ret.is_error == true) {
+        free(ptr_count);
+        return NULL;
+    }
+#ifdef ABEL_ATOMIC_REF_COUNT
+    atomic_init(&ptr_count->count, 1);
+#else
+    ptr_count->count = 1;
+#endif
+    return ((struct abel_key_value_pair*)ret.pointer)->key;
+}
+
+const char* abel_intern_key_n(const char* key_str, size_t key_length)
+{
+    const char* interned_key = NULL;
+    lock_tables();
+    interned_key = intern_key(key_str, key_length);
+    unlock_tables();
+    return interned_key;
+}
+
+void abel_release_interned_key(const char* interned_key)
+{
+    struct abel_key_value_pair* ptr_interned = interned_pair(interned_key);
+    struct interned_ref_count* ptr_count = ptr_interned->ptr_data;
+    size_t ref_count = 0;
+    lock_tables();
+    /* others may take references meanwhile, but not drop the last */
+#ifdef ABEL_ATOMIC_REF_COUNT
+    ref_count = atomic_fetch_sub_explicit(&ptr_count->count, 1,
+                                          memory_order_acq_rel) - 1;
+#else
+    ref_count = --ptr_count->count;
+#endif
+    if (ref_count == 0) {
+        free(ptr_count);
+        abel_free_pair( abel_map_erase_n(ptr_interned_keys, ptr_interned->key,
+                                         ptr_interned->key_length).pointer );
+        if (abel_map_size(ptr_interned_keys) == 0) {
+            abel_free_map_ptr(ptr_interned_keys);
+            ptr_interned_keys = NULL;
+        }
+    }
+    unlock_tables();
+}
+
+size_t abel_interned_key_count()
+{
+    size_t count = 0;
+    lock_tables();
+    if (ptr_interned_keys != NULL) {
+        count = abel_map_size(ptr_interned_keys);
+    }
+    unlock_tables();
+    return count;
+}
+
+const char* abel_find_interned_key(const char* key_str)
+{
+    return abel_find_interned_key_n(key_str, strlen(key_str));
+}
+
+const char* abel_find_interned_key_n(const char* key_str, size_t key_length)
+{
+    struct abel_return_option ret;
+    const char* interned_key = NULL;
+    lock_tables();
+    if (ptr_interned_keys != NULL) {
+        ret = abel_map_find_n(ptr_interned_keys, key_str, key_length);
+        if (ret.is_okay == true) {
+            interned_key = ((struct abel_key_value_pair*)ret.pointer)->key;
+        }
+    }
+    unlock_tables();
+    return interned_key;
+}
+
+/**
+ * @brief Static - Make a shape
+ *
+ * Shape holds a reference to its parent and to its last
+ * key, and its caller holds the reference it returns.
+ * Called with the shared tables locked.
+ *
+ * @return Pointer to the shape, or NULL if malloc fails.
+ */
+static struct abel_key_shape* make_key_shape_ptr(
+    struct abel_key_shape* ptr_parent, const char* interned_key)
+{
+    struct abel_key_shape* ptr_shape = malloc( sizeof(*ptr_shape) );
+    size_t size = (ptr_parent == NULL) ? 0 : ptr_parent->size + 1;
+    if (ptr_shape == NULL) {
+        return NULL;
+    }
+    ptr_shape->ptr_keys = NULL;
+    if (size > 0) {
+        ptr_shape->ptr_keys = malloc( size * sizeof(*ptr_shape->ptr_keys) );
+        if (ptr_shape->ptr_keys == NULL) {
+            free(ptr_shape);
+            return NULL;
+        }
+        for (size_t i = 0; i + 1 < size; i++) {
+            ptr_shape->ptr_keys[i] = ptr_parent->ptr_keys[i];
+        }
+        ptr_shape->ptr_keys[size - 1] = interned_key;
+        add_interned_key_ref(interned_key);
+        ptr_parent->ref_count++;
+    }
+    ptr_shape->ref_count = 1;
+    ptr_shape->id = next_shape_id++;
+    ptr_shape->size = size;
+    ptr_shape->ptr_parent = ptr_parent;
+    ptr_shape->ptr_transitions = NULL;
+    return ptr_shape;
+}
+
+/**
+ * @brief Static - Find child shape
+ *
+ * @return Child reached by the interned key, or NULL if
+ *         the shape has no such child yet.
+ */
+static struct abel_key_shape* find_child_shape(
+    const struct abel_key_shape* ptr_shape, const char* interned_key)
+{
+    struct abel_key_value_pair* ptr_interned = interned_pair(interned_key);
+    struct abel_map_slot* ptr_slot = NULL;
+    if (ptr_shape->ptr_transitions == NULL) {
+        return NULL;
+    }
+    /* transitions hash keys the same way as the table of interned keys */
+    ptr_slot = map_find_slot(ptr_shape->ptr_transitions, ptr_interned->hash,
+                             interned_key, ptr_interned->key_length);
+    if (ptr_slot == NULL) {
+        return NULL;
+    }
+    return ptr_slot->ptr_pair->ptr_data;
+}
+
+struct abel_key_shape* abel_key_shape_add_key(
+    struct abel_key_shape* ptr_shape, const char* interned_key)
+{
+    struct abel_key_shape* ptr_child = NULL;
+    struct abel_key_shape* ptr_parent = ptr_shape;
+    lock_tables();
+    if (ptr_parent == NULL) {
+        if (ptr_root_shape == NULL) {
+            ptr_root_shape = make_key_shape_ptr(NULL, NULL);
+            if (ptr_root_shape == NULL) {
+                unlock_tables();
+                return NULL;
             }
+        } else {
+            ptr_root_shape->ref_count++;
         }
+        ptr_parent = ptr_root_shape;
+    }
+    ptr_child = find_child_shape(ptr_parent, interned_key);
+    if (ptr_child != NULL) {
+        ptr_child->ref_count++;
     } else {
-    /* Case 1: Index is not occupied, definitely not found */
-        ret = abel_option_error( error_key_not_found() );
-        return ret;
+        if (ptr_parent->ptr_transitions == NULL) {
+            ptr_parent->ptr_transitions = abel_make_map_ptr();
+        }
+        if (ptr_parent->ptr_transitions != NULL) {
+            ptr_child = make_key_shape_ptr(ptr_parent, interned_key);
+        }
+        if (ptr_child != NULL
+                && abel_map_insert_interned(ptr_parent->ptr_transitions,
+                       interned_key, ptr_child).is_error == true) {
+            abel_release_key_shape(ptr_child);
+            ptr_child = NULL;
+        }
     }
-    return ret;
+    if (ptr_shape == NULL) {
+        /* reference to the root is held by the child only */
+        abel_release_key_shape(ptr_parent);
+    }
+    unlock_tables();
+    return ptr_child;
+}
+
+Bool abel_key_shape_find(const struct abel_key_shape* ptr_shape,
+    const char* key_str, size_t* ptr_index)
+{
+    return abel_key_shape_find_n(ptr_shape, key_str, strlen(key_str),
+                                 ptr_index);
+}
+
+Bool abel_key_shape_find_n(const struct abel_key_shape* ptr_shape,
+    const char* key_str, size_t key_length, size_t* ptr_index)
+{
+    const char* shape_key = NULL;
+    /* interned key of the shape is found by pointer */
+    for (size_t i = 0; i < ptr_shape->size; i++) {
+        if (ptr_shape->ptr_keys[i] == key_str
+                && interned_pair(key_str)->key_length == key_length) {
+            *ptr_index = i;
+            return true;
+        }
+    }
+    /* keys held by a shape are immutable, compare chars without lock */
+    for (size_t i = 0; i < ptr_shape->size; i++) {
+        shape_key = ptr_shape->ptr_keys[i];
+        if (interned_pair(shape_key)->key_length == key_length
+                && memcmp(shape_key, key_str, key_length) == 0) {
+            *ptr_index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void abel_release_key_shape(struct abel_key_shape* ptr_shape)
+{
+    struct abel_key_shape* ptr_parent = NULL;
+    const char* last_key = NULL;
+    lock_tables();
+    ptr_shape->ref_count--;
+    if (ptr_shape->ref_count > 0) {
+        unlock_tables();
+        return;
+    }
+    ptr_parent = ptr_shape->ptr_parent;
+    if (ptr_parent == NULL) {
+        ptr_root_shape = NULL;
+    } else {
+        last_key = ptr_shape->ptr_keys[ptr_shape->size - 1];
+        /* shape may die before it is linked to its parent */
+        if (find_child_shape(ptr_parent, last_key) == ptr_shape) {
+            abel_free_pair( abel_map_erase_n(ptr_parent->ptr_transitions, last_key,
+                                interned_pair(last_key)->key_length).pointer );
+        }
+        if (abel_map_size(ptr_parent->ptr_transitions) == 0) {
+            abel_free_map_ptr(ptr_parent->ptr_transitions);
+            ptr_parent->ptr_transitions = NULL;
+        }
+        abel_release_interned_key(last_key);
+    }
+    /* transitions are empty, as each child refers to its parent */
+    free(ptr_shape->ptr_keys);
+    free(ptr_shape);
+    if (ptr_parent != NULL) {
+        abel_release_key_shape(ptr_parent);
+    }
+    unlock_tables();
 }
\ No newline at end of file
@@ -16,7 +16,7 @@ static struct abel_object* make_object_pointer_on_heap(
         ptr_object->ptr_data = ptr_data;
         ptr_object->data_size = data_size;
         ptr_object->data_type = data_type;
-        ptr_object->ref_count = 0;
+        ABEL_OBJECT_INIT_REF_COUNT(ptr_object, 0);
         return ptr_object;
     } else {
         return NULL;
@@ -26,12 +26,12 @@ static struct abel_object* make_object_pointer_on_heap(
 /* Bool */
 struct abel_object* abel_make_object_ptr_from_bool_ptr(Bool* ptr_src_data)
 {
-    Bool* ptr_data = NULL;
-    struct abel_object* ptr_object = NULL;
-    ptr_data = malloc( sizeof(*ptr_data) );
-    *ptr_data = *ptr_src_data;    // copy data via ptr
-    ptr_object = make_object_pointer_on_heap(
-            ptr_data, sizeof(*ptr_data), BOOL_TYPE);
+    struct abel_object* ptr_object = make_object_pointer_on_heap(
+            NULL, sizeof(*ptr_src_data), BOOL_TYPE);
+    if (ptr_object != NULL) {
+        ptr_object->value.bool_value = *ptr_src_data;    // copy data inline
+        ptr_object->ptr_data = &ptr_object->value;
+    }
     return ptr_object;
 }
 
@@ -43,12 +43,12 @@ struct abel_object* abel_make_object_ptr_from_bool(Bool src_data)
 /* Null */
 struct abel_object* abel_make_object_ptr_from_null_ptr(Null* ptr_src_data)
 {
-    Null* ptr_data = NULL;
-    struct abel_object* ptr_object = NULL;
-    ptr_data = malloc( sizeof(*ptr_data) );
-    *ptr_data = *ptr_src_data;    // copy data via ptr
-    ptr_object = make_object_pointer_on_heap(
-            ptr_data, sizeof(*ptr_data), NULL_TYPE);
+    struct abel_object* ptr_object = make_object_pointer_on_heap(
+            NULL, sizeof(*ptr_src_data), NULL_TYPE);
+    if (ptr_object != NULL) {
+        ptr_object->value.null_value = *ptr_src_data;    // copy data inline
+        ptr_object->ptr_data = &ptr_object->value;
+    }
     return ptr_object;
 }
 
@@ -74,12 +74,12 @@ struct abel_object* abel_make_object_ptr_from_string(char* src_str)
 /* int */
 struct abel_object* abel_make_object_ptr_from_int_ptr(int* ptr_src_data)
 {
-    int* ptr_data = NULL;
-    struct abel_object* ptr_object = NULL;
-    ptr_data = malloc( sizeof(*ptr_data) );
-    *ptr_data = *ptr_src_data;    // copy data via ptr
-    ptr_object = make_object_pointer_on_heap(
-            ptr_data, sizeof(*ptr_data), INTEGER_TYPE);
+    struct abel_object* ptr_object = make_object_pointer_on_heap(
+            NULL, sizeof(*ptr_src_data), INTEGER_TYPE);
+    if (ptr_object != NULL) {
+        ptr_object->value.int_value = *ptr_src_data;    // copy data inline
+        ptr_object->ptr_data = &ptr_object->value;
+    }
     return ptr_object;
 }
 
@@ -91,12 +91,12 @@ struct abel_object* abel_make_object_ptr_from_int(int src_data)
 /* double */
 struct abel_object* abel_make_object_ptr_from_double_ptr(double* ptr_src_data)
 {
-    double* ptr_data = NULL;
-    struct abel_object* ptr_object = NULL;
-    ptr_data = malloc( sizeof(*ptr_data) );
-    *ptr_data = *ptr_src_data;    // copy data
-    ptr_object = make_object_pointer_on_heap(
-            ptr_data, sizeof(*ptr_data), DOUBLE_TYPE);
+    struct abel_object* ptr_object = make_object_pointer_on_heap(
+            NULL, sizeof(*ptr_src_data), DOUBLE_TYPE);
+    if (ptr_object != NULL) {
+        ptr_object->value.double_value = *ptr_src_data;    // copy data inline
+        ptr_object->ptr_data = &ptr_object->value;
+    }
     return ptr_object;
 }
 
@@ -127,12 +127,12 @@ struct abel_object* abel_make_object_ptr_from_dict_ptr(struct abel_dict* ptr_src
 
 Bool abel_object_get_bool(struct abel_object* ptr_obj)
 {
-    return *(Bool*)(ptr_obj->ptr_data);
+    return ptr_obj->value.bool_value;
 }
 
 Null abel_object_get_null(struct abel_object* ptr_obj)
 {
-    return *(Null*)(ptr_obj->ptr_data);
+    return ptr_obj->value.null_value;
 }
 
 char* abel_object_get_string(struct abel_object* ptr_obj)
@@ -142,12 +142,122 @@ char* abel_object_get_string(struct abel_object* ptr_obj)
 
 int abel_object_get_int(struct abel_object* ptr_obj)
 {
-    return *(int*)(ptr_obj->ptr_data);
+    return ptr_obj->value.int_value;
 }
 
 double abel_object_get_double(struct abel_object* ptr_obj)
 {
-    return *(double*)(ptr_obj->ptr_data);
+    return ptr_obj->value.double_value;
+}
+
+/* Immortal objects */
+
+static struct abel_object null_object = {
+    .ptr_data = &null_object.value,
+    .value.null_value = null,
+    .data_type = NULL_TYPE,
+    .data_size = sizeof(Null),
+    .ref_count = OBJECT_IMMORTAL_REF_COUNT
+};
+
+static struct abel_object bool_objects[2] = {
+    {
+        .ptr_data = &bool_objects[0].value,
+        .value.bool_value = false,
+        .data_type = BOOL_TYPE,
+        .data_size = sizeof(Bool),
+        .ref_count = OBJECT_IMMORTAL_REF_COUNT
+    },
+    {
+        .ptr_data = &bool_objects[1].value,
+        .value.bool_value = true,
+        .data_type = BOOL_TYPE,
+        .data_size = sizeof(Bool),
+        .ref_count = OBJECT_IMMORTAL_REF_COUNT
+    }
+};
+
+struct abel_object* abel_null_object_ptr()
+{
+    return &null_object;
+}
+
+struct abel_object* abel_bool_object_ptr(Bool value)
+{
+    return &bool_objects[value == false ? 0 : 1];
+}
+
+/* References */
+
+/**
+ * @brief Static - Read ref count
+ *
+ * Relaxed in the atomic mode, as the value is only compared
+ * against the immortal count or used by the only holder.
+ */
+static size_t load_ref_count(struct abel_object* ptr_obj)
+{
+#ifdef ABEL_ATOMIC_REF_COUNT
+    return atomic_load_explicit(&ptr_obj->ref_count, memory_order_relaxed);
+#else
+    return ptr_obj->ref_count;
+#endif
+}
+
+/**
+ * @brief Static - Drop a reference
+ *
+ * @return True if the dropped reference was the last one
+ *         and the object shall be freed.
+ * @note The sole holder needs no decrement, since no other
+ *       thread can reach the object to add a reference.
+ *       Acquire makes writes of the former holders visible
+ *       before the object is freed.
+ */
+static Bool release_ref(struct abel_object* ptr_obj)
+{
+#ifdef ABEL_ATOMIC_REF_COUNT
+    if (atomic_load_explicit(&ptr_obj->ref_count, memory_order_acquire) == 1) {
+        return true;
+    }
+    return (atomic_fetch_sub_explicit(&ptr_obj->ref_count, 1,
+                                      memory_order_acq_rel) == 1);
+#else
+    if (ptr_obj->ref_count == 1) {
+        return true;
+    }
+    ptr_obj->ref_count -= 1;
+    return false;
+#endif
+}
+
+Bool abel_object_is_immortal(struct abel_object* ptr_obj)
+{
+    return (load_ref_count(ptr_obj) == OBJECT_IMMORTAL_REF_COUNT);
+}
+
+void abel_object_add_ref(struct abel_object* ptr_obj)
+{
+    if (load_ref_count(ptr_obj) != OBJECT_IMMORTAL_REF_COUNT) {
+#ifdef ABEL_ATOMIC_REF_COUNT
+        atomic_fetch_add_explicit(&ptr_obj->ref_count, 1, memory_order_relaxed);
+#else
+        ptr_obj->ref_count += 1;
+#endif
+    }
+}
+
+void abel_object_add_ref_local(struct abel_object* ptr_obj)
+{
+    size_t ref_count = load_ref_count(ptr_obj);
+    if (ref_count != OBJECT_IMMORTAL_REF_COUNT) {
+#ifdef ABEL_ATOMIC_REF_COUNT
+        atomic_store_explicit(&ptr_obj->ref_count, ref_count + 1,
+                              memory_order_relaxed);
+#else
+        ptr_obj->ref_count = ref_count + 1;
+#endif
+    }
 }
 
 /* Get container pointer */
@@ -178,7 +288,10 @@ char* abel_object_get_type_string(struct abel_object* ptr_obj)
 struct abel_return_option abel_free_list_ptr(struct abel_list* ptr_list)
 {
     struct abel_return_option ret;
-    if (ptr_list != NULL) {    // no need to free empty pointer
+    if (ptr_list != NULL && ptr_list->is_read_only == true) {
+        /* storage is owned by a document */
+        ret = abel_option_error( error_read_only() );
+    } else if (ptr_list != NULL) {    // no need to free empty pointer
         for (int i = 0; i < ptr_list->ptr_vector->size; i++) {
             if (ptr_list->ptr_vector->ptr_array[i] != NULL) {
                 ret = abel_free_object_ptr(ptr_list->ptr_vector->ptr_array[i]);
@@ -196,56 +309,32 @@ struct abel_return_option abel_free_list_ptr(struct abel_list* ptr_list)
     return ret;
 }
 
-/**
- * @brief Static - Linked list freer
- *
- * This freer is called by dictionary freer to free
- * the collision array.
- */
-static struct abel_return_option free_linked_list(
-    struct abel_linked_list* ptr_head)
+struct abel_return_option abel_free_dict_ptr(struct abel_dict* ptr_dict)
 {
-    struct abel_return_option ret;
-    struct abel_linked_list* ptr_node_tofree = NULL;
-    struct abel_linked_list* ptr_current_node = ptr_head;
+    struct abel_return_option ret = abel_option_okay(NULL);
+    struct abel_map* ptr_map = ptr_dict->ptr_map;
+    struct abel_map_iterator iter;
     struct abel_key_value_pair* ptr_pair = NULL;
-    while (ptr_current_node != NULL) {
-        ptr_pair = (struct abel_key_value_pair*)ptr_current_node->ptr_data;
-        if (ptr_pair->ptr_data != NULL) {
-            ret = abel_free_object_ptr(ptr_pair->ptr_data);
-            abel_free_pair(ptr_pair);
-        }
-        ptr_node_tofree = ptr_current_node;
-        ptr_current_node = ptr_current_node->next;
-        free(ptr_node_tofree);
+    if (ptr_dict->is_read_only == true) {
+        /* values and shape are owned by a document */
+        return abel_option_error( error_read_only() );
     }
-    return ret;
-}
-
-struct abel_return_option abel_free_dict_ptr(struct abel_dict* ptr_dict)
-{
-    struct abel_return_option ret;
-    size_t vector_capacity = ptr_dict->ptr_map->ptr_pair_vector->capacity;
-    struct abel_key_value_pair* ptr_acquired_pair = NULL;
-    struct abel_object* ptr_acquired_object = NULL;
-    struct abel_linked_list* ptr_linked_list_head = NULL;
-    for (int i = 0; i < vector_capacity; i++) {
-        /* free item array */
-        ptr_acquired_pair = ptr_dict->ptr_map->ptr_pair_vector->ptr_array[i];
-        if (ptr_acquired_pair != NULL) {
-            ptr_acquired_object = ptr_acquired_pair->ptr_data;
-            ret = abel_free_object_ptr(ptr_acquired_object);
-            abel_free_pair(ptr_acquired_pair);
+    if (ptr_dict->ptr_shape != NULL) {
+        for (size_t i = 0; i < ptr_dict->ptr_shape->size; i++) {
+            ret = abel_free_object_ptr(ptr_dict->ptr_values[i]);
         }
-        ptr_linked_list_head = ptr_dict->ptr_map->ptr_coll_vector->ptr_array[i];
-        /* free collision array */
-        if (ptr_linked_list_head != NULL) {
-            free_linked_list(ptr_linked_list_head);
+        abel_release_key_shape(ptr_dict->ptr_shape);
+        free(ptr_dict->ptr_values);
+    } else if (ptr_map != NULL) {
+        /* pairs and map are freed by the map freer */
+        iter = abel_map_iter_begin(ptr_map);
+        while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+            if (ptr_pair->ptr_data != NULL) {
+                ret = abel_free_object_ptr(ptr_pair->ptr_data);
+            }
         }
+        abel_free_map_ptr(ptr_map);
     }
-    abel_free_vector_ptr(ptr_dict->ptr_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_dict->ptr_map->ptr_coll_vector);
-    free(ptr_dict->ptr_map);
     free(ptr_dict);
     return ret;
 }
@@ -253,19 +342,18 @@ struct abel_return_option abel_free_dict_ptr(struct abel_dict* ptr_dict)
 struct abel_return_option abel_free_object_ptr(struct abel_object* ptr_object)
 {
     struct abel_return_option ret = abel_option_okay(NULL);
-    if (ptr_object->ref_count == 1) {
+    if (abel_object_is_immortal(ptr_object) == true) {
+        return ret;
+    }
+    if (release_ref(ptr_object) == true) {
         if (ptr_object->data_type == LIST_TYPE) {
             ret = abel_free_list_ptr(ptr_object->ptr_data);
         } else if (ptr_object->data_type == DICT_TYPE) {
             ret = abel_free_dict_ptr(ptr_object->ptr_data);
-        } else {
-            free(ptr_object->ptr_data);    // free stored data
+        } else if (ptr_object->ptr_data != &ptr_object->value) {
+            free(ptr_object->ptr_data);    // free stored data unless inline
         }
         free(ptr_object);    // make sure to free object
-    } else {
-        /* shared pointer, reduce the ref count only */
-        ptr_object->ref_count -= 1;
-        ret = abel_option_okay(NULL);
     }
     return ret;
 }
\ No newline at end of file
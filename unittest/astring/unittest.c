@@ -57,38 +57,38 @@ void test_make_string()
     char* test_0 = "";
     struct abel_string text_0 = abel_make_string(test_0);
     assert(text_0.length == 0);
-    assert(text_0.capacity == 4);
-    free(text_0.ptr_array);
+    assert(abel_string_capacity(&text_0) == 16);
+    abel_free_string(&text_0);
 
     /* 3 character */
     char* test_3 = "Kal";
     struct abel_string text_3 = abel_make_string(test_3);
     assert(text_3.length == 3);
-    assert(text_3.capacity == 4);
-    free(text_3.ptr_array);
+    assert(abel_string_capacity(&text_3) == 16);
+    abel_free_string(&text_3);
 
     /* 4 character */
     char* test_4 = "Kale";
     struct abel_string text_4 = abel_make_string(test_4);
     assert(text_4.length == 4);
-    assert(text_4.capacity == 8);
-    free(text_4.ptr_array);
+    assert(abel_string_capacity(&text_4) == 16);
+    abel_free_string(&text_4);
 
     /* 5 characters */
     char test_5[] = "Hello";
     struct abel_string text_5 = abel_make_string(test_5);
     assert(text_5.length == 5);
-    assert(text_5.capacity == 8);
-    assert(strlen(text_5.ptr_array) == 5);
-    free(text_5.ptr_array);
+    assert(abel_string_capacity(&text_5) == 16);
+    assert(strlen(abel_string_cstr(&text_5)) == 5);
+    abel_free_string(&text_5);
 
     /* 28 characters */
     char test_28[] = "If you want to be happy, be!";
     struct abel_string text_28 = abel_make_string(test_28);
     assert(text_28.length == 28);
-    assert(text_28.capacity == 32);
-    assert(strlen(text_28.ptr_array) == 28);
-    free(text_28.ptr_array);
+    assert(abel_string_capacity(&text_28) == 32);
+    assert(strlen(abel_string_cstr(&text_28)) == 28);
+    abel_free_string(&text_28);
 }
 
 void test_make_string_from_int()
@@ -96,33 +96,33 @@ void test_make_string_from_int()
     int test_0 = 0;
     struct abel_string text_0 = abel_string_from_int(test_0);
     assert(text_0.length == 1);
-    assert(text_0.capacity == 4);
+    assert(abel_string_capacity(&text_0) == 16);
     assert(abel_string_eq_cstring(&text_0, "0") == true);
-    free(text_0.ptr_array);
+    abel_free_string(&text_0);
 
     /* 2 digit */
     int test_3 = 90;
     struct abel_string text_3 = abel_string_from_int(test_3);
     assert(text_3.length == 2);
-    assert(text_3.capacity == 4);
+    assert(abel_string_capacity(&text_3) == 16);
     assert(abel_string_eq_cstring(&text_3, "90") == true);
-    free(text_3.ptr_array);
+    abel_free_string(&text_3);
 
     /* with plus sign : plus sign is removed */
     int test_4 = +777;
     struct abel_string text_4 = abel_string_from_int(test_4);
     assert(text_4.length == 3);    // note this length, plus sign is not here
-    assert(text_4.capacity == 4);
+    assert(abel_string_capacity(&text_4) == 16);
     assert(abel_string_eq_cstring(&text_4, "777") == true);
-    free(text_4.ptr_array);
+    abel_free_string(&text_4);
 
     /* with minus sign */
     int test_5 = -888;    // 5 characters
     struct abel_string text_5 = abel_string_from_int(test_5);
     assert(text_5.length == 4);
-    assert(text_5.capacity == 8);
+    assert(abel_string_capacity(&text_5) == 16);
     assert(abel_string_eq_cstring(&text_5, "-888") == true);
-    free(text_5.ptr_array);
+    abel_free_string(&text_5);
 }
 
 void test_make_string_ptr()
@@ -131,37 +131,33 @@ void test_make_string_ptr()
     char test_0[] = "";
     struct abel_string* ptr_text = abel_make_string_ptr(test_0);
     assert(ptr_text->length == 0);
-    assert(ptr_text->capacity == 4);
-    assert(strlen(ptr_text->ptr_array) == 0);
-    free(ptr_text->ptr_array);
-    free(ptr_text);
+    assert(abel_string_capacity(ptr_text) == 16);
+    assert(strlen(abel_string_cstr(ptr_text)) == 0);
+    abel_free_string_ptr(ptr_text);
 
     /* 1 characters */
     char test_1[] = " ";
     ptr_text = abel_make_string_ptr(test_1);
     assert(ptr_text->length == 1);
-    assert(ptr_text->capacity == 4);
-    assert(strlen(ptr_text->ptr_array) == 1);
-    free(ptr_text->ptr_array);
-    free(ptr_text);
+    assert(abel_string_capacity(ptr_text) == 16);
+    assert(strlen(abel_string_cstr(ptr_text)) == 1);
+    abel_free_string_ptr(ptr_text);
 
     /* 4 characters */
     char test_4[] = "1234";
     ptr_text = abel_make_string_ptr(test_4);
     assert(ptr_text->length == 4);
-    assert(ptr_text->capacity == 8);
-    assert(strlen(ptr_text->ptr_array) == 4);
-    free(ptr_text->ptr_array);
-    free(ptr_text);
+    assert(abel_string_capacity(ptr_text) == 16);
+    assert(strlen(abel_string_cstr(ptr_text)) == 4);
+    abel_free_string_ptr(ptr_text);
 
     /* 16 characters */
     char test_16[] = "12b45d7j90e74y6s";
     ptr_text = abel_make_string_ptr(test_16);
     assert(ptr_text->length == 16);
-    assert(ptr_text->capacity == 32);
-    assert(strlen(ptr_text->ptr_array) == 16);
-    free(ptr_text->ptr_array);
-    free(ptr_text);
+    assert(abel_string_capacity(ptr_text) == 32);
+    assert(strlen(abel_string_cstr(ptr_text)) == 16);
+    abel_free_string_ptr(ptr_text);
 }
 
 void test_assign_string()
@@ -170,12 +166,12 @@ void test_assign_string()
     char* test_str = "Hello";
     struct abel_string* ptr_text = abel_make_string_ptr(test_str);
     assert(ptr_text->length == 5);
-    assert(ptr_text->capacity == 8);
+    assert(abel_string_capacity(ptr_text) == 16);
 
     char* test_str_2 = "Things have changed.";    // 20 chars
     abel_string_assign(ptr_text, test_str_2);
     assert(ptr_text->length == 20);
-    assert(ptr_text->capacity == 32);
+    assert(abel_string_capacity(ptr_text) == 32);
 
     assert(abel_string_eq_cstring(ptr_text, test_str_2) == true);
 
@@ -188,13 +184,13 @@ void test_assign_string_char()
     char* test_str = "Hello";
     struct abel_string* ptr_text = abel_make_string_ptr(test_str);
     assert(ptr_text->length == 5);
-    assert(ptr_text->capacity == 8);
+    assert(abel_string_capacity(ptr_text) == 16);
 
     /* 20 chars */
     char test_str_2 = 'X';
     abel_string_assign_char(ptr_text, test_str_2);
     assert(ptr_text->length == 1);
-    assert(ptr_text->capacity == 4);
+    assert(abel_string_capacity(ptr_text) == 16);
 
     char converted[] = {'X', '\0'};
 
@@ -210,38 +206,38 @@ void test_append_string()
     char* test_str = "Hello";
     struct abel_string* ptr_text = abel_make_string_ptr(test_str);
     assert(ptr_text->length == 5);
-    assert(ptr_text->capacity == 8);
+    assert(abel_string_capacity(ptr_text) == 16);
 
     /* append 1 char, no maxcap change */
     char* test_str_2 = "W";
     abel_string_append(ptr_text, test_str_2);
     assert(ptr_text->length == 6);
-    assert(strcmp(ptr_text->ptr_array, "HelloW") == 0);
-    assert(ptr_text->capacity == 8);
+    assert(strcmp(abel_string_cstr(ptr_text), "HelloW") == 0);
+    assert(abel_string_capacity(ptr_text) == 16);
 
-    /* there is maxcap change */
+    /* still inline */
     abel_string_append(ptr_text, "orld");
-    assert(strcmp(ptr_text->ptr_array, "HelloWorld") == 0);
+    assert(strcmp(abel_string_cstr(ptr_text), "HelloWorld") == 0);
     assert(ptr_text->length == 10);
-    assert(ptr_text->capacity == 16);
+    assert(abel_string_capacity(ptr_text) == 16);
 
     /* append empty */
     abel_string_append(ptr_text, "");
-    assert(strcmp(ptr_text->ptr_array, "HelloWorld") == 0);
+    assert(strcmp(abel_string_cstr(ptr_text), "HelloWorld") == 0);
     assert(ptr_text->length == 10);
-    assert(ptr_text->capacity == 16);
+    assert(abel_string_capacity(ptr_text) == 16);
 
     /* append 1 space */
     abel_string_append(ptr_text, " ");
-    assert(strcmp(ptr_text->ptr_array, "HelloWorld ") == 0);
+    assert(strcmp(abel_string_cstr(ptr_text), "HelloWorld ") == 0);
     assert(ptr_text->length == 11);
-    assert(ptr_text->capacity == 16);    // next highest power of 2
+    assert(abel_string_capacity(ptr_text) == 16);    // still inline
 
-    /* maxcap change */
+    /* moves to heap */
     abel_string_append(ptr_text, "I am coming");
-    assert(strcmp(ptr_text->ptr_array, "HelloWorld I am coming") == 0);
+    assert(strcmp(abel_string_cstr(ptr_text), "HelloWorld I am coming") == 0);
     assert(ptr_text->length == 22);
-    assert(ptr_text->capacity == 32);    // next highest power of 2
+    assert(abel_string_capacity(ptr_text) == 32);    // next highest power of 2
 
     abel_free_string_ptr(ptr_text);
 }
@@ -252,7 +248,7 @@ void test_append_char()
     char* test_str = "Hello";
     struct abel_string* ptr_str = abel_make_string_ptr(test_str);
     assert(ptr_str->length == 5);
-    assert(ptr_str->capacity == 8);
+    assert(abel_string_capacity(ptr_str) == 16);
 
     abel_string_append_char(ptr_str, 'X');
     assert(abel_string_eq_cstring(ptr_str, "HelloX") == true);
@@ -260,6 +256,88 @@ void test_append_char()
     abel_free_string_ptr(ptr_str);
 }
 
+void test_append_n()
+{
+    char* test_str = "Hello";
+    struct abel_string* ptr_str = abel_make_string_ptr(test_str);
+
+    /* Append a slice of a buffer that is not null-terminated */
+    char buffer[] = {'W', 'o', 'r', 'l', 'd', '!', '!'};
+    abel_string_append_n(ptr_str, buffer, 5);
+    assert(abel_string_eq_cstring(ptr_str, "HelloWorld") == true);
+    assert(ptr_str->length == 10);
+    assert(abel_string_capacity(ptr_str) == 16);
+
+    abel_string_append_n(ptr_str, buffer, 0);
+    assert(ptr_str->length == 10);
+
+    abel_free_string_ptr(ptr_str);
+}
+
+/**
+ * @brief Test inline and heap
+ * 
+ * Up to 15 chars are held inline. Once on heap, a string
+ * keeps its array until it is freed.
+ */
+void test_inline_and_heap()
+{
+    struct abel_string string = abel_make_string("123456789012345");
+    assert(string.length == 15);
+    assert(abel_string_capacity(&string) == 16);
+    assert(abel_string_cstr(&string) == string.data.small_array);
+
+    /* 16th char moves it to heap */
+    abel_string_append_char(&string, '6');
+    assert(string.length == 16);
+    assert(abel_string_capacity(&string) == 32);
+    assert(abel_string_eq_cstring(&string, "1234567890123456") == true);
+    char* ptr_array = abel_string_cstr(&string);
+    assert(ptr_array != string.data.small_array);
+
+    /* short content reuses the array */
+    abel_string_assign(&string, "Kal");
+    assert(abel_string_cstr(&string) == ptr_array);
+    assert(abel_string_capacity(&string) == 32);
+    assert(abel_string_eq_cstring(&string, "Kal") == true);
+
+    /* copy by value of an inline string is independent */
+    struct abel_string string_2 = abel_make_string("Kale");
+    struct abel_string string_3 = string_2;
+    abel_string_append_char(&string_3, 's');
+    assert(abel_string_eq_cstring(&string_2, "Kale") == true);
+    assert(abel_string_eq_cstring(&string_3, "Kales") == true);
+
+    /* freed string is an empty inline string */
+    abel_free_string(&string);
+    assert(string.length == 0);
+    assert(abel_string_capacity(&string) == 16);
+    assert(strlen(abel_string_cstr(&string)) == 0);
+    abel_free_string(&string);
+}
+
+void test_truncate()
+{
+    struct abel_string string = abel_make_string("If you want to be happy, be!");
+    abel_string_truncate(&string, 40);
+    assert(string.length == 28);
+
+    abel_string_truncate(&string, 6);
+    assert(string.length == 6);
+    assert(abel_string_capacity(&string) == 32);
+    assert(abel_string_eq_cstring(&string, "If you") == true);
+
+    abel_string_truncate(&string, 0);
+    assert(string.length == 0);
+    assert(abel_string_eq_cstring(&string, "") == true);
+    abel_free_string(&string);
+
+    string = abel_make_string("Hello");
+    abel_string_truncate(&string, 4);
+    assert(abel_string_eq_cstring(&string, "Hell") == true);
+    abel_free_string(&string);
+}
+
 void test_compare_strings()
 {
     /* 5 characters */
@@ -338,6 +416,11 @@ int main()
 /* string append */
     test_append_string();
     test_append_char();
+    test_append_n();
+
+/* inline and heap */
+    test_inline_and_heap();
+    test_truncate();
 
 /* string compare */
     test_compare_strings();
@@ -83,9 +83,9 @@ void test_is_double()
     printf("%s \n", test_string_5);
 
     struct abel_string test_string_6 = abel_make_string("    8.2E-10");
-    printf("%s \n", test_string_6.ptr_array);
-    assert(is_double(test_string_6.ptr_array) == true);
-    printf("%s \n", test_string_6.ptr_array);
+    printf("%s \n", abel_string_cstr(&test_string_6));
+    assert(is_double(abel_string_cstr(&test_string_6)) == true);
+    printf("%s \n", abel_string_cstr(&test_string_6));
     abel_free_string(&test_string_6);
 }
 
@@ -14,6 +14,7 @@ gcc -g -std=c17 -Wall -c $SRCDIR/generic.c -o $BLDDIR/generic.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/option.c -o $BLDDIR/option.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/vector.c -o $BLDDIR/vector.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/linked_list.c -o $BLDDIR/linked_list.o -I $INCDIR
+gcc -g -std=c17 -Wall -c $SRCDIR/hashing_func.c -o $BLDDIR/hashing_func.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/map.c -o $BLDDIR/map.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/common.c -o $BLDDIR/common.o -I $INCDIR
 # specialised
@@ -32,6 +33,7 @@ gcc -std=gnu17 -g -Wall \
     $BLDDIR/option.o \
     $BLDDIR/vector.o \
     $BLDDIR/linked_list.o \
+    $BLDDIR/hashing_func.o \
     $BLDDIR/map.o \
     $BLDDIR/common.o \
     $BLDDIR/typefy.o \
@@ -1,5 +1,7 @@
 /* Unittest dict */
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
 #include "dict.h"
 
 void test_dict_insert()
@@ -21,6 +23,271 @@ void test_dict_insert()
     abel_free_dict_ptr(ptr_test_dict);
 }
 
+void test_dict_insert_interned()
+{
+    struct abel_dict* ptr_dict_1 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_2 = abel_make_dict_ptr();
+    abel_dict_insert_interned(ptr_dict_1, "name", abel_make_object_ptr(1));
+    abel_dict_insert_interned(ptr_dict_2, "name", abel_make_object_ptr(2));
+    assert(abel_interned_key_count() == 1);
+
+    /* Both dicts share the shape, thus the key buffer */
+    assert(ptr_dict_1->ptr_map == NULL);
+    assert(ptr_dict_1->ptr_shape == ptr_dict_2->ptr_shape);
+    assert(ptr_dict_1->ptr_shape->ptr_keys[0] == abel_find_interned_key("name"));
+    struct abel_object* ptr_object = abel_make_object_ptr(3);
+    assert(abel_dict_insert_interned(ptr_dict_1, "name", ptr_object).is_error);
+    free(ptr_object);    // not owned by any dict, data is inline
+    assert(abel_dict_get_int(ptr_dict_1, "name") == 1);
+    assert(abel_dict_get_int(ptr_dict_2, "name") == 2);
+
+    abel_free_dict_ptr(ptr_dict_1);
+    abel_free_dict_ptr(ptr_dict_2);
+    assert(abel_interned_key_count() == 0);
+}
+
+/**
+ * @brief Test dict in shape form
+ *
+ * Dicts of the same key sequence share a shape. A dict
+ * diverges into a map on delete, on insert of a key that
+ * is not interned, or once it has too many keys.
+ */
+void test_dict_shape()
+{
+    char key[8];
+    struct abel_dict* ptr_dict_1 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_2 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_3 = abel_make_dict_ptr();
+    abel_dict_insert_interned(ptr_dict_1, "x", abel_make_object_ptr(1));
+    abel_dict_insert_interned(ptr_dict_1, "y", abel_make_object_ptr(2));
+    abel_dict_insert_interned(ptr_dict_2, "x", abel_make_object_ptr(3));
+    abel_dict_insert_interned(ptr_dict_2, "y", abel_make_object_ptr(4));
+    abel_dict_insert_interned(ptr_dict_3, "y", abel_make_object_ptr(5));
+    abel_dict_insert_interned(ptr_dict_3, "x", abel_make_object_ptr(6));
+    assert(ptr_dict_1->ptr_shape == ptr_dict_2->ptr_shape);
+    assert(ptr_dict_1->ptr_shape != ptr_dict_3->ptr_shape);
+    assert(abel_dict_size(ptr_dict_1) == 2);
+    assert(abel_dict_has_key(ptr_dict_1, "y") == true);
+    assert(abel_dict_has_key(ptr_dict_1, "z") == false);
+    assert(abel_dict_get_int(ptr_dict_3, "x") == 6);
+
+    /* Delete diverges */
+    assert(abel_dict_delete(ptr_dict_2, "x").is_okay == true);
+    assert(ptr_dict_2->ptr_shape == NULL && ptr_dict_2->ptr_map != NULL);
+    assert(abel_dict_size(ptr_dict_2) == 1);
+    assert(abel_dict_get_int(ptr_dict_2, "y") == 4);
+
+    /* Key not interned diverges */
+    abel_dict_insert(ptr_dict_3, "z", abel_make_object_ptr(7));
+    assert(ptr_dict_3->ptr_shape == NULL);
+    assert(abel_dict_get_int(ptr_dict_3, "y") == 5);
+    assert(abel_dict_get_int(ptr_dict_3, "z") == 7);
+
+    /* Too many keys diverges */
+    for (int i = 0; i < DICT_SHAPE_MAX_SIZE; i++) {
+        sprintf(key, "k%d", i);
+        abel_dict_insert_interned(ptr_dict_1, key, abel_make_object_ptr(i));
+    }
+    assert(ptr_dict_1->ptr_shape == NULL);
+    assert(abel_dict_size(ptr_dict_1) == DICT_SHAPE_MAX_SIZE + 2);
+    assert(abel_dict_get_int(ptr_dict_1, "x") == 1);
+    assert(abel_dict_get_int(ptr_dict_1, "k29") == 29);
+
+    abel_free_dict_ptr(ptr_dict_1);
+    abel_free_dict_ptr(ptr_dict_2);
+    abel_free_dict_ptr(ptr_dict_3);
+    assert(abel_interned_key_count() == 0);
+}
+
+void test_dict_get_object_ptr_cached()
+{
+    struct abel_dict* ptr_dicts[3];
+    struct abel_dict_lookup_cache cache = abel_make_dict_lookup_cache();
+    for (int i = 0; i < 3; i++) {
+        ptr_dicts[i] = abel_make_dict_ptr();
+        if (i == 2) {    // different shape
+            abel_dict_insert_interned(ptr_dicts[i], "z", abel_make_object_ptr(0));
+        }
+        abel_dict_insert_interned(ptr_dicts[i], "id", abel_make_object_ptr(i));
+        abel_dict_insert_interned(ptr_dicts[i], "age", abel_make_object_ptr(10 * i));
+    }
+    for (int i = 0; i < 3; i++) {
+        struct abel_object* ptr_obj
+                = abel_dict_get_object_ptr_cached(ptr_dicts[i], "age", &cache);
+        assert(*(int*)ptr_obj->ptr_data == 10 * i);
+        assert(cache.shape_id == ptr_dicts[i]->ptr_shape->id);
+    }
+    assert(cache.index == 2);
+    assert(abel_dict_get_object_ptr_cached(ptr_dicts[0], "none", &cache) == NULL);
+    for (int i = 0; i < 3; i++) {
+        abel_free_dict_ptr(ptr_dicts[i]);
+    }
+}
+
+void test_dict_iterator()
+{
+    char* keys[3] = { "c", "a", "b" };
+    struct abel_dict* ptr_dict_1 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_2 = abel_make_dict_ptr();
+    struct abel_dict_iterator iter = abel_dict_iter_begin(ptr_dict_1);
+    int count = 0;
+    assert(abel_dict_iter_next(&iter) == false);
+    for (int i = 0; i < 3; i++) {
+        abel_dict_insert_interned(ptr_dict_1, keys[i], abel_make_object_ptr(i));
+        abel_dict_insert(ptr_dict_2, keys[i], abel_make_object_ptr(i));
+    }
+    /* Shape form */
+    iter = abel_dict_iter_begin(ptr_dict_1);
+    while (abel_dict_iter_next(&iter)) {
+        assert(strcmp(iter.key, keys[count]) == 0);
+        assert(*(int*)iter.ptr_object->ptr_data == count);
+        count++;
+    }
+    assert(count == 3);
+    /* Map */
+    abel_dict_delete(ptr_dict_2, "a");
+    count = 0;
+    iter = abel_dict_iter_begin(ptr_dict_2);
+    while (abel_dict_iter_next(&iter)) {
+        assert(strcmp(iter.key, keys[2 * count]) == 0);
+        count++;
+    }
+    assert(count == 2);
+    abel_free_dict_ptr(ptr_dict_1);
+    abel_free_dict_ptr(ptr_dict_2);
+}
+
+void test_dict_insert_many()
+{
+    char* keys[40];
+    struct abel_object* ptr_objs[40];
+    struct abel_dict* ptr_dict = abel_make_dict_ptr_with_capacity(100);
+    assert(abel_map_capacity(ptr_dict->ptr_map) == 128);
+    for (int i = 0; i < 40; i++) {
+        keys[i] = malloc(8);
+        sprintf(keys[i], "k%d", i);
+        ptr_objs[i] = abel_make_object_ptr(i);
+    }
+    assert(abel_dict_insert_many(ptr_dict, keys, ptr_objs, 30).is_okay == true);
+    assert(abel_dict_size(ptr_dict) == 30);
+    assert(abel_dict_get_int(ptr_dict, "k29") == 29);
+    assert(ptr_objs[0]->ref_count == 1);
+
+    /* Key k29 exists, keys before it are inserted */
+    struct abel_return_option ret
+            = abel_dict_insert_many(ptr_dict, keys + 31, ptr_objs + 31, 9);
+    assert(ret.is_okay == true);
+    ret = abel_dict_insert_many(ptr_dict, keys + 28, ptr_objs + 28, 3);
+    assert(ret.is_error == true && ret.error.error_type == KEY_EXISTS);
+    assert(abel_dict_size(ptr_dict) == 39);
+    ret = abel_dict_insert_many(ptr_dict, keys + 30, ptr_objs + 30, 2);
+    assert(ret.is_error == true);
+    assert(abel_dict_get_int(ptr_dict, "k30") == 30);
+    assert(abel_dict_size(ptr_dict) == 40);
+    assert(abel_map_capacity(ptr_dict->ptr_map) == 128);
+
+    /* Small dict starts in shape form */
+    struct abel_dict* ptr_dict_2 = abel_make_dict_ptr_with_capacity(4);
+    assert(ptr_dict_2->ptr_map == NULL);
+    abel_dict_insert_interned(ptr_dict_2, "a", abel_make_object_ptr(1));
+    assert(abel_dict_insert_many(ptr_dict_2, keys, ptr_objs, 40).is_okay == true);
+    assert(abel_dict_size(ptr_dict_2) == 41);
+    assert(abel_dict_get_int(ptr_dict_2, "a") == 1);
+    assert(ptr_objs[0]->ref_count == 2);
+
+    abel_free_dict_ptr(ptr_dict);
+    abel_free_dict_ptr(ptr_dict_2);
+    for (int i = 0; i < 40; i++) {
+        free(keys[i]);
+    }
+}
+
+void test_dict_key_length()
+{
+    char* buffer = "{\"id\":1,\"age\":2}";
+    struct abel_dict* ptr_dict_1 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_2 = abel_make_dict_ptr();
+    abel_dict_insert_interned_n(ptr_dict_1, buffer + 2, 2, abel_make_object_ptr(1));
+    abel_dict_insert_interned_n(ptr_dict_1, buffer + 9, 3, abel_make_object_ptr(2));
+    abel_dict_insert_n(ptr_dict_2, buffer + 2, 2, abel_make_object_ptr(1));
+    abel_dict_insert_n(ptr_dict_2, buffer + 9, 3, abel_make_object_ptr(2));
+    assert(ptr_dict_1->ptr_shape != NULL && ptr_dict_2->ptr_map != NULL);
+    assert(abel_dict_get_int(ptr_dict_1, "age") == 2);
+    assert(abel_dict_get_int(ptr_dict_2, "id") == 1);
+    assert(*(int*)abel_dict_get_object_ptr_n(ptr_dict_1, "agent", 3)->ptr_data == 2);
+    assert(*(int*)abel_dict_get_object_ptr_n(ptr_dict_2, "agent", 3)->ptr_data == 2);
+    assert(abel_dict_has_key_n(ptr_dict_1, "agent", 5) == false);
+    assert(abel_dict_has_key_n(ptr_dict_2, "agent", 2) == false);
+    assert(abel_dict_has_key_n(ptr_dict_1, "identity", 2) == true);
+    abel_free_dict_ptr(ptr_dict_1);
+    abel_free_dict_ptr(ptr_dict_2);
+}
+
+/**
+ * @brief Test key handle
+ *
+ * Handle finds the key in dicts of any form, and the
+ * cached slot is only used if it still holds the key.
+ */
+void test_dict_get_by_key()
+{
+    char key[8];
+    struct abel_key timeout = abel_make_key("timeout");
+    struct abel_key missing = abel_make_key("missing");
+    struct abel_dict* ptr_dict_1 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_2 = abel_make_dict_ptr();
+    struct abel_dict* ptr_dict_3 = abel_make_dict_ptr();
+    abel_dict_insert_interned(ptr_dict_1, "host", abel_make_object_ptr(0));
+    abel_dict_insert_double(ptr_dict_1, "timeout", 1.5);    // map
+    abel_dict_insert_interned(ptr_dict_2, "timeout",
+                              abel_make_object_ptr_from_double(2.5));
+    for (int i = 0; i < 20; i++) {
+        sprintf(key, "k%d", i);
+        abel_dict_insert_double(ptr_dict_3, key, i);
+    }
+    abel_dict_insert_double(ptr_dict_3, "timeout", 3.5);
+
+    for (int round = 0; round < 2; round++) {
+        assert(abel_dict_get_double_by_key(ptr_dict_1, &timeout) == 1.5);
+        assert(abel_dict_get_double_by_key(ptr_dict_2, &timeout) == 2.5);
+        assert(timeout.slot == 0);
+        assert(abel_dict_get_double_by_key(ptr_dict_3, &timeout) == 3.5);
+        assert(abel_dict_get_double_by_key(ptr_dict_3, &timeout) == 3.5);
+        assert(abel_dict_get_object_ptr_by_key(ptr_dict_3, &missing) == NULL);
+        assert(abel_dict_get_string_by_key(ptr_dict_3, &timeout) == NULL);
+    }
+    abel_dict_delete(ptr_dict_3, "timeout");
+    assert(abel_dict_get_object_ptr_by_key(ptr_dict_3, &timeout) == NULL);
+
+    abel_free_dict_ptr(ptr_dict_1);
+    abel_free_dict_ptr(ptr_dict_2);
+    abel_free_dict_ptr(ptr_dict_3);
+    abel_free_key(&timeout);
+    abel_free_key(&missing);
+    assert(abel_interned_key_count() == 0);
+}
+
+void test_dict_stats()
+{
+    struct abel_dict* ptr_dict = abel_make_dict_ptr();
+    struct abel_map_stats stats = abel_dict_stats(ptr_dict);
+    assert(stats.size == 0 && stats.bytes == sizeof(*ptr_dict));
+    for (int i = 0; i < 5; i++) {
+        char key[2] = { (char)('a' + i), '\0' };
+        abel_dict_insert_interned(ptr_dict, key, abel_make_object_ptr(i));
+    }
+    stats = abel_dict_stats(ptr_dict);
+    assert(stats.size == 5 && stats.capacity == 8);
+    assert(stats.max_probe_length == 5 && stats.probe_histogram[4] == 1);
+    assert(stats.bytes == sizeof(*ptr_dict) + 8 * sizeof(struct abel_object*));
+    abel_dict_delete(ptr_dict, "a");
+    stats = abel_dict_stats(ptr_dict);
+    assert(stats.size == 4 && stats.capacity == MAP_SMALL_CAPACITY);
+    assert(stats.bytes > sizeof(*ptr_dict) + sizeof(struct abel_map));
+    abel_free_dict_ptr(ptr_dict);
+}
+
 void test_dict_insert_bool()
 {
     char* key = "Abcd";
@@ -114,6 +381,12 @@ void test_dict_get_bool()
     abel_dict_insert(ptr_test_dict, key, ptr_object);
     abel_dict_insert(ptr_test_dict, "ABcd", ptr_object_2);
     assert(abel_dict_get_bool(ptr_test_dict, key) == false);
+    // Bool data is shared by all holders, so read-only
+    abel_dict_insert_bool(ptr_test_dict, "t", false);
+    const Bool* ptr_bool = abel_dict_get_bool_ptr(ptr_test_dict, "t");
+    assert(_Generic(abel_dict_get_bool_ptr(ptr_test_dict, "t"),
+                    const Bool* : true, default : false));
+    assert(ptr_bool == abel_bool_object_ptr(false)->ptr_data);
 
     abel_free_dict_ptr(ptr_test_dict);
 }
@@ -298,6 +571,14 @@ int main()
 {
     /* regular offsite unittest */
     test_dict_insert();
+    test_dict_insert_interned();
+    test_dict_shape();
+    test_dict_get_object_ptr_cached();
+    test_dict_iterator();
+    test_dict_insert_many();
+    test_dict_key_length();
+    test_dict_get_by_key();
+    test_dict_stats();
     test_dict_insert_bool();
     test_dict_insert_null();
     test_dict_insert_string();
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Abel-on-C directories
+ABEL_ON_C_ROOT=${ABELC_ROOT}
+INCDIR="$ABEL_ON_C_ROOT/include"
+SRCDIR="$ABEL_ON_C_ROOT/src"
+BLDDIR="$ABEL_ON_C_ROOT/build"
+
+echo "************************************************"
+echo "* Abel-on-C : Unittest : Header : hashing_func *"
+echo "************************************************"
+
+echo "-- Compile library source files --"
+gcc -g -std=c17 -Wall -c $SRCDIR/hashing_func.c -o $BLDDIR/hashing_func.o -I $INCDIR
+
+echo "-- Compile local unittest source files --"
+gcc -std=c17 -g -Wall -c ./unittest.c -o ./unittest.o -I $INCDIR
+
+echo "-- Link all object files --"
+gcc -std=c17 -g -Wall \
+    $BLDDIR/hashing_func.o \
+    ./unittest.o  -o ./unittest.out
+
+echo "-- Run executable --"
+if [ "$1" = "leak-check" ]; then
+    valgrind --leak-check=yes ./unittest.out
+else
+    ./unittest.out
+fi
+
+echo "-- Compile with atomic ref count --"
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/hashing_func.c -o $BLDDIR/hashing_func_atomic.o -I $INCDIR
+gcc -std=c17 -g -Wall -DABEL_ATOMIC_REF_COUNT -c ./unittest.c -o ./unittest_atomic.o -I $INCDIR
+
+echo "-- Link atomic object files --"
+gcc -std=c17 -g -Wall \
+    $BLDDIR/hashing_func_atomic.o \
+    ./unittest_atomic.o  -o ./unittest_atomic.out
+
+echo "-- Run atomic executable --"
+if [ "$1" = "leak-check" ]; then
+    valgrind --leak-check=yes ./unittest_atomic.out
+else
+    ./unittest_atomic.out
+fi
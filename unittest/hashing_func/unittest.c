@@ -0,0 +1,117 @@
+/* Unittest hashing_func */
+#include <assert.h>
+#include <string.h>
+#ifdef ABEL_ATOMIC_REF_COUNT
+#include <threads.h>
+#endif
+#include "hashing_func.h"
+
+/**
+ * @brief Test all functions of the family
+ *
+ * Same key and seed give the same value, and only the given
+ * number of chars is hashed.
+ */
+void test_hash_family()
+{
+    HashFunc hash_funcs[] = {
+        abel_hash_wy, abel_hash_fnv1a, abel_hash_murmur_oaat,
+        abel_hash_jenkins_oaat, abel_hash_djb2, abel_hash_sdbm
+    };
+    char* key = "abcdefghijklmnopqrstuvwxyz";
+    for (int f = 0; f < 6; f++) {
+        assert(hash_funcs[f](key, 26, 7) == hash_funcs[f](key, 26, 7));
+        assert(hash_funcs[f](key, 3, 7) == hash_funcs[f]("abc", 3, 7));
+        assert(hash_funcs[f](key, 26, 7) != hash_funcs[f](key, 25, 7));
+    }
+}
+
+/**
+ * @brief Test wyhash
+ *
+ * All code paths by length, i.e. 0, 1-3, 4-16, 17-48 and
+ * longer, give distinct values for distinct keys and depend
+ * on the seed.
+ */
+void test_hash_wy()
+{
+    char buffer[128];
+    uint64_t values[128];
+    for (int i = 0; i < 128; i++) {
+        buffer[i] = (char)('a' + i % 26);
+    }
+    for (int length = 0; length < 128; length++) {
+        values[length] = abel_hash_wy(buffer, length, 1);
+        assert(values[length] != abel_hash_wy(buffer, length, 2));
+        for (int prev = 0; prev < length; prev++) {
+            assert(values[prev] != values[length]);
+        }
+    }
+    /* One flipped char changes the value */
+    buffer[100] = 'X';
+    assert(abel_hash_wy(buffer, 127, 1) != values[127]);
+}
+
+/**
+ * @brief Test Murmur one-at-a-time
+ *
+ * Seed 1 gives the values previously hard-coded in map.
+ */
+void test_hash_murmur_oaat()
+{
+    char* key = "Hello";
+    uint32_t h = 1;
+    for (size_t i = 0; i < strlen(key); i++) {
+        h ^= key[i];
+        h *= 0x5bd1e995;
+        h ^= h >> 15;
+    }
+    assert(abel_hash_murmur_oaat(key, strlen(key), 1) == h);
+}
+
+void test_hash_process_seed()
+{
+    uint64_t seed = abel_hash_process_seed();
+    assert(abel_hash_process_seed() == seed);
+}
+
+#ifdef ABEL_ATOMIC_REF_COUNT
+static int draw_seed(void* ptr_seed)
+{
+    *(uint64_t*)ptr_seed = abel_hash_process_seed();
+    return 0;
+}
+
+/**
+ * @brief Test process seed of several threads
+ *
+ * Threads asking for the seed at once all get the same one.
+ */
+void test_hash_process_seed_threads()
+{
+    thrd_t threads[4];
+    uint64_t seeds[4];
+    for (int i = 0; i < 4; i++) {
+        assert(thrd_create(&threads[i], draw_seed, &seeds[i]) == thrd_success);
+    }
+    for (int i = 0; i < 4; i++) {
+        thrd_join(threads[i], NULL);
+    }
+    uint64_t seed = abel_hash_process_seed();
+    for (int i = 0; i < 4; i++) {
+        assert(seeds[i] == seed);
+    }
+}
+#endif
+
+int main()
+{
+    test_hash_family();
+    test_hash_wy();
+    test_hash_murmur_oaat();
+#ifdef ABEL_ATOMIC_REF_COUNT
+    test_hash_process_seed_threads();
+#else
+    test_hash_process_seed();
+#endif
+}
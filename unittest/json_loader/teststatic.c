@@ -5,22 +5,6 @@
 #include <assert.h>
 #include "../../src/json_loader.c"
 
-void test_get_closing_symbol_by_opening()
-{
-    const char* test_opening = L_BRACE;
-    char* test_closing = get_closing_symbol_by_opening(test_opening);
-    assert(strcmp(test_closing, R_BRACE) == 0);
-
-    test_closing = get_closing_symbol_by_opening(L_BRACKET);
-    assert(strcmp(test_closing, R_BRACKET) == 0);
-    assert(strcmp(test_closing, L_BRACKET) != 0);
-    assert(strcmp(test_closing, L_BRACE) != 0);
-
-    test_closing = get_closing_symbol_by_opening(L_PARENTHESIS);
-    assert(strcmp(test_closing, R_PARENTHESIS) == 0);
-    assert(strcmp(test_closing, R_BRACKET) != 0);
-}
-
 /**
  * Test file test_matching.txt contains
  * 
@@ -46,55 +30,51 @@ void test_get_closing_symbol_by_opening()
  * }
  * Matching tokens: (#1, #9) the {}, and (#3, #8) the []
  */
-void test_is_matched_closing()
+void test_closing_index()
 {
     struct json_parser test_parser;
     abel_make_json_parser(&test_parser);
     abel_parse_file(&test_parser, "test_matching.txt");
 
-    //json_token_ptr ptr_token;
-    //size_t token_vector_size = abel_vector_size(&test_parser.token_vector);
-
     // Matching tokens: (#1, #9) the {}
-    json_token_ptr dict_opening
-            = abel_vector_at(&test_parser.token_vector, 1).pointer;
-    json_token_ptr dict_closing
-            = abel_vector_at(&test_parser.token_vector, 9).pointer;
+    size_t dict_opening = 1;
+    size_t dict_closing = 9;
     // Matching tokens: (#3, #8) the []
-    json_token_ptr list_opening
-            = abel_vector_at(&test_parser.token_vector, 3).pointer;
-    json_token_ptr list_closing
-            = abel_vector_at(&test_parser.token_vector, 8).pointer;
-    assert( is_matched_closing(dict_closing, dict_opening) );
-    assert( is_matched_closing(list_closing, list_opening) );
-    // non matching
-    assert( !is_matched_closing(dict_closing, list_opening) );
-    assert( !is_matched_closing(list_closing, dict_opening) );
+    size_t list_opening = 3;
+    size_t list_closing = 8;
+    const struct json_token_tape* ptr_tape = &test_parser.token_vector;
+    assert(abel_token_tape_closing_index(ptr_tape, dict_opening) == dict_closing);
+    assert(abel_token_tape_closing_index(ptr_tape, list_opening) == list_closing);
+    assert(ptr_tape->ptr_matching_indices[dict_closing] == dict_opening);
+    assert(ptr_tape->ptr_matching_indices[list_closing] == list_opening);
+    assert(ptr_tape->ptr_matching_indices[5] == JSON_TOKEN_NO_INDEX);
+    assert(ptr_tape->open_index == JSON_TOKEN_NO_INDEX);
 
     abel_free_json_parser(&test_parser);
 }
 
-void test_get_token_ptr(void)
+void test_get_token(void)
 {
     struct json_parser test_parser;
     abel_make_json_parser(&test_parser);
     abel_parse_file(&test_parser, "test_matching.txt");
 
-    json_token_ptr ptr_token;
+    struct json_token token;
+    json_token_ptr ptr_token = &token;
     //size_t token_vector_size = abel_vector_size(&test_parser.token_vector);
     // 5 th token literal is 10, scheme is 2, level is 2, parent key is 0, termimal type is DOUBLE_TERM 
-    ptr_token = get_token_ptr(&test_parser.token_vector, 5);
-    assert( strcmp(ptr_token->literal->ptr_array, "10") == 0 );
+    token = get_token(&test_parser.token_vector, 5);
+    assert( strcmp(abel_json_token_literal(&test_parser, ptr_token), "10") == 0 );
     assert(ptr_token->literal_scheme == 2);
     assert(ptr_token->level == 2);
-    assert(strcmp(ptr_token->parent_key->ptr_array, "0") == 0);
+    assert(strcmp(abel_json_token_parent_key(&test_parser, ptr_token), "0") == 0);
     assert(ptr_token->terminal_type == DOUBLE_TERM);
     // 7 th token literal is Halo, scheme is 1, level is 2, parent key is 1, termimal type is STRING_TERM 
-    ptr_token = get_token_ptr(&test_parser.token_vector, 7);
-    assert( strcmp(ptr_token->literal->ptr_array, "Halo") ==0 );
+    token = get_token(&test_parser.token_vector, 7);
+    assert( strcmp(abel_json_token_literal(&test_parser, ptr_token), "Halo") ==0 );
     assert(ptr_token->literal_scheme == 1);
     assert(ptr_token->level == 2);
-    assert(strcmp(ptr_token->parent_key->ptr_array, "1") == 0);
+    assert(strcmp(abel_json_token_parent_key(&test_parser, ptr_token), "1") == 0);
     assert(ptr_token->terminal_type != DOUBLE_TERM);
     assert(ptr_token->terminal_type == STRING_TERM);
     abel_free_json_parser(&test_parser);
@@ -107,22 +87,23 @@ void test_get_literal(void)
     abel_parse_file(&test_parser, "test_matching.txt");
 
     //json_token_ptr ptr_token;
+    struct json_loader test_loader = able_make_json_loader();
+    test_loader.ptr_parser = &test_parser;
     char* literal;
     //size_t token_vector_size = abel_vector_size(&test_parser.token_vector);
     // 5 th token literal is 10, scheme is 2, level is 2, parent key is 0, termimal type is DOUBLE_TERM 
-    literal = get_literal(&test_parser.token_vector, 5);
+    literal = get_literal(&test_loader, &test_parser.token_vector, 5);
     assert( strcmp(literal, "10") == 0 );
     // 7 th token literal is Halo, scheme is 1, level is 2, parent key is 1, termimal type is STRING_TERM 
-    literal = get_literal(&test_parser.token_vector, 7);
+    literal = get_literal(&test_loader, &test_parser.token_vector, 7);
     assert( strcmp(literal, "Halo") ==0 );
     abel_free_json_parser(&test_parser);
 }
 
 int main(void)
 {
-    test_get_closing_symbol_by_opening();
-    test_is_matched_closing();
-    test_get_token_ptr();
+    test_closing_index();
+    test_get_token();
     test_get_literal();
     return 0;
 }
\ No newline at end of file
@@ -90,8 +90,249 @@ void test_json_loader_nested()
     abel_free_dict_ptr(ptr_global_dict);
 }
 
+/**
+ * @brief Test JSON builder
+ * 
+ * Builder loads the nested file in the same pass as parsing
+ * and shall produce the same containers as the loader.
+ */
+void test_json_builder_nested()
+{
+    struct json_parser test_parser;
+    abel_make_json_parser(&test_parser);
+    struct abel_dict* ptr_global_dict = abel_make_dict_ptr();
+    struct json_builder test_builder;
+    abel_make_json_builder(&test_builder, ptr_global_dict);
+    abel_json_builder_attach(&test_builder, &test_parser, false);
+    abel_parse_file(&test_parser, "./files/nested.json");
+    // no token is kept
+    assert(abel_token_tape_size(&test_parser.token_vector) == 0);
+    assert(test_parser.token_count > 0);
+
+    struct abel_object* ptr_object
+            = abel_dict_get_object_ptr(ptr_global_dict, "ROOT_KEY_");
+    assert(ptr_object->data_type == LIST_TYPE);
+    struct abel_list* ptr_root_list = ptr_object->ptr_data;
+    struct abel_dict* ptr_file_dict
+            = abel_list_get_object_pointer(ptr_root_list, 0)->ptr_data;
+    assert(abel_dict_get_double(ptr_file_dict, "dble") == 1e-6);
+    struct abel_list* ptr_sublist = abel_dict_get_list_ptr(ptr_file_dict, "list");
+    assert(abel_list_get_data_type(ptr_sublist, 0) == STRING_TYPE);
+    assert(abel_list_get_data_type(ptr_sublist, 1) == DOUBLE_TYPE);
+    char* str = abel_list_get_object_pointer(ptr_sublist, 2)->ptr_data;
+    assert(strcmp(str, "Relu") == 0);
+    struct abel_dict* ptr_subdict = abel_dict_get_dict_ptr(ptr_file_dict, "dict");
+    struct abel_list* ptr_list = abel_dict_get_list_ptr(ptr_subdict, "layer1");
+    assert(abel_list_get_double(ptr_list, 1) == 640);
+    str = abel_list_get_object_pointer(ptr_list, 2)->ptr_data;
+    assert(strcmp(str, "RGB") == 0);
+
+    // freer
+    abel_free_json_builder(&test_builder);
+    abel_free_json_parser(&test_parser);
+    abel_free_dict_ptr(ptr_global_dict);
+}
+
+void test_load_from_file()
+{
+    struct abel_dict* ptr_global_dict = abel_make_dict_ptr();
+    struct abel_return_option ret
+            = load_from_file(ptr_global_dict, "./files/simple_dict.txt");
+    assert(ret.is_okay == true);
+    struct abel_list* ptr_root_list
+            = abel_dict_get_object_ptr(ptr_global_dict, "ROOT_KEY_")->ptr_data;
+    struct abel_dict* ptr_file_dict
+            = abel_list_get_object_pointer(ptr_root_list, 0)->ptr_data;
+    assert(abel_dict_get_double(ptr_file_dict, "num") == 10.0);
+    assert(strcmp(abel_dict_get_string(ptr_file_dict, "str"), "Halo") == 0);
+    abel_free_dict_ptr(ptr_global_dict);
+
+    // missing file
+    ptr_global_dict = abel_make_dict_ptr();
+    ret = load_from_file(ptr_global_dict, "./files/no_such_file.json");
+    assert(ret.is_error == true);
+    abel_free_dict_ptr(ptr_global_dict);
+
+    // truncated file
+    ptr_global_dict = abel_make_dict_ptr();
+    ret = load_from_file(ptr_global_dict, "./files/truncated.json");
+    assert(ret.is_error == true);
+    assert(ret.error.error_type == PARSER_ERROR);
+    abel_free_dict_ptr(ptr_global_dict);
+}
+
+/**
+ * @brief Test arena
+ * 
+ * Memory is aligned, and a large request gets a chunk of its
+ * own behind the current one.
+ */
+void test_arena()
+{
+    struct abel_arena arena = abel_make_arena();
+    char* ptr_a = abel_arena_alloc(&arena, 3);
+    double* ptr_b = abel_arena_alloc(&arena, sizeof(double));
+    assert((uintptr_t)ptr_b % _Alignof(max_align_t) == 0);
+    assert(ptr_b != (double*)ptr_a);
+    *ptr_b = 2.5;
+    assert(arena.bytes == ARENA_MIN_CHUNK_SIZE);
+    char* ptr_large = abel_arena_alloc(&arena, ARENA_MIN_CHUNK_SIZE);
+    memset(ptr_large, 0, ARENA_MIN_CHUNK_SIZE);
+    assert(arena.bytes == 2 * ARENA_MIN_CHUNK_SIZE);
+    /* current chunk keeps its room */
+    char* ptr_c = abel_arena_alloc(&arena, 1);
+    assert(ptr_c > ptr_a && ptr_c < ptr_a + ARENA_MIN_CHUNK_SIZE);
+    assert(*ptr_b == 2.5);
+    abel_free_arena(&arena);
+    assert(arena.ptr_chunk == NULL && arena.bytes == 0);
+}
+
+/**
+ * @brief Test document
+ * 
+ * Document loaded from the nested file shall hold the same
+ * containers as the builder makes.
+ */
+void test_document_load_file()
+{
+    struct abel_document document;
+    abel_make_document(&document);
+    struct abel_return_option ret
+            = abel_document_load_file(&document, "./files/nested.json");
+    assert(ret.is_okay == true);
+    assert(document.ptr_root->data_type == LIST_TYPE);
+    struct abel_list* ptr_root_list = document.ptr_root->ptr_data;
+    assert(abel_list_size(ptr_root_list) == 1);
+    struct abel_dict* ptr_file_dict
+            = abel_list_get_object_pointer(ptr_root_list, 0)->ptr_data;
+    assert(abel_dict_size(ptr_file_dict) == 3);
+    assert(abel_dict_get_double(ptr_file_dict, "dble") == 1e-6);
+    struct abel_list* ptr_sublist = abel_dict_get_list_ptr(ptr_file_dict, "list");
+    assert(abel_list_size(ptr_sublist) == 3);
+    assert(abel_list_get_data_type(ptr_sublist, 0) == STRING_TYPE);
+    assert(abel_list_get_data_type(ptr_sublist, 1) == DOUBLE_TYPE);
+    char* str = abel_list_get_object_pointer(ptr_sublist, 2)->ptr_data;
+    assert(strcmp(str, "Relu") == 0);
+    struct abel_dict* ptr_subdict = abel_dict_get_dict_ptr(ptr_file_dict, "dict");
+    struct abel_list* ptr_list = abel_dict_get_list_ptr(ptr_subdict, "layer1");
+    assert(abel_list_get_double(ptr_list, 1) == 640);
+    str = abel_list_get_object_pointer(ptr_list, 2)->ptr_data;
+    assert(strcmp(str, "RGB") == 0);
+    abel_document_free(&document);
+    assert(abel_interned_key_count() == 0);
+
+    // missing file
+    abel_make_document(&document);
+    ret = abel_document_load_file(&document, "./files/no_such_file.json");
+    assert(ret.is_error == true);
+    abel_document_free(&document);
+}
+
+/**
+ * @brief Test document of a buffer
+ * 
+ * Empty containers, and a dict too large for shape form,
+ * which gets a map.
+ */
+void test_document_load_buffer()
+{
+    char buffer[1024] = "{\"e\": {}, \"l\": [], \"t\": true, \"n\": null, "
+                        "\"d\": {\"a\": 1, \"b\": 2}, \"big\": {";
+    char pair[32];
+    for (int i = 0; i < 40; i++) {
+        sprintf(pair, "%s\"k%d\": %d", (i == 0) ? "" : ", ", i, i);
+        strcat(buffer, pair);
+    }
+    strcat(buffer, "}}");
+    struct abel_document document;
+    abel_make_document(&document);
+    struct abel_return_option ret
+            = abel_document_load_buffer(&document, buffer, strlen(buffer));
+    assert(ret.is_okay == true);
+    assert(document.ptr_root->data_type == LIST_TYPE);
+    struct abel_dict* ptr_dict
+            = abel_list_get_object_pointer(document.ptr_root->ptr_data, 0)->ptr_data;
+    assert(abel_dict_size(ptr_dict) == 6);
+    assert(abel_dict_size(abel_dict_get_dict_ptr(ptr_dict, "e")) == 0);
+    assert(abel_list_size(abel_dict_get_list_ptr(ptr_dict, "l")) == 0);
+    assert(abel_dict_get_bool(ptr_dict, "t") == true);
+    assert(abel_dict_get_object_ptr(ptr_dict, "n")->data_type == NULL_TYPE);
+    struct abel_dict* ptr_subdict = abel_dict_get_dict_ptr(ptr_dict, "d");
+    assert(abel_dict_size(ptr_subdict) == 2);
+    assert(abel_dict_get_double(ptr_subdict, "a") == 1);
+    assert(abel_dict_get_double(ptr_subdict, "b") == 2);
+    ptr_subdict = abel_dict_get_dict_ptr(ptr_dict, "big");
+    assert(ptr_subdict->ptr_map != NULL);
+    assert(abel_dict_size(ptr_subdict) == 40);
+    assert(abel_dict_get_double(ptr_subdict, "k39") == 39);
+    assert(abel_vector_size(&document.maps) == 1);
+    abel_document_free(&document);
+    assert(abel_interned_key_count() == 0);
+
+    // containers up to a parse error are kept
+    abel_make_document(&document);
+    strcpy(buffer, "[1, [2, {\"a\" 3}]]");
+    ret = abel_document_load_buffer(&document, buffer, strlen(buffer));
+    assert(ret.is_error == true);
+    struct abel_list* ptr_list
+            = abel_list_get_object_pointer(document.ptr_root->ptr_data, 0)->ptr_data;
+    assert(abel_list_size(ptr_list) == 2);
+    ptr_list = abel_list_get_object_pointer(ptr_list, 1)->ptr_data;
+    assert(abel_list_get_double(ptr_list, 0) == 2);
+    abel_document_free(&document);
+    assert(abel_interned_key_count() == 0);
+
+    // truncated buffer is an error, containers so far are kept,
+    // literal 2 is never terminated
+    abel_make_document(&document);
+    strcpy(buffer, "{\"a\": 1, \"b\": [1, 2");
+    ret = abel_document_load_buffer(&document, buffer, strlen(buffer));
+    assert(ret.is_error == true);
+    assert(ret.error.error_type == PARSER_ERROR);
+    ptr_dict = abel_list_get_object_pointer(document.ptr_root->ptr_data, 0)->ptr_data;
+    assert(abel_dict_get_double(ptr_dict, "a") == 1);
+    assert(abel_list_size(abel_dict_get_list_ptr(ptr_dict, "b")) == 1);
+    abel_document_free(&document);
+    assert(abel_interned_key_count() == 0);
+
+    // containers of a document refuse mutation and freeing
+    abel_make_document(&document);
+    strcpy(buffer, "{\"a\": 1, \"b\": 2, \"c\": 3, \"d\": [4]}");
+    ret = abel_document_load_buffer(&document, buffer, strlen(buffer));
+    assert(ret.is_okay == true);
+    ptr_list = document.ptr_root->ptr_data;
+    struct abel_object* ptr_root_dict = abel_list_get_object_pointer(ptr_list, 0);
+    ptr_dict = ptr_root_dict->ptr_data;
+    struct abel_object* ptr_obj = abel_make_object_ptr_from_double(5);
+    ret = abel_dict_insert(ptr_dict, "e", ptr_obj);
+    assert(ret.is_error == true && ret.error.error_type == READ_ONLY);
+    ret = abel_dict_insert_interned(ptr_dict, "e", ptr_obj);
+    assert(ret.error.error_type == READ_ONLY);
+    abel_object_add_ref(ptr_obj);    // not taken by the dict
+    abel_free_object_ptr(ptr_obj);
+    assert(abel_dict_delete(ptr_dict, "a").error.error_type == READ_ONLY);
+    assert(abel_dict_size(ptr_dict) == 4);
+    assert(abel_dict_get_double(ptr_dict, "a") == 1);
+    assert(abel_list_append_bool(ptr_list, false).error.error_type == READ_ONLY);
+    assert(abel_list_set_bool(ptr_list, 0, true).error.error_type == READ_ONLY);
+    assert(abel_list_delete(ptr_list, 0).error.error_type == READ_ONLY);
+    assert(abel_list_size(ptr_list) == 1);
+    assert(abel_free_dict_ptr(ptr_dict).error.error_type == READ_ONLY);
+    // object freer leaves objects to the document
+    assert(abel_free_object_ptr(ptr_root_dict).is_okay == true);
+    assert(abel_free_object_ptr(abel_dict_get_object_ptr(ptr_dict, "d")).is_okay);
+    assert(abel_list_get_double(abel_dict_get_list_ptr(ptr_dict, "d"), 0) == 4);
+    abel_document_free(&document);
+    assert(abel_interned_key_count() == 0);
+}
+
 int main()
 {
     test_json_loader_simple_dict();
     test_json_loader_nested();
+    test_json_builder_nested();
+    test_load_from_file();
+    test_arena();
+    test_document_load_file();
+    test_document_load_buffer();
 }
\ No newline at end of file
@@ -11,7 +11,7 @@ void test_json_parser_maker()
     struct json_parser test_parser; 
     abel_make_json_parser(&test_parser);
 
-    assert(abel_vector_size(&test_parser.token_vector) == 0);
+    assert(abel_token_tape_size(&test_parser.token_vector) == 0);
     assert(abel_vector_size(&test_parser.parent_key) == 1);
 
     abel_free_json_parser(&test_parser);
@@ -27,28 +27,32 @@ void test_parse_file()
 {
     struct json_parser test_parser;
     abel_make_json_parser(&test_parser);
-    assert(abel_vector_size(&test_parser.token_vector) == 0);
+    assert(abel_token_tape_size(&test_parser.token_vector) == 0);
     assert(abel_vector_size(&test_parser.parent_key) == 1);
 
-    abel_parse_file(&test_parser, "test.txt");
+    struct abel_return_option ret = abel_parse_file(&test_parser, "test.txt");
+    assert(ret.is_okay == true);
     
-    size_t token_vector_size = abel_vector_size(&test_parser.token_vector);
+    size_t token_vector_size = abel_token_tape_size(&test_parser.token_vector);
 
-    json_token_ptr ptr_token;
+    struct json_token token;
+    json_token_ptr ptr_token = &token;
 
     for (size_t i = 0; i< token_vector_size; i++) {
-        ptr_token = abel_vector_at(&test_parser.token_vector, i).pointer;
+        token = abel_token_tape_at(&test_parser.token_vector, i);
         if (ptr_token->terminal_type != NONE_TERM) {
             printf("%ld th token literal is %s, scheme is %d, "
                "level is %d, parent key is %s, termimal type is %s \n",
-                i, ptr_token->literal->ptr_array, ptr_token->literal_scheme,
-                   ptr_token->level, ptr_token->parent_key->ptr_array,
+                i, abel_json_token_literal(&test_parser, ptr_token),
+                   ptr_token->literal_scheme, ptr_token->level,
+                   abel_json_token_parent_key(&test_parser, ptr_token),
                    JsonTerminalTypeString[ptr_token->terminal_type]);
         } else {
             printf("%ld th token literal is %s, scheme is %d, "
                "level is %d, parent key is %s \n",
-                i, ptr_token->literal->ptr_array, ptr_token->literal_scheme,
-                   ptr_token->level, ptr_token->parent_key->ptr_array);
+                i, abel_json_token_literal(&test_parser, ptr_token),
+                   ptr_token->literal_scheme, ptr_token->level,
+                   abel_json_token_parent_key(&test_parser, ptr_token));
         }
     }
     int root_cnt_type = *(enum json_container_type*)(abel_vector_at(&(test_parser.current_container_type), 0).pointer);
@@ -56,6 +60,419 @@ void test_parse_file()
     printf("*** 0: NONE, 1: LIST, 2: DICT, 3: UNKNOWN ***\n");
     // freer
     abel_free_json_parser(&test_parser);
+
+    /* Non-existent file is an error, parser is still freed by caller */
+    abel_make_json_parser(&test_parser);
+    ret = abel_parse_file(&test_parser, "no_such_file.txt");
+    assert(ret.is_error == true);
+    assert(ret.error.error_type == PARSER_ERROR);
+    abel_free_json_parser(&test_parser);
+}
+
+/**
+ * @brief Test parse_buffer function
+ * 
+ * The document is a single line longer than 255 chars, which
+ * used to be split by the line reader. Line and column are
+ * tracked across the new line chars in the buffer.
+ */
+void test_parse_buffer()
+{
+    struct json_parser test_parser;
+    abel_make_json_parser(&test_parser);
+    char buffer[1024] = "{\"long\": \"";
+    for (int i = 0; i < 300; i++) {
+        strcat(buffer, "x");
+    }
+    strcat(buffer, "\", # comment, \"ignored\"\n\"next\": 2}\n");
+
+    struct abel_return_option ret
+        = abel_parse_buffer(&test_parser, buffer, strlen(buffer));
+    assert(ret.is_okay == true);
+    assert(test_parser.current_line == 3);
+    assert(test_parser.current_column == 0);
+    /* root, opening, key, terminal, key, terminal, closing */
+    assert(abel_token_tape_size(&test_parser.token_vector) == 7);
+    struct json_token token = abel_token_tape_at(&test_parser.token_vector, 3);
+    assert(token.literal.length == 300);
+    token = abel_token_tape_at(&test_parser.token_vector, 4);
+    assert(strcmp(abel_json_token_literal(&test_parser, &token), "next") == 0);
+    assert(token.line == 2);
+    /* keys in the same dict share the interned parent key */
+    struct json_token first_key
+        = abel_token_tape_at(&test_parser.token_vector, 2);
+    assert(first_key.parent_key_id == token.parent_key_id);
+    assert(strcmp(abel_json_token_parent_key(&test_parser, &first_key),
+                  abel_json_token_parent_key(&test_parser, &token)) == 0);
+
+    abel_free_json_parser(&test_parser);
+
+    /* truncated buffer is not complete */
+    abel_make_json_parser(&test_parser);
+    strcpy(buffer, "{\"a\": 1, \"b\": [1, 2");
+    ret = abel_parse_buffer(&test_parser, buffer, strlen(buffer));
+    assert(ret.is_error == true);
+    assert(strcmp(ret.error.msg, "Container is not closed.") == 0);
+    abel_free_json_parser(&test_parser);
+
+    /* terminal after a key without colon has no parent key */
+    char* missing_colon[] = {"{\"a\" \"b\"}", "[1, {\"a\" \"b\"}]"};
+    for (int i = 0; i < 2; i++) {
+        abel_make_json_parser(&test_parser);
+        ret = abel_parse_buffer(&test_parser, missing_colon[i],
+                                strlen(missing_colon[i]));
+        assert(ret.is_error == true);
+        assert(strcmp(ret.error.msg, "Parent key is missing.") == 0);
+        abel_free_json_parser(&test_parser);
+    }
+}
+
+/**
+ * @brief Test parse_file_mapped function
+ * 
+ * Mapped file shall produce the same tokens as file parser.
+ */
+void test_parse_file_mapped()
+{
+    struct json_parser file_parser;
+    struct json_parser mapped_parser;
+    abel_make_json_parser(&file_parser);
+    abel_make_json_parser(&mapped_parser);
+    abel_parse_file(&file_parser, "test.txt");
+    struct abel_return_option ret
+        = abel_parse_file_mapped(&mapped_parser, "test.txt");
+    assert(ret.is_okay == true);
+
+    size_t token_vector_size = abel_token_tape_size(&file_parser.token_vector);
+    assert(abel_token_tape_size(&mapped_parser.token_vector) == token_vector_size);
+    for (size_t i = 0; i < token_vector_size; i++) {
+        struct json_token file_token
+            = abel_token_tape_at(&file_parser.token_vector, i);
+        struct json_token mapped_token
+            = abel_token_tape_at(&mapped_parser.token_vector, i);
+        assert(strcmp(abel_json_token_literal(&file_parser, &file_token),
+                      abel_json_token_literal(&mapped_parser, &mapped_token)) == 0);
+        assert(file_token.line == mapped_token.line);
+    }
+    /* Non-existent file is an error */
+    ret = abel_parse_file_mapped(&mapped_parser, "no_such_file.txt");
+    assert(ret.is_error == true);
+    assert(ret.error.error_type == PARSER_ERROR);
+
+    abel_free_json_parser(&file_parser);
+    abel_free_json_parser(&mapped_parser);
+}
+
+/**
+ * @brief Test feed and finish functions
+ * 
+ * Document split at any position, including inside a string
+ * and right after an escaping back slash, shall produce the
+ * same tokens as the whole document.
+ */
+void test_parser_feed()
+{
+    char* buffer = "{\"k\\\"ey\": \"a\\\\b\\\"c\",\n"
+                   " \"list\": [true, 12.5, null] # note\n}\n";
+    size_t length = strlen(buffer);
+    struct json_parser whole_parser;
+    abel_make_json_parser(&whole_parser);
+    struct abel_return_option ret
+        = abel_parse_buffer(&whole_parser, buffer, length);
+    assert(ret.is_okay == true);
+    size_t token_vector_size = abel_token_tape_size(&whole_parser.token_vector);
+
+    for (size_t split = 0; split <= length; split++) {
+        struct json_parser fed_parser;
+        abel_make_json_parser(&fed_parser);
+        ret = abel_parser_feed(&fed_parser, buffer, split);
+        assert(ret.is_okay == true);
+        ret = abel_parser_feed(&fed_parser, buffer + split, length - split);
+        assert(ret.is_okay == true);
+        ret = abel_parser_finish(&fed_parser);
+        assert(ret.is_okay == true);
+        assert(fed_parser.current_line == whole_parser.current_line);
+        assert(abel_token_tape_size(&fed_parser.token_vector)
+               == token_vector_size);
+        for (size_t i = 0; i < token_vector_size; i++) {
+            struct json_token whole_token
+                = abel_token_tape_at(&whole_parser.token_vector, i);
+            struct json_token fed_token
+                = abel_token_tape_at(&fed_parser.token_vector, i);
+            assert(strcmp(abel_json_token_literal(&whole_parser, &whole_token),
+                          abel_json_token_literal(&fed_parser, &fed_token)) == 0);
+            assert(whole_token.type == fed_token.type);
+        }
+        abel_free_json_parser(&fed_parser);
+    }
+    abel_free_json_parser(&whole_parser);
+
+    /* Incomplete documents fail to finish */
+    char* incomplete[] = {"", "{\"a\": \"b", "[1, [2]"};
+    for (int i = 0; i < 3; i++) {
+        struct json_parser fed_parser;
+        abel_make_json_parser(&fed_parser);
+        ret = abel_parser_feed(&fed_parser, incomplete[i],
+                               strlen(incomplete[i]));
+        assert(ret.is_okay == true);
+        ret = abel_parser_finish(&fed_parser);
+        assert(ret.is_error == true);
+        assert(ret.error.error_type == PARSER_ERROR);
+        abel_free_json_parser(&fed_parser);
+    }
+
+    /* Nothing but spaces and comments follows the root */
+    char* trailing[] = {"{} x", "{\"a\": 1}{\"b\": 2}", "[1] [2]", "{},"};
+    for (int i = 0; i < 4; i++) {
+        struct json_parser fed_parser;
+        abel_make_json_parser(&fed_parser);
+        ret = abel_parser_feed(&fed_parser, trailing[i], strlen(trailing[i]));
+        assert(ret.is_error == true);
+        assert(strcmp(ret.error.msg, "Content after root container.") == 0);
+        abel_free_json_parser(&fed_parser);
+    }
+    abel_make_json_parser(&whole_parser);
+    buffer = "{\"a\": 1} # done\n  ";
+    ret = abel_parse_buffer(&whole_parser, buffer, strlen(buffer));
+    assert(ret.is_okay == true);
+    abel_free_json_parser(&whole_parser);
+
+    /* Closing symbol without opening one */
+    char* unopened[] = {"{\"a\": 1}}", "[1]]", "]"};
+    for (int i = 0; i < 3; i++) {
+        struct json_parser fed_parser;
+        abel_make_json_parser(&fed_parser);
+        ret = abel_parser_feed(&fed_parser, unopened[i], strlen(unopened[i]));
+        assert(ret.is_error == true);
+        assert(strcmp(ret.error.msg,
+                      "Closing symbol has no opening symbol.") == 0);
+        abel_free_json_parser(&fed_parser);
+    }
+}
+
+/**
+ * @brief Static - Append a delimited string of given length
+ * 
+ * Body is made of letters, with an escape sequence or a
+ * new line char placed at the given offset from the opening
+ * quote.
+ */
+static void append_long_string(char* doc, size_t body_length,
+                               const char* escape, size_t escape_offset)
+{
+    size_t end = strlen(doc);
+    doc[end++] = '"';
+    for (size_t i = 0; i < body_length; i++) {
+        doc[end++] = (char)('a' + i % 26);
+    }
+    doc[end] = '\0';
+    memcpy(doc + end - body_length + escape_offset, escape, strlen(escape));
+    strcat(doc, "\"");
+}
+
+/**
+ * @brief Test long strings and space runs
+ * 
+ * Strings and indentation long enough for the block scanners,
+ * with escapes and new lines right before, on and after block
+ * boundaries,
+ * produce the same tokens as the document fed char by char,
+ * which only takes the scalar path.
+ */
+void test_parse_long_runs()
+{
+    size_t lengths[] = {16, 31, 32, 33, 100, 130};
+    size_t offsets[] = {0, 14, 15, 16, 30, 31, 32, 63, 64};
+    char* escapes[] = {"\\\"", "\\\\", "\n"};
+    char* doc = malloc(65536);
+    doc[0] = '\0';
+    strcat(doc, "{\n");
+    int count = 0;
+    for (size_t l = 0; l < 6; l++) {
+        for (size_t o = 0; o < 9; o++) {
+            for (size_t e = 0; e < 3; e++) {
+                if (offsets[o] + 2 > lengths[l]) {
+                    continue;
+                }
+                /* indentation of 1 to 96 spaces */
+                size_t indent = 1 + (size_t)(count * 7) % 96;
+                size_t end = strlen(doc);
+                memset(doc + end, ' ', indent);
+                sprintf(doc + end + indent, "\"k%d\": ", count);
+                append_long_string(doc, lengths[l], escapes[e], offsets[o]);
+                strcat(doc, ",\n");
+                count++;
+            }
+        }
+    }
+    strcat(doc, "                                      \"last\": [1, 2]\n}\n");
+    size_t length = strlen(doc);
+
+    struct json_parser whole_parser;
+    struct json_parser fed_parser;
+    abel_make_json_parser(&whole_parser);
+    abel_make_json_parser(&fed_parser);
+    struct abel_return_option ret = abel_parse_buffer(&whole_parser, doc, length);
+    assert(ret.is_okay == true);
+    assert(abel_parser_finish(&whole_parser).is_okay == true);
+    for (size_t i = 0; i < length; i++) {
+        ret = abel_parser_feed(&fed_parser, doc + i, 1);
+        assert(ret.is_okay == true);
+    }
+    assert(abel_parser_finish(&fed_parser).is_okay == true);
+
+    size_t token_vector_size = abel_token_tape_size(&whole_parser.token_vector);
+    assert(token_vector_size > (size_t)count * 2);
+    assert(abel_token_tape_size(&fed_parser.token_vector) == token_vector_size);
+    for (size_t i = 0; i < token_vector_size; i++) {
+        struct json_token whole_token
+            = abel_token_tape_at(&whole_parser.token_vector, i);
+        struct json_token fed_token
+            = abel_token_tape_at(&fed_parser.token_vector, i);
+        assert(strcmp(abel_json_token_literal(&whole_parser, &whole_token),
+                      abel_json_token_literal(&fed_parser, &fed_token)) == 0);
+        assert(whole_token.type == fed_token.type);
+        assert(whole_token.line == fed_token.line);
+    }
+    assert(whole_parser.current_line == fed_parser.current_line);
+    abel_free_json_parser(&whole_parser);
+    abel_free_json_parser(&fed_parser);
+    free(doc);
+}
+
+/* SAX event counter */
+struct sax_counter {
+    int keys;
+    int terminals;
+    int opens;
+    int closes;
+    int deepest_level;
+    double sum;
+    int trues;
+    int strings;
+};
+
+void count_key(void* ptr_context, const char* key, size_t length, int level)
+{
+    struct sax_counter* ptr_counter = ptr_context;
+    assert(strlen(key) == length);
+    ptr_counter->keys += 1;
+    (void)level;
+}
+
+void count_terminal(void* ptr_context, const struct json_sax_value* ptr_value,
+                    int level)
+{
+    struct sax_counter* ptr_counter = ptr_context;
+    ptr_counter->terminals += 1;
+    ptr_counter->sum += ptr_value->double_value;
+    if (ptr_value->bool_value == true) {
+        ptr_counter->trues += 1;
+    }
+    if (ptr_value->terminal_type == STRING_TERM) {
+        assert(strcmp(ptr_value->literal, "two") == 0);
+        assert(level == 2);
+        ptr_counter->strings += 1;
+    }
+}
+
+void count_open(void* ptr_context, enum json_container_type container_type,
+                int level)
+{
+    struct sax_counter* ptr_counter = ptr_context;
+    ptr_counter->opens += 1;
+    if (level > ptr_counter->deepest_level) {
+        ptr_counter->deepest_level = level;
+    }
+    (void)container_type;
+}
+
+void count_close(void* ptr_context, enum json_container_type container_type,
+                 int level)
+{
+    struct sax_counter* ptr_counter = ptr_context;
+    ptr_counter->closes += 1;
+    (void)container_type;
+    (void)level;
+}
+
+/**
+ * @brief Test SAX handler
+ * 
+ * Events are counted and no token is kept.
+ */
+void test_sax_handler()
+{
+    struct sax_counter counter = {0, 0, 0, 0, 0, 0.0, 0, 0};
+    struct json_sax_handler handler;
+    handler.ptr_context = &counter;
+    handler.on_key = count_key;
+    handler.on_terminal = count_terminal;
+    handler.on_container_open = count_open;
+    handler.on_container_close = count_close;
+
+    struct json_parser test_parser;
+    abel_make_json_parser(&test_parser);
+    abel_json_parser_set_sax_handler(&test_parser, &handler);
+    char* buffer = "{\"a\": 1.5, \"b\": [true, \"two\", null], "
+                   "\"c\": {\"d\": 2}}";
+    struct abel_return_option ret
+        = abel_parse_buffer(&test_parser, buffer, strlen(buffer));
+    assert(ret.is_okay == true);
+    assert(counter.keys == 4);
+    assert(counter.terminals == 5);
+    assert(counter.opens == 3);
+    assert(counter.closes == 3);
+    assert(counter.deepest_level == 1);
+    assert(counter.sum == 3.5);
+    assert(counter.trues == 1);
+    assert(counter.strings == 1);
+    assert(abel_token_tape_size(&test_parser.token_vector) == 0);
+    abel_free_json_parser(&test_parser);
+
+    /* Key table doesn't grow with the length of a list */
+    char records[16384] = "[";
+    char record[32];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(record, "%s{\"id\": %d}", (i == 0) ? "" : ", ", i);
+        strcat(records, record);
+    }
+    strcat(records, "]");
+    abel_make_json_parser(&test_parser);
+    abel_json_parser_set_sax_handler(&test_parser, &handler);
+    ret = abel_parse_buffer(&test_parser, records, strlen(records));
+    assert(ret.is_okay == true);
+    /* "ROOT_KEY_" and "id" */
+    assert(abel_vector_size(&test_parser.parent_key_table) == 2);
+    abel_free_json_parser(&test_parser);
+
+    /* Same key in sibling dicts is not a duplicate */
+    abel_make_json_parser(&test_parser);
+    buffer = "[[{\"a\": 1}], [{\"a\": 1}], {\"a\": {\"a\": 2}}]";
+    ret = abel_parse_buffer(&test_parser, buffer, strlen(buffer));
+    assert(ret.is_okay == true);
+    abel_free_json_parser(&test_parser);
+
+    /* Duplicate in the same dict still is */
+    abel_make_json_parser(&test_parser);
+    buffer = "[{\"a\": 1}, {\"a\": 1, \"a\": 2}]";
+    ret = abel_parse_buffer(&test_parser, buffer, strlen(buffer));
+    assert(ret.is_error == true);
+    assert(strcmp(ret.error.msg, "Key 'a' is a duplicate.") == 0);
+    abel_free_json_parser(&test_parser);
+
+    /* Message of a long duplicate key is truncated */
+    abel_make_json_parser(&test_parser);
+    char long_keys[640];
+    char long_key[300];
+    memset(long_key, 'k', 299);
+    long_key[299] = '\0';
+    snprintf(long_keys, sizeof(long_keys), "{\"%s\": 1, \"%s\": 2}",
+             long_key, long_key);
+    ret = abel_parse_buffer(&test_parser, long_keys, strlen(long_keys));
+    assert(ret.is_error == true);
+    assert(strncmp(ret.error.msg, "Key 'kkk", 8) == 0);
+    abel_free_json_parser(&test_parser);
 }
 
 int main(void)
@@ -65,4 +482,13 @@ int main(void)
 
 /* parse file */
     test_parse_file();
+
+/* parse buffer */
+    test_parse_buffer();
+    test_parse_file_mapped();
+    test_parser_feed();
+    test_parse_long_runs();
+
+/* SAX */
+    test_sax_handler();
 }
\ No newline at end of file
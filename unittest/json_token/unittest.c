@@ -8,82 +8,118 @@ void test_get_token_type_str()
     assert(strcmp(type_str, "KEY") == 0);
 }
 
+void test_slice_append()
+{
+    struct abel_string pool = abel_make_string("");
+    struct json_slice first = json_slice_append(&pool, "Root", 4);
+    struct json_slice second = json_slice_append(&pool, "mod", 3);
+    assert(first.offset == 0 && first.length == 4);
+    /* each literal is followed by a null char in pool */
+    assert(second.offset == 5 && second.length == 3);
+    assert(strcmp(json_slice_cstr(&pool, first), "Root") == 0);
+    assert(strcmp(json_slice_cstr(&pool, second), "mod") == 0);
+
+    abel_free_string(&pool);
+}
+
 void test_tokenize_iter_key()
 {
     struct json_token test_token;
-    struct abel_string literal = abel_make_string("0");
-    struct abel_string pk = abel_make_string("mod");
-    test_token = tokenize_iter_key(&literal, &pk, 0, 3, LIST, 0);
-    assert(abel_string_eq_cstring(test_token.literal, "0") == true);
-    assert(abel_string_eq_cstring(test_token.parent_key, "mod") == true);
+    struct abel_string pool = abel_make_string("");
+    struct json_slice literal = json_slice_append(&pool, "0", 1);
+    test_token = tokenize_iter_key(literal, 2, 0, 3, LIST, 0);
+    assert(strcmp(json_slice_cstr(&pool, test_token.literal), "0") == 0);
+    assert(test_token.parent_key_id == 2);
     assert(test_token.type == ITER_KEY);
     assert(test_token.container_type == LIST);
 
-    abel_free_json_token(&test_token);
-    abel_free_string(&literal);
-    abel_free_string(&pk);
+    abel_free_string(&pool);
 }
 
 void test_tokenize_key()
 {
     struct json_token test_token;
-    struct abel_string literal = abel_make_string("Root");
-    struct abel_string pk = abel_make_string("mod");
+    struct abel_string pool = abel_make_string("");
+    struct json_slice literal = json_slice_append(&pool, "Root", 4);
 
-    test_token = tokenize_key(&literal, &pk, 0, 3, LIST, LIBERAL);
-    assert(abel_string_eq_cstring(test_token.literal, "Root") == true);
-    assert(abel_string_eq_cstring(test_token.parent_key, "mod") == true);
+    test_token = tokenize_key(literal, 2, 0, 3, LIST, LIBERAL);
+    assert(strcmp(json_slice_cstr(&pool, test_token.literal), "Root") == 0);
+    assert(test_token.parent_key_id == 2);
     assert(test_token.type == KEY);
     assert(test_token.container_type == LIST);
     assert(test_token.literal_scheme == LIBERAL);
 
-    abel_free_json_token(&test_token);
-    abel_free_string(&literal);
-    abel_free_string(&pk);
+    abel_free_string(&pool);
 }
 
 void test_tokenize_terminal()
 {
     struct json_token test_token;
-    struct abel_string literal = abel_make_string("Root");
-    struct abel_string pk = abel_make_string("mod");
-    test_token = tokenize_terminal(&literal, &pk, 0, 3, LIST, STRING_TERM, LIBERAL);
-    assert(abel_string_eq_cstring(test_token.literal, "Root") == true);
-    assert(abel_string_eq_cstring(test_token.parent_key, "mod") == true);
+    struct abel_string pool = abel_make_string("");
+    struct json_slice literal = json_slice_append(&pool, "Root", 4);
+    test_token = tokenize_terminal(literal, 2, 0, 3, LIST, STRING_TERM, LIBERAL);
+    assert(strcmp(json_slice_cstr(&pool, test_token.literal), "Root") == 0);
+    assert(test_token.parent_key_id == 2);
     assert(test_token.type == TERMINAL);
     assert(test_token.container_type == LIST);
     assert(test_token.literal_scheme == LIBERAL);
 
-    abel_free_json_token(&test_token);
-    abel_free_string(&literal);
-    abel_free_string(&pk);
+    abel_free_string(&pool);
 }
 
 void test_token_ptr()
 {
     struct json_token test_token;
-    struct abel_string literal = abel_make_string("Root");
-    struct abel_string pk = abel_make_string("mod");
-    test_token = tokenize_terminal(&literal, &pk, 0, 3, LIST, STRING_TERM, LIBERAL);
-    assert(abel_string_eq_cstring(test_token.literal, "Root") == true);
-    assert(abel_string_eq_cstring(test_token.parent_key, "mod") == true);
-    assert(test_token.type == TERMINAL);
-    assert(test_token.container_type == LIST);
-    assert(test_token.literal_scheme == LIBERAL);
+    struct abel_string pool = abel_make_string("");
+    struct json_slice literal = json_slice_append(&pool, "Root", 4);
+    test_token = tokenize_terminal(literal, 2, 0, 3, LIST, STRING_TERM, LIBERAL);
 
     json_token_ptr ptr_token = abel_make_token_ptr(&test_token);
-    assert(abel_string_eq_cstring(ptr_token->literal, "Root") == true);
-    assert(abel_string_eq_cstring(ptr_token->parent_key, "mod") == true);
+    assert(strcmp(json_slice_cstr(&pool, ptr_token->literal), "Root") == 0);
+    assert(ptr_token->parent_key_id == 2);
     assert(ptr_token->type == TERMINAL);
     assert(ptr_token->container_type == LIST);
     assert(ptr_token->literal_scheme == LIBERAL);
 
     /* Clean up */
-    abel_free_string(&literal);
-    abel_free_string(&pk);
+    abel_free_string(&pool);
     abel_free_json_token_ptr(ptr_token);
 }
 
+void test_token_tape()
+{
+    struct abel_string pool = abel_make_string("");
+    struct json_token_tape tape = abel_make_token_tape();
+    assert(abel_token_tape_size(&tape) == 0);
+
+    /* push enough tokens to grow the tape a few times */
+    for (int i = 0; i < 1000; i++) {
+        struct abel_string literal = abel_string_from_int(i);
+        struct json_token token = tokenize_iter_key(
+            json_slice_append(&pool, abel_string_cstr(&literal), literal.length),
+            7, 1, i + 1, LIST, i);
+        struct abel_return_option ret = abel_token_tape_push_back(&tape, &token);
+        assert(ret.is_okay == true);
+        abel_free_string(&literal);
+    }
+    assert(abel_token_tape_size(&tape) == 1000);
+    assert(tape.capacity >= 1000);
+
+    struct json_token token = abel_token_tape_at(&tape, 999);
+    assert(strcmp(json_slice_cstr(&pool, token.literal), "999") == 0);
+    assert(token.type == ITER_KEY);
+    assert(token.parent_key_id == 7);
+    assert(token.line == 1000);
+    assert(token.iter_index == 999);
+    /* fields can also be walked array by array */
+    assert(tape.ptr_types[0] == ITER_KEY);
+    assert(tape.ptr_levels[500] == 1);
+
+    abel_free_token_tape(&tape);
+    assert(abel_token_tape_size(&tape) == 0);
+    abel_free_string(&pool);
+}
+
 void test_get_token_type_by_symbol()
 {
     char* test_str = "]";
@@ -101,12 +137,45 @@ void test_get_token_type_by_symbol()
     assert(get_token_type_by_symbol(test_str) != LIST_OPENING);
 }
 
+/**
+ * @brief Test matching indices on tape
+ * 
+ * Tokens of [ { } [ ] [ are pushed, the last container is
+ * left open.
+ */
+void test_token_tape_matching()
+{
+    enum json_token_type types[] = {LIST_OPENING, DICT_OPENING, DICT_CLOSING,
+                                    LIST_OPENING, LIST_CLOSING, LIST_OPENING};
+    struct abel_string pool = abel_make_string("");
+    struct json_token_tape tape = abel_make_token_tape();
+    for (int i = 0; i < 6; i++) {
+        struct json_token token = tokenize(json_slice_append(&pool, "x", 1),
+                                           types[i], 0, 1, 1, LIST);
+        abel_token_tape_push_back(&tape, &token);
+    }
+    assert(abel_token_tape_closing_index(&tape, 1) == 2);
+    assert(abel_token_tape_closing_index(&tape, 3) == 4);
+    assert(tape.ptr_matching_indices[2] == 1);
+    assert(tape.ptr_matching_indices[4] == 3);
+    /* open containers end at the tape size */
+    assert(abel_token_tape_closing_index(&tape, 0) == 6);
+    assert(abel_token_tape_closing_index(&tape, 5) == 6);
+    assert(tape.open_index == 5);
+
+    abel_free_token_tape(&tape);
+    abel_free_string(&pool);
+}
+
 int main()
 {
     test_get_token_type_str();
+    test_slice_append();
     test_tokenize_iter_key();
     test_tokenize_key();
     test_tokenize_terminal();
     test_token_ptr();
+    test_token_tape();
+    test_token_tape_matching();
     test_get_token_type_by_symbol();
 }
\ No newline at end of file
@@ -53,12 +53,14 @@ void test_list_append_bool()
 {
     struct abel_list* ptr_test_list = abel_make_list_ptr(0);
     abel_list_append_bool(ptr_test_list, false);
-    assert(abel_list_size(ptr_test_list) == 1);
+    abel_list_append_bool(ptr_test_list, false);
+    assert(abel_list_size(ptr_test_list) == 2);
     assert(abel_list_capacity(ptr_test_list) == 2);
     assert(abel_list_is_empty(ptr_test_list) == false);
-    assert( ((struct abel_object*)(ptr_test_list->ptr_vector->ptr_array[0]))->ref_count == 1 );
-    /* get via vector */
-    assert( ((struct abel_object*)(abel_vector_get(ptr_test_list->ptr_vector, 0).pointer))->ref_count == 1 );
+    /* both are the immortal false, ref count pinned */
+    assert(ptr_test_list->ptr_vector->ptr_array[0] == abel_bool_object_ptr(false));
+    assert( ((struct abel_object*)(abel_vector_get(ptr_test_list->ptr_vector, 1).pointer))->ref_count == OBJECT_IMMORTAL_REF_COUNT );
+    assert(abel_list_get_bool(ptr_test_list, 1) == false);
     abel_free_list_ptr(ptr_test_list);
 }
 
@@ -79,7 +81,7 @@ void test_list_append_string()
 void test_list_append_int()
 {
     struct abel_list* ptr_test_list = abel_make_list_ptr(0);
-    abel_list_append_bool(ptr_test_list, 100);
+    abel_list_append_int(ptr_test_list, 100);
     assert(abel_list_size(ptr_test_list) == 1);
     assert(abel_list_capacity(ptr_test_list) == 2);
     assert(abel_list_is_empty(ptr_test_list) == false);
@@ -91,7 +93,7 @@ void test_list_append_int()
 void test_list_append_double()
 {
     struct abel_list* ptr_test_list = abel_make_list_ptr(0);
-    abel_list_append_bool(ptr_test_list, 3.96);
+    abel_list_append_double(ptr_test_list, 3.96);
     assert(abel_list_size(ptr_test_list) == 1);
     assert(abel_list_capacity(ptr_test_list) == 2);
     assert(abel_list_is_empty(ptr_test_list) == false);
@@ -1,18 +1,17 @@
 /* Unittest map */
 #include <assert.h>
+#include <stdio.h>
 #include "map.h"
 
 void test_abel_map_make()
 {
     struct abel_map* ptr_test_map = abel_make_map_ptr();
-    assert(abel_vector_size(ptr_test_map->ptr_pair_vector) == 2048);
-    assert(abel_vector_size(ptr_test_map->ptr_coll_vector) == 2048);
+    assert(abel_map_capacity(ptr_test_map) == MAP_SMALL_CAPACITY);
+    assert(ptr_test_map->ptr_slots == NULL);
     assert(ptr_test_map->size == 0);
     
     /* Clean up */
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 void test_abel_map_insert()
@@ -22,7 +21,7 @@ void test_abel_map_insert()
     /* First, make a map on heap. */
     struct abel_map* ptr_test_map = abel_make_map_ptr();
     /* I want to insert pair ("Hello", 777) into the map */
-    char* test_key = "Hello"; // converted to 975
+    char* test_key = "Hello";
     int test_value = 777;
 
     /* Insert. It is the first time, so the return shall be okay. */
@@ -30,207 +29,22 @@ void test_abel_map_insert()
     assert(ptr_test_map->size == 1);
     assert(ret.pointer != NULL);
     assert( *(int*)((struct abel_key_value_pair*)ret.pointer)->ptr_data == 777);
-    /* Let me access the pair vector directly. */
-    struct abel_key_value_pair* ptr_pair_aquired = abel_vector_at(ptr_test_map->ptr_pair_vector, 975).pointer;
+    /* Small map holds the pair inline, no slot table yet. */
+    assert(ptr_test_map->ptr_slots == NULL);
+    assert(ptr_test_map->small_slots[0].ptr_pair == ret.pointer);
+    struct abel_key_value_pair* ptr_pair_aquired = abel_map_find(ptr_test_map, "Hello").pointer;
     assert(strcmp(ptr_pair_aquired->key, "Hello") == 0);
+    /* Pair caches the hash and the length of its key, key is inline */
+    assert(ptr_pair_aquired->key_length == 5);
+    assert(ptr_pair_aquired->hash == ptr_test_map->small_slots[0].hash);
+    assert(ptr_pair_aquired->key == ptr_pair_aquired->key_chars);
 
     /* Now let me insert again a pair that has the same key */
     struct abel_return_option ret2 = abel_map_insert(ptr_test_map, test_key, &test_value);
     assert(ret2.error.error_type == KEY_EXISTS);
 
     /* Clean up */
-    abel_free_pair( (struct abel_key_value_pair*)ret.pointer );
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
-}
-
-/**
- * @brief Test key collision
- * 
- * In this test, a pair with key "World" is manually placed at
- * the position corresponding to key "Hello", ie index 975.
- * The pair with key "Hello" will be place by using the public
- * interface, to simulate the key collision.
- * 
- * The result of this test is that the new pair shall be stored
- * collision vector.
- */
-void test_key_collision_first_register()
-{
-    struct abel_return_option ret; /* Get the return option ready */
-    /* 
-        First, make a map on heap.
-    */
-    struct abel_map* ptr_test_map = abel_make_map_ptr();
-
-    /*
-        Now I manually place a pair at index 975
-    */
-    char* test_key_1 = "World";
-    double test_value_1 = 3.14;
-    /*
-        To do that, I have manually make a pair on heap ... 
-    */
-    struct abel_key_value_pair* ptr_pair_1 = NULL;
-    ptr_pair_1 = malloc( sizeof(*ptr_pair_1) );
-    ptr_pair_1->key = malloc(strlen(test_key_1) + 1);
-    strcpy(ptr_pair_1->key, test_key_1);
-    ptr_pair_1->ptr_data = &test_value_1;
-    /*
-        ... and place it at index 975 on pair vector
-    */
-    ptr_test_map->ptr_pair_vector->ptr_array[975] = ptr_pair_1;
-    ptr_test_map->size += 1;
-
-    /*
-        Then, call public interface to insert another pair
-    */
-    char* test_key_2 = "Hello";
-    int test_value_2 = 777;
-    ret = abel_map_insert(ptr_test_map, test_key_2, &test_value_2);
-    /*
-        Returned shall be this pair stored in collision vector
-    */
-    struct abel_key_value_pair* ptr_ret_pair = ret.pointer;
-    assert(strcmp(ptr_ret_pair->key, "Hello") == 0);
-    assert(*(int*)(ptr_ret_pair->ptr_data) == 777);
-    assert(ptr_test_map->size == 2);
-
-    /*
-        Okay, let me check this directly in the collision vector
-    */
-    struct abel_key_value_pair* ptr_new_pair
-        = ( (struct abel_linked_list*)ptr_test_map->ptr_coll_vector->ptr_array[975] )->ptr_data;
-    /*
-        Key in this pair is "Hello"
-    */
-    assert(strcmp(ptr_new_pair->key, "Hello") == 0);
-    /*
-        Value in this pair is 777
-    */
-    int value = *(int*)(ptr_new_pair->ptr_data);
-    assert(value == 777);
-
-    /*
-        After all this, if I attempt inserting a pair ("Hello", 123)
-        the return shall be error typed KEY EXISTS.
-    */
-    struct abel_return_option ret2
-        = abel_map_insert(ptr_test_map, test_key_2, &test_value_2);
-    assert(ret2.error.error_type == KEY_EXISTS);
-
-    /* Clean up */
-    abel_free_pair(ptr_pair_1);
-    abel_free_pair( (struct abel_key_value_pair*)ret.pointer );
-    /* Caution. Must free the linked list. */
-    free(ptr_test_map->ptr_coll_vector->ptr_array[975]);
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
-}
-
-/**
- * @brief Test key collision with collided key.
- * 
- * In this test, I will manually occupy the elements indexed 975
- * in both pair vector and collision vector, to simulate the case
- * that for that index, there already exists a collided key.
- * 
- */
-void test_key_collision_second_register()
-{
-    /* 
-        First, make a map on heap and get retur option ready.
-    */
-    struct abel_map* ptr_test_map = abel_make_map_ptr();
-    struct abel_return_option ret;
-
-    /*
-        Now I manually place a pair at index 975 on pair vector
-    */
-    char* test_key_1 = "World";
-    double test_value_1 = 3.14;
-    /*
-        To do that, I have manually make a pair on heap, because
-        the pair maker is a static function. :(
-    */
-    struct abel_key_value_pair* ptr_pair_1 = NULL;
-    ptr_pair_1 = malloc( sizeof(*ptr_pair_1) );
-    ptr_pair_1->key = malloc(strlen(test_key_1) + 1);
-    strcpy(ptr_pair_1->key, test_key_1);
-    ptr_pair_1->ptr_data = &test_value_1;
-    /*
-        ... and place it at index 975 on pair vector.
-        Don't forget to manually adjust the map size.
-    */
-    ptr_test_map->ptr_pair_vector->ptr_array[975] = ptr_pair_1;
-    ptr_test_map->size += 1;
-
-    /*
-        Second, I will associate another pair with the index 975
-        on collision vector, to simulate the scenario that one
-        collided key was already registered. But, this time, 
-        I need linked list too.
-    */
-    char* test_key_2 = "Vader";
-    int test_value_2 = 543;
-    /*
-        Again, I need to manually make the pair.
-    */
-    struct abel_key_value_pair* ptr_pair_2 = NULL;
-    ptr_pair_2 = malloc( sizeof(*ptr_pair_2) );
-    ptr_pair_2->key = malloc(strlen(test_key_2) + 1);
-    strcpy(ptr_pair_2->key, test_key_2);
-    ptr_pair_2->ptr_data = &test_value_2;
-    /*
-        And of course, manually place it in the collision vector.
-    */
-    abel_vector_emplace(ptr_test_map->ptr_coll_vector, 975,
-                        abel_make_linked_list_node(ptr_pair_2) );
-    ptr_test_map->size++;    /* increase map size */
-
-    /*
-        Up to now, we have two pairs ("World", 3.14) and ("Vader", 543) 
-        registered on the map. They are both occupying index 975. If I
-        further insert ("Hello", 777), which is a key collision, but this
-        pair will be registered as the key is different. However, the
-        registration this time shall be on the collision vector with
-        a linked list node.
-    */
-    char* test_key_3 = "Hello";
-    int test_value_3 = 777;
-    ret = abel_map_insert(ptr_test_map, test_key_3, &test_value_3);
-    assert(*(int*)((struct abel_key_value_pair*)ret.pointer)->ptr_data == 777);
-
-    /*
-        This newly added pair is found by searching along the linked
-        list. Fine! Let me go along that manually. The head node is
-        associated with ("Vader", 543)
-    */
-    struct abel_linked_list* ptr_node_for_2
-        = (struct abel_linked_list*)(ptr_test_map->ptr_coll_vector->ptr_array[975]);
-    struct abel_key_value_pair* ptr_acquired_pair_2 = ptr_node_for_2->ptr_data;
-    assert(*(int*)ptr_acquired_pair_2->ptr_data == 543);
-    assert(strcmp(ptr_acquired_pair_2->key, "Vader") == 0);
-    /*
-        Next node on the linked list is associated with 
-    */
-    struct abel_linked_list* ptr_node_for_3 = ptr_node_for_2->next;
-    struct abel_key_value_pair* ptr_acquired_pair_3 = ptr_node_for_3->ptr_data;
-    assert(*(int*)ptr_acquired_pair_3->ptr_data == 777);
-    assert(strcmp(ptr_acquired_pair_3->key, "Hello") == 0);
-
-    /* Clean up */
-    abel_free_pair(ptr_pair_1);
-    abel_free_pair(ptr_pair_2);
-    abel_free_pair( (struct abel_key_value_pair*)ret.pointer );
-    /* Caution. Must free the linked list nodes . */
-    free( ((struct abel_linked_list*)(ptr_test_map->ptr_coll_vector->ptr_array[975]))->next);
-    free( ptr_test_map->ptr_coll_vector->ptr_array[975] );
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 void test_map_find()
@@ -254,6 +68,7 @@ void test_map_find()
     struct abel_return_option ret2
         = abel_map_insert(ptr_test_map, test_key_2, &test_value_2);
     assert(abel_map_size(ptr_test_map) == 2);
+    assert(ret1.is_okay == true && ret2.is_okay == true);
 
     /*
         Okay, let's get pairs.
@@ -274,11 +89,7 @@ void test_map_find()
     struct abel_return_option ret5 = abel_map_find(ptr_test_map, "some_key");
     assert(ret5.error.error_type = KEY_NOT_FOUND);
     
-    abel_free_pair(ret1.pointer);
-    abel_free_pair(ret2.pointer);
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 void test_map_at()
@@ -302,6 +113,7 @@ void test_map_at()
     struct abel_return_option ret2
         = abel_map_insert(ptr_test_map, test_key_2, &test_value_2);
     assert(abel_map_size(ptr_test_map) == 2);
+    assert(ret1.is_okay == true && ret2.is_okay == true);
 
     /*
         Okay, let's get.
@@ -322,11 +134,7 @@ void test_map_at()
     struct abel_return_option ret5 = abel_map_at(ptr_test_map, "some_key");
     assert(ret5.error.error_type = KEY_NOT_FOUND);
     
-    abel_free_pair(ret1.pointer);
-    abel_free_pair(ret2.pointer);
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 void test_map_assign()
@@ -350,6 +158,7 @@ void test_map_assign()
     struct abel_return_option ret2
         = abel_map_insert(ptr_test_map, test_key_2, &test_value_2);
     assert(abel_map_size(ptr_test_map) == 2);
+    assert(ret1.is_okay == true && ret2.is_okay == true);
 
     /*
         Okay, let's assign a different value to "int"
@@ -374,12 +183,7 @@ void test_map_assign()
     assert(ret4.error.error_type == KEY_NOT_FOUND);
 
     /* Clean up */
-    abel_free_pair(ret1.pointer);
-    abel_free_pair(ret2.pointer);
-    //abel_free_pair(ret4.pointer);
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 void test_map_erase()
@@ -430,110 +234,554 @@ void test_map_erase()
     
     abel_free_pair(ptr_pair);
     abel_free_pair(ret3.pointer);
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 /**
- * @brief Erase in the case of key collision
+ * @brief Test promotion of a small map
  * 
- * In this test, I want to delete a pair that is registered
- * on the linked list attached to the collision vector. This
- * simulates the case that a key-value pair is registered due
- * to collision.
+ * Pairs are stored inline up to MAP_SMALL_CAPACITY. One more
+ * insertion promotes the map to the hashed form, and erasing
+ * from a small map keeps the insertion order of the rest.
+ */
+void test_map_small_promote()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    char key_str[32];
+    int values[MAP_SMALL_CAPACITY + 1];
+    for (int i = 0; i < MAP_SMALL_CAPACITY; i++) {
+        values[i] = i;
+        sprintf(key_str, "key_%d", i);
+        abel_map_insert(ptr_test_map, key_str, &values[i]);
+    }
+    assert(ptr_test_map->ptr_slots == NULL);
+    assert(abel_map_size(ptr_test_map) == MAP_SMALL_CAPACITY);
+
+    /* Erase "key_2" from small map, order of the rest is kept */
+    struct abel_return_option ret = abel_map_erase(ptr_test_map, "key_2");
+    assert(ret.is_okay == true);
+    abel_free_pair(ret.pointer);
+    assert(strcmp(ptr_test_map->small_slots[2].ptr_pair->key, "key_3") == 0);
+    assert(abel_map_find(ptr_test_map, "key_2").is_error == true);
+    assert(abel_map_erase(ptr_test_map, "key_2").is_error == true);
+
+    /* Fill the inline slots again, then promote */
+    abel_map_insert(ptr_test_map, "key_2", &values[2]);
+    assert(ptr_test_map->ptr_slots == NULL);
+    values[MAP_SMALL_CAPACITY] = MAP_SMALL_CAPACITY;
+    sprintf(key_str, "key_%d", MAP_SMALL_CAPACITY);
+    abel_map_insert(ptr_test_map, key_str, &values[MAP_SMALL_CAPACITY]);
+    assert(ptr_test_map->ptr_slots != NULL);
+    assert(abel_map_capacity(ptr_test_map) > MAP_SMALL_CAPACITY);
+    assert(abel_map_size(ptr_test_map) == MAP_SMALL_CAPACITY + 1);
+    for (int i = 0; i <= MAP_SMALL_CAPACITY; i++) {
+        sprintf(key_str, "key_%d", i);
+        assert(*(int*)abel_map_at(ptr_test_map, key_str).pointer == i);
+    }
+
+    abel_free_map_ptr(ptr_test_map);
+}
+
+/**
+ * @brief Test growth of slot table
  * 
- * The hashing function used in Abel map converts "Hello" to
- * integer 975. So, I will manually place a pair ("World", 3.14)
- * at 975 on the pair vector such that, per inserting ("Hello", 777)
- * via public interface, the map will place it on the collision vector.
+ * Insert far more pairs than the former fixed table size of
+ * 2048. The slot table shall grow and every key shall remain
+ * reachable, including those still in the previous table.
+ */
+void test_map_grow()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    char key_str[32];
+    int values[10000];
+    for (int i = 0; i < 10000; i++) {
+        values[i] = i;
+        sprintf(key_str, "key_%d", i);
+        assert(abel_map_insert(ptr_test_map, key_str, &values[i]).is_okay == true);
+        assert(abel_map_size(ptr_test_map) == (size_t)(i + 1));
+    }
+    /* Capacity is a power of 2 and load factor is respected */
+    size_t capacity = abel_map_capacity(ptr_test_map);
+    assert((capacity & (capacity - 1)) == 0);
+    assert(capacity >= 10000);
+    /* All keys are found */
+    for (int i = 0; i < 10000; i++) {
+        sprintf(key_str, "key_%d", i);
+        struct abel_return_option ret = abel_map_at(ptr_test_map, key_str);
+        assert(ret.is_okay == true);
+        assert(*(int*)ret.pointer == i);
+    }
+    /* Inserting an existing key is still an error */
+    assert(abel_map_insert(ptr_test_map, "key_42", &values[0]).error.error_type
+           == KEY_EXISTS);
+    assert(abel_map_find(ptr_test_map, "key_10000").is_error == true);
+
+    abel_free_map_ptr(ptr_test_map);
+}
+
+/**
+ * @brief Test erase while migrating
  * 
- * Then, per deleting ("Hello", 777), the linked list node attached
- * to it shall also be erased and memory freed.
+ * Right after the table grows, most pairs are still held by
+ * the previous table. Erasing and finding them must behave
+ * as if there is only one table.
  */
-void test_map_erase_with_collision()
+void test_map_erase_during_migration()
 {
-    struct abel_return_option ret; /* Get the return option ready */
-    /* 
-        First, make a map on heap and manually place a pair
-        at index 975 on the pair vector.
-    */
     struct abel_map* ptr_test_map = abel_make_map_ptr();
-    char* test_key_1 = "World";
-    double test_value_1 = 3.14;
-    /*
-        To do that, I have to manually make a pair on heap, as
-        the pair maker is not part of the public interface.
-    */
-    struct abel_key_value_pair* ptr_pair_1 = NULL;
-    ptr_pair_1 = malloc( sizeof(*ptr_pair_1) );
-    ptr_pair_1->key = malloc(strlen(test_key_1) + 1);
-    strcpy(ptr_pair_1->key, test_key_1);
-    ptr_pair_1->ptr_data = &test_value_1;
-    /*
-        Now, place it at index 975 on pair vector
-    */
-    ptr_test_map->ptr_pair_vector->ptr_array[975] = ptr_pair_1;
-    ptr_test_map->size += 1;
+    char key_str[32];
+    int values[200];
+    for (int i = 0; i < 200; i++) {
+        values[i] = i;
+        sprintf(key_str, "key_%d", i);
+        abel_map_insert(ptr_test_map, key_str, &values[i]);
+    }
+    /* Erase every other key */
+    for (int i = 0; i < 200; i += 2) {
+        sprintf(key_str, "key_%d", i);
+        struct abel_return_option ret = abel_map_erase(ptr_test_map, key_str);
+        assert(ret.is_okay == true);
+        struct abel_key_value_pair* ptr_pair = ret.pointer;
+        assert(strcmp(ptr_pair->key, key_str) == 0);
+        assert(*(int*)ptr_pair->ptr_data == i);
+        abel_free_pair(ptr_pair);
+    }
+    assert(abel_map_size(ptr_test_map) == 100);
+    for (int i = 0; i < 200; i++) {
+        sprintf(key_str, "key_%d", i);
+        if (i % 2 == 0) {
+            assert(abel_map_find(ptr_test_map, key_str).error.error_type
+                   == KEY_NOT_FOUND);
+            assert(abel_map_erase(ptr_test_map, key_str).is_error == true);
+        } else {
+            assert(*(int*)abel_map_at(ptr_test_map, key_str).pointer == i);
+        }
+    }
+    /* Erased keys can be inserted again */
+    assert(abel_map_insert(ptr_test_map, "key_0", &values[0]).is_okay == true);
+    assert(abel_map_size(ptr_test_map) == 101);
+
+    abel_free_map_ptr(ptr_test_map);
+}
 
-    /*
-        Then, call public interface to insert another pair that
-        collides with the occupant at index 975.
-    */
-    char* test_key_2 = "Hello";
-    int test_value_2 = 777;
-    ret = abel_map_insert(ptr_test_map, test_key_2, &test_value_2);
-    /*
-        Returned shall be this pair stored in collision vector
-    */
-    struct abel_key_value_pair* ptr_ret_pair = ret.pointer;
-    assert(strcmp(ptr_ret_pair->key, "Hello") == 0);
-    assert(*(int*)(ptr_ret_pair->ptr_data) == 777);
-    assert(ptr_test_map->size == 2);
+/**
+ * @brief Test map with selected hash function
+ * 
+ * Every member of the family, including poor ones and a
+ * fixed seed, gives a working map.
+ */
+void test_map_with_hash()
+{
+    HashFunc hash_funcs[] = {
+        abel_hash_wy, abel_hash_fnv1a, abel_hash_murmur_oaat,
+        abel_hash_jenkins_oaat, abel_hash_djb2, abel_hash_sdbm
+    };
+    char key_str[32];
+    int values[1000];
+    for (int f = 0; f < 6; f++) {
+        struct abel_map* ptr_test_map
+                = abel_make_map_ptr_with_hash(hash_funcs[f], 42);
+        assert(ptr_test_map->hash_func == hash_funcs[f]);
+        assert(ptr_test_map->hash_seed == 42);
+        for (int i = 0; i < 1000; i++) {
+            values[i] = i;
+            sprintf(key_str, "key_%d", i);
+            assert(abel_map_insert(ptr_test_map, key_str, &values[i]).is_okay
+                   == true);
+        }
+        for (int i = 0; i < 1000; i++) {
+            sprintf(key_str, "key_%d", i);
+            assert(*(int*)abel_map_at(ptr_test_map, key_str).pointer == i);
+        }
+        abel_free_map_ptr(ptr_test_map);
+    }
+    /* Default map is seeded by process seed */
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    assert(ptr_test_map->hash_func == abel_hash_wy);
+    assert(ptr_test_map->hash_seed == abel_hash_process_seed());
+    abel_free_map_ptr(ptr_test_map);
+}
 
-    /*
-        Up to now, the map shall have size 2 and the above keys
-        are available. Caution! It is not possible to enquire the
-        existence of key "World" by using public interface function
-        `abel_map_find`, because "World" is converted by hashing
-        function into an integer that is different from 975.
-    */
-    assert(abel_map_size(ptr_test_map) == 2);
-    assert(abel_map_find(ptr_test_map, "Hello").is_okay == true);
-    
-    /*
-        Let's erase "Hello". I shall expect the following:
-        (1) The pair that has this key shall be returned.
-        (2) The linked list node that is attached to this
-            key is erased and freed.
-        (3) At index 975 on the collision vector, it is
-            NULL again.
-    */
-    struct abel_return_option ret2 = abel_map_erase(ptr_test_map, "Hello");
-    assert(ret2.is_okay == true);
-    struct abel_key_value_pair* ptr_hello_pair = ret2.pointer;
-    assert(strcmp(ptr_hello_pair->key, "Hello") == 0);
-    assert(*(int*)ptr_hello_pair->ptr_data == 777);
+/**
+ * @brief Test interned keys
+ * 
+ * Equal keys share one buffer, pairs refer to it, and the
+ * key is gone once the last reference is released.
+ */
+void test_map_interned_key()
+{
+    char key_str[] = "interned";
+    const char* interned_key = abel_intern_key(key_str);
+    assert(interned_key != key_str);
+    assert(strcmp(interned_key, "interned") == 0);
+    assert(abel_intern_key("interned") == interned_key);
+    assert(abel_interned_key_count() == 1);
+    abel_release_interned_key(interned_key);
+
+    int value = 7;
+    struct abel_map* ptr_map_1 = abel_make_map_ptr();
+    struct abel_map* ptr_map_2 = abel_make_map_ptr_with_hash(abel_hash_fnv1a, 3);
+    struct abel_return_option ret
+            = abel_map_insert_interned(ptr_map_1, interned_key, &value);
+    assert(ret.is_okay == true);
+    struct abel_key_value_pair* ptr_pair_1 = ret.pointer;
+    ret = abel_map_insert_interned(ptr_map_2, interned_key, &value);
+    assert(ret.is_okay == true);
+    struct abel_key_value_pair* ptr_pair_2 = ret.pointer;
+    assert(ptr_pair_1->key == interned_key);
+    assert(ptr_pair_2->key == interned_key);
+    /* pairs hold the key, release the reference of this test */
+    abel_release_interned_key(interned_key);
+    assert(abel_interned_key_count() == 1);
+
+    /* found by pointer and by chars, duplicate is still an error */
+    assert(abel_map_find(ptr_map_1, (char*)interned_key).pointer == ptr_pair_1);
+    assert(abel_map_find(ptr_map_2, key_str).pointer == ptr_pair_2);
+    assert(abel_map_insert(ptr_map_2, key_str, &value).error.error_type
+           == KEY_EXISTS);
+
+    /* Erased and freed pairs release the key */
+    abel_free_pair( abel_map_erase(ptr_map_1, key_str).pointer );
+    assert(abel_interned_key_count() == 1);
+    abel_free_map_ptr(ptr_map_2);
+    assert(abel_interned_key_count() == 0);
+    abel_free_map_ptr(ptr_map_1);
+}
 
-    /* Clean up */
-    abel_free_pair(ptr_pair_1);
-    abel_free_pair( (struct abel_key_value_pair*)ret2.pointer );
-    abel_free_vector_ptr(ptr_test_map->ptr_pair_vector);
-    abel_free_vector_ptr(ptr_test_map->ptr_coll_vector);
-    free(ptr_test_map);
+/**
+ * @brief Test iterator
+ *
+ * Pairs are visited in insertion order in small mode, after
+ * promotion, and after erasing enough pairs to compact the
+ * entries.
+ */
+void test_map_iterator()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    struct abel_map_iterator iter = abel_map_iter_begin(ptr_test_map);
+    struct abel_key_value_pair* ptr_pair = NULL;
+    char key[16];
+    int values[100];
+    int count = 0;
+    assert(abel_map_iter_next(&iter) == NULL);
+
+    for (int i = 0; i < 100; i++) {
+        values[i] = i;
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+        if (i == 4) {    // small mode
+            iter = abel_map_iter_begin(ptr_test_map);
+            for (int j = 0; j < 5; j++) {
+                assert(*(int*)abel_map_iter_next(&iter)->ptr_data == j);
+            }
+            assert(abel_map_iter_next(&iter) == NULL);
+        }
+    }
+    iter = abel_map_iter_begin(ptr_test_map);
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        assert(*(int*)ptr_pair->ptr_data == count);
+        count++;
+    }
+    assert(count == 100);
+
+    /* Erase all but every 10th pair */
+    for (int i = 0; i < 100; i++) {
+        if (i % 10 != 0) {
+            sprintf(key, "key_%d", i);
+            abel_free_pair( abel_map_erase(ptr_test_map, key).pointer );
+        }
+    }
+    assert(ptr_test_map->entry_count < 20);
+    count = 0;
+    iter = abel_map_iter_begin(ptr_test_map);
+    while ( (ptr_pair = abel_map_iter_next(&iter)) != NULL ) {
+        assert(*(int*)ptr_pair->ptr_data == 10 * count);
+        count++;
+    }
+    assert(count == 10);
+    abel_free_map_ptr(ptr_test_map);
+}
+
+/**
+ * @brief Test reserve
+ *
+ * Reserved map holds the pairs without growing, and keeps
+ * the pairs inserted before, in order.
+ */
+void test_map_reserve()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    struct abel_map_iterator iter;
+    char key[16];
+    int values[300];
+    for (int i = 0; i < 300; i++) {
+        values[i] = i;
+    }
+    /* Small mode stays small */
+    assert(abel_map_reserve(ptr_test_map, MAP_SMALL_CAPACITY).is_okay == true);
+    assert(ptr_test_map->ptr_slots == NULL);
+    for (int i = 0; i < 3; i++) {
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+    }
+    assert(abel_map_reserve(ptr_test_map, 100).is_okay == true);
+    assert(abel_map_capacity(ptr_test_map) == 128);
+    for (int i = 3; i < 100; i++) {
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+    }
+    assert(abel_map_capacity(ptr_test_map) == 128);
+    assert(ptr_test_map->ptr_old_slots == NULL);
+    iter = abel_map_iter_begin(ptr_test_map);
+    for (int i = 0; i < 100; i++) {
+        assert(*(int*)abel_map_iter_next(&iter)->ptr_data == i);
+    }
+
+    /* Grow, then reserve while the migration is in progress */
+    for (int i = 100; i < 112; i++) {
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+    }
+    assert(ptr_test_map->ptr_old_slots != NULL);
+    assert(abel_map_reserve(ptr_test_map, 300).is_okay == true);
+    assert(abel_map_capacity(ptr_test_map) == 512);
+    assert(ptr_test_map->ptr_old_slots == NULL);
+    for (int i = 0; i < 112; i++) {
+        sprintf(key, "key_%d", i);
+        assert(*(int*)abel_map_at(ptr_test_map, key).pointer == i);
+    }
+    /* Large enough already */
+    assert(abel_map_reserve(ptr_test_map, 10).is_okay == true);
+    assert(abel_map_capacity(ptr_test_map) == 512);
+    abel_free_map_ptr(ptr_test_map);
+}
+
+/**
+ * @brief Test keys of given length
+ *
+ * Keys are sliced out of a buffer. A prefix of an interned
+ * key is a different key, although it starts at the same
+ * address.
+ */
+void test_map_key_length()
+{
+    char* buffer = "name:value";
+    int value_1 = 1;
+    int value_2 = 2;
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    assert(abel_map_insert_n(ptr_test_map, buffer, 4, &value_1).is_okay == true);
+    assert(abel_map_insert_n(ptr_test_map, buffer, 4, &value_1).is_error == true);
+    assert(*(int*)abel_map_at(ptr_test_map, "name").pointer == 1);
+    assert(*(int*)abel_map_at_n(ptr_test_map, "names", 4).pointer == 1);
+    assert(abel_map_find_n(ptr_test_map, buffer, 3).is_error == true);
+    struct abel_key_value_pair* ptr_pair
+            = abel_map_find_n(ptr_test_map, buffer, 4).pointer;
+    assert(strcmp(ptr_pair->key, "name") == 0);
+
+    const char* interned_key = abel_intern_key_n(buffer, 4);
+    assert(strcmp(interned_key, "name") == 0);
+    assert(abel_find_interned_key_n("name:", 4) == interned_key);
+    assert(abel_find_interned_key_n(buffer, 3) == NULL);
+    abel_map_insert_n(ptr_test_map, interned_key, 3, &value_2);
+    assert(*(int*)abel_map_at_n(ptr_test_map, interned_key, 3).pointer == 2);
+    assert(*(int*)abel_map_at_n(ptr_test_map, interned_key, 4).pointer == 1);
+
+    abel_free_pair( abel_map_erase_n(ptr_test_map, buffer, 4).pointer );
+    assert(abel_map_size(ptr_test_map) == 1);
+    assert(abel_map_find(ptr_test_map, "nam").is_okay == true);
+    abel_release_interned_key(interned_key);
+    assert(abel_interned_key_count() == 0);
+    abel_free_map_ptr(ptr_test_map);
+
+    /* key with an embedded null is released by its length */
+    const char* embedded_key = abel_intern_key_n("ab\0cd", 5);
+    const char* short_key = abel_intern_key("ab");
+    assert(embedded_key != short_key);
+    assert(abel_interned_key_count() == 2);
+    abel_release_interned_key(embedded_key);
+    assert(abel_find_interned_key("ab") == short_key);
+    abel_release_interned_key(short_key);
+    assert(abel_interned_key_count() == 0);
+}
+
+/**
+ * @brief Test shrink and compact
+ *
+ * Table shrinks as pairs are erased, and compact returns a
+ * map to small mode. Pairs left keep their order.
+ */
+void test_map_shrink()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    struct abel_map_iterator iter;
+    char key[16];
+    int values[1000];
+    for (int i = 0; i < 1000; i++) {
+        values[i] = i;
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+    }
+    assert(abel_map_capacity(ptr_test_map) == 2048);
+    for (int i = 0; i < 1000; i++) {
+        if (i % 200 != 0) {
+            sprintf(key, "key_%d", i);
+            abel_free_pair( abel_map_erase(ptr_test_map, key).pointer );
+        }
+    }
+    assert(abel_map_size(ptr_test_map) == 5);
+    assert(abel_map_capacity(ptr_test_map) == 16);
+    assert(ptr_test_map->entry_count <= 2 * 5);
+    iter = abel_map_iter_begin(ptr_test_map);
+    for (int i = 0; i < 5; i++) {
+        assert(*(int*)abel_map_iter_next(&iter)->ptr_data == 200 * i);
+    }
+
+    /* Churn does not grow the table */
+    for (int round = 0; round < 100; round++) {
+        for (int i = 1; i < 10; i++) {
+            sprintf(key, "key_%d", i);
+            abel_map_insert(ptr_test_map, key, &values[i]);
+        }
+        for (int i = 1; i < 10; i++) {
+            sprintf(key, "key_%d", i);
+            abel_free_pair( abel_map_erase(ptr_test_map, key).pointer );
+        }
+    }
+    assert(abel_map_capacity(ptr_test_map) == 16);
+    assert(ptr_test_map->entry_capacity <= 32);
+
+    assert(abel_map_compact(ptr_test_map).is_okay == true);
+    assert(ptr_test_map->ptr_slots == NULL);
+    assert(ptr_test_map->ptr_entries == NULL);
+    iter = abel_map_iter_begin(ptr_test_map);
+    for (int i = 0; i < 5; i++) {
+        sprintf(key, "key_%d", 200 * i);
+        assert(*(int*)abel_map_at(ptr_test_map, key).pointer == 200 * i);
+        assert(*(int*)abel_map_iter_next(&iter)->ptr_data == 200 * i);
+    }
+    for (int i = 1; i < 100; i++) {
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+    }
+    assert(abel_map_compact(ptr_test_map).is_okay == true);
+    assert(abel_map_capacity(ptr_test_map) == 128);
+    assert(ptr_test_map->entry_capacity == abel_map_size(ptr_test_map));
+    assert(*(int*)abel_map_at(ptr_test_map, "key_99").pointer == 99);
+    abel_free_map_ptr(ptr_test_map);
+}
+
+void test_map_stats()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    struct abel_map_stats stats;
+    char key[16];
+    int value = 0;
+    size_t count = 0;
+    abel_map_insert(ptr_test_map, "a", &value);
+    abel_map_insert(ptr_test_map, "b", &value);
+    stats = abel_map_stats(ptr_test_map);
+    assert(stats.size == 2 && stats.capacity == MAP_SMALL_CAPACITY);
+    assert(stats.max_probe_length == 2 && stats.mean_probe_length == 1.5);
+    assert(stats.probe_histogram[0] == 1 && stats.probe_histogram[1] == 1);
+    assert(stats.bytes == sizeof(*ptr_test_map)
+           + 2 * (sizeof(struct abel_key_value_pair) + 2));
+
+    for (int i = 0; i < 500; i++) {
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &value);
+    }
+    stats = abel_map_stats(ptr_test_map);
+    assert(stats.size == 502 && stats.capacity == abel_map_capacity(ptr_test_map));
+    assert(stats.load_factor == 502.0 / (double)stats.capacity);
+    for (int i = 0; i < MAP_STATS_HISTOGRAM_SIZE; i++) {
+        count += stats.probe_histogram[i];
+    }
+    assert(count == 502);
+    assert(stats.mean_probe_length >= 1.0);
+    assert(stats.mean_probe_length <= (double)stats.max_probe_length);
+    assert(stats.bytes > 502 * sizeof(struct abel_key_value_pair));
+#ifdef ABEL_MAP_COUNTERS
+    size_t lookups = stats.lookup_count;
+    abel_map_find(ptr_test_map, "a");
+    abel_map_find(ptr_test_map, "none");
+    stats = abel_map_stats(ptr_test_map);
+    assert(stats.lookup_count == lookups + 2);
+    assert(stats.hit_count + stats.miss_count == stats.lookup_count);
+    assert(stats.probe_count >= stats.hit_count);
+#else
+    assert(stats.lookup_count == 0 && stats.probe_count == 0);
+#endif
+    abel_free_map_ptr(ptr_test_map);
+}
+
+/**
+ * @brief Test clear
+ * 
+ * Cleared map keeps its table, also during migration, and
+ * can be filled again.
+ */
+void test_map_clear()
+{
+    struct abel_map* ptr_test_map = abel_make_map_ptr();
+    struct abel_map_iterator iter;
+    char key[16];
+    int values[200];
+    abel_map_insert(ptr_test_map, "a", &values[0]);
+    abel_map_clear(ptr_test_map);
+    assert(abel_map_size(ptr_test_map) == 0);
+    assert(abel_map_find(ptr_test_map, "a").is_error == true);
+
+    for (int i = 0; i < 200; i++) {
+        values[i] = i;
+        sprintf(key, "key_%d", i);
+        abel_map_insert(ptr_test_map, key, &values[i]);
+    }
+    size_t capacity = abel_map_capacity(ptr_test_map);
+    abel_map_clear(ptr_test_map);
+    assert(abel_map_size(ptr_test_map) == 0);
+    assert(abel_map_capacity(ptr_test_map) == capacity);
+    assert(ptr_test_map->ptr_old_slots == NULL);
+    iter = abel_map_iter_begin(ptr_test_map);
+    assert(abel_map_iter_next(&iter) == NULL);
+    for (int i = 0; i < 200; i++) {
+        sprintf(key, "key_%d", i);
+        assert(abel_map_find(ptr_test_map, key).is_error == true);
+    }
+    for (int i = 0; i < 100; i++) {
+        sprintf(key, "key_%d", i);
+        assert(abel_map_insert(ptr_test_map, key, &values[i]).is_okay == true);
+    }
+    assert(abel_map_size(ptr_test_map) == 100);
+    assert(abel_map_capacity(ptr_test_map) == capacity);
+    assert(*(int*)abel_map_at(ptr_test_map, "key_99").pointer == 99);
+    iter = abel_map_iter_begin(ptr_test_map);
+    assert(*(int*)abel_map_iter_next(&iter)->ptr_data == 0);
+    abel_free_map_ptr(ptr_test_map);
 }
 
 int main()
 {
     test_abel_map_make();
     test_abel_map_insert();
-    test_key_collision_first_register();
-    test_key_collision_second_register();
+    test_map_small_promote();
+    test_map_grow();
     test_map_find();
     test_map_at();
     test_map_assign();
 
 /* erase */
     test_map_erase();
-    test_map_erase_with_collision();
+    test_map_erase_during_migration();
+    test_map_clear();
+
+/* hash function */
+    test_map_with_hash();
+
+/* interned keys */
+    test_map_interned_key();
+    test_map_iterator();
+    test_map_reserve();
+    test_map_key_length();
+    test_map_shrink();
+    test_map_stats();
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ gcc -g -std=c17 -Wall -c $SRCDIR/option.c -o $BLDDIR/option.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/astring.c -o $BLDDIR/astring.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/vector.c -o $BLDDIR/vector.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/linked_list.c -o $BLDDIR/linked_list.o -I $INCDIR
+gcc -g -std=c17 -Wall -c $SRCDIR/hashing_func.c -o $BLDDIR/hashing_func.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/map.c -o $BLDDIR/map.o -I $INCDIR
 gcc -g -std=c17 -Wall -c $SRCDIR/common.c -o $BLDDIR/commom.o -I $INCDIR
 # typefied
@@ -34,6 +35,7 @@ gcc -std=c17 -g -Wall \
     $BLDDIR/astring.o \
     $BLDDIR/vector.o \
     $BLDDIR/linked_list.o \
+    $BLDDIR/hashing_func.o \
     $BLDDIR/map.o \
     $BLDDIR/common.o \
     $BLDDIR/typefy.o \
@@ -45,4 +47,40 @@ if [ "$1" = "leak-check" ]; then
     valgrind --leak-check=yes ./unittest.out
 else
     ./unittest.out
+fi
+
+echo "-- Compile with atomic ref count --"
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/error.c -o $BLDDIR/error_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/generic.c -o $BLDDIR/generic_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/option.c -o $BLDDIR/option_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/astring.c -o $BLDDIR/astring_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/vector.c -o $BLDDIR/vector_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/linked_list.c -o $BLDDIR/linked_list_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/hashing_func.c -o $BLDDIR/hashing_func_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/map.c -o $BLDDIR/map_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/common.c -o $BLDDIR/common_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/typefy.c -o $BLDDIR/typefy_atomic.o -I $INCDIR
+gcc -g -std=c17 -Wall -DABEL_ATOMIC_REF_COUNT -c $SRCDIR/object.c -o $BLDDIR/object_atomic.o -I $INCDIR
+gcc -std=c17 -g -Wall -DABEL_ATOMIC_REF_COUNT -c ./unittest.c -o ./unittest_atomic.o -I $INCDIR
+
+echo "-- Link atomic object files --"
+gcc -std=c17 -g -Wall \
+    $BLDDIR/error_atomic.o \
+    $BLDDIR/generic_atomic.o \
+    $BLDDIR/option_atomic.o \
+    $BLDDIR/astring_atomic.o \
+    $BLDDIR/vector_atomic.o \
+    $BLDDIR/linked_list_atomic.o \
+    $BLDDIR/hashing_func_atomic.o \
+    $BLDDIR/map_atomic.o \
+    $BLDDIR/common_atomic.o \
+    $BLDDIR/typefy_atomic.o \
+    $BLDDIR/object_atomic.o \
+    ./unittest_atomic.o  -o ./unittest_atomic.out
+
+echo "-- Run atomic executable --"
+if [ "$1" = "leak-check" ]; then
+    valgrind --leak-check=yes ./unittest_atomic.out
+else
+    ./unittest_atomic.out
 fi
\ No newline at end of file
@@ -8,6 +8,11 @@
  * count of the object to 1.
  */
 #include <assert.h>
+#ifdef ABEL_ATOMIC_REF_COUNT
+#include <stdio.h>
+#include <threads.h>
+#endif
+#include "map.h"
 #include "object.h"
 
 /* pointer from primitive and intrinsic types */
@@ -26,6 +31,151 @@ void test_make_object_ptr_from_bool()
     abel_free_object_ptr(ptr_test_object);
 }
 
+/* Scalar data is stored inline, pointer to data is kept */
+void test_make_object_ptr_inline()
+{
+    double test_data = 2.5;
+    struct abel_object* ptr_test_object = abel_make_object_ptr(test_data);
+    ptr_test_object->ref_count = 1;
+    assert(ptr_test_object->ptr_data == &ptr_test_object->value);
+    assert(ptr_test_object->value.double_value == 2.5);
+    *(double*)ptr_test_object->ptr_data = 3.5;
+    assert(abel_object_get_double(ptr_test_object) == 3.5);
+    assert(sizeof(*ptr_test_object) <= 4 * sizeof(void*) || sizeof(void*) < 8);
+    abel_free_object_ptr(ptr_test_object);
+}
+
+/* Immortal objects are shared and never freed */
+void test_immortal_objects()
+{
+    struct abel_object* ptr_true = abel_bool_object_ptr(true);
+    assert(ptr_true == abel_bool_object_ptr(true));
+    assert(ptr_true != abel_bool_object_ptr(false));
+    assert(abel_object_get_bool(ptr_true) == true);
+    assert(abel_object_get_bool(abel_bool_object_ptr(false)) == false);
+    assert(*(Null*)abel_null_object_ptr()->ptr_data == null);
+    assert(abel_object_get_type(abel_null_object_ptr()) == NULL_TYPE);
+    assert(abel_object_is_immortal(ptr_true) == true);
+    abel_object_add_ref(ptr_true);
+    assert(ptr_true->ref_count == OBJECT_IMMORTAL_REF_COUNT);
+    abel_free_object_ptr(ptr_true);
+    assert(abel_object_get_bool(ptr_true) == true);
+
+    struct abel_object* ptr_object = abel_make_object_ptr(true);
+    assert(abel_object_is_immortal(ptr_object) == false);
+    abel_object_add_ref(ptr_object);
+    assert(ptr_object->ref_count == 1);
+    abel_free_object_ptr(ptr_object);
+}
+
+/**
+ * @brief Test references
+ *
+ * Every reference is dropped by a call of the freer and the
+ * last one frees the object.
+ */
+void test_object_references()
+{
+    struct abel_object* ptr_object = abel_make_object_ptr(7);
+    abel_object_add_ref_local(ptr_object);
+    abel_object_add_ref_local(ptr_object);
+    abel_object_add_ref(ptr_object);
+    assert(ptr_object->ref_count == 3);
+    abel_free_object_ptr(ptr_object);
+    abel_free_object_ptr(ptr_object);
+    assert(ptr_object->ref_count == 1);
+    assert(abel_object_get_int(ptr_object) == 7);
+    abel_free_object_ptr(ptr_object);
+
+    /* immortal object stays pinned */
+    abel_object_add_ref_local(abel_null_object_ptr());
+    assert(abel_object_is_immortal(abel_null_object_ptr()) == true);
+}
+
+#ifdef ABEL_ATOMIC_REF_COUNT
+#define THREAD_COUNT 4
+#define THREAD_REF_COUNT 100000
+
+static int add_and_drop_refs(void* ptr_arg)
+{
+    struct abel_object* ptr_object = ptr_arg;
+    for (int i = 0; i < THREAD_REF_COUNT; i++) {
+        abel_object_add_ref(ptr_object);
+        abel_free_object_ptr(ptr_object);
+    }
+    return 0;
+}
+
+/**
+ * @brief Test references held by several threads
+ */
+void test_object_references_threads()
+{
+    thrd_t threads[THREAD_COUNT];
+    struct abel_object* ptr_object = abel_make_object_ptr("shared");
+    abel_object_add_ref(ptr_object);
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        assert(thrd_create(&threads[i], add_and_drop_refs, ptr_object)
+               == thrd_success);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        thrd_join(threads[i], NULL);
+    }
+    assert(ptr_object->ref_count == 1);
+    abel_free_object_ptr(ptr_object);
+}
+
+#define THREAD_SHAPE_COUNT 2000
+#define SHAPE_SIZE 8
+
+static int make_and_drop_shapes(void* ptr_arg)
+{
+    (void)ptr_arg;
+    char key[16];
+    size_t index = 0;
+    for (int i = 0; i < THREAD_SHAPE_COUNT; i++) {
+        struct abel_key_shape* ptr_shape = NULL;
+        for (int j = 0; j < SHAPE_SIZE; j++) {
+            sprintf(key, "key_%d", (i + j) % (2 * SHAPE_SIZE));
+            const char* interned_key = abel_intern_key(key);
+            struct abel_key_shape* ptr_new_shape
+                    = abel_key_shape_add_key(ptr_shape, interned_key);
+            assert(ptr_new_shape != NULL);
+            if (ptr_shape != NULL) {
+                abel_release_key_shape(ptr_shape);
+            }
+            ptr_shape = ptr_new_shape;
+            /* shape holds its own reference to the key */
+            abel_release_interned_key(interned_key);
+            assert(abel_find_interned_key(key) == interned_key);
+            assert(abel_key_shape_find(ptr_shape, key, &index) == true);
+            assert(index == (size_t)j);
+        }
+        abel_release_key_shape(ptr_shape);
+    }
+    return 0;
+}
+
+/**
+ * @brief Test keys and shapes of dicts in several threads
+ *
+ * Threads intern, find and release the same keys, and make
+ * and free the same shapes at once.
+ */
+void test_key_shapes_threads()
+{
+    thrd_t threads[THREAD_COUNT];
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        assert(thrd_create(&threads[i], make_and_drop_shapes, NULL)
+               == thrd_success);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        thrd_join(threads[i], NULL);
+    }
+    assert(abel_interned_key_count() == 0);
+}
+#endif
+
 void test_make_object_ptr_from_string()
 {
     char* test_data = "Halo, Wereld!";
@@ -192,6 +342,13 @@ int main()
 {
 /* new pointer from primitive and intrinsic types */
     test_make_object_ptr_from_bool();
+    test_make_object_ptr_inline();
+    test_immortal_objects();
+    test_object_references();
+#ifdef ABEL_ATOMIC_REF_COUNT
+    test_object_references_threads();
+    test_key_shapes_threads();
+#endif
     test_make_object_ptr_from_string();
     test_make_object_ptr_from_int();
     test_make_object_ptr_from_double();